@@ -45,6 +45,10 @@ let package = Package(
                 .headerSearchPath("SocketRocket/Internal/RunLoop"),
                 .headerSearchPath("SocketRocket/Internal/Delegate"),
                 .headerSearchPath("SocketRocket/Internal/IOConsumer"),
+            ],
+            linkerSettings: [
+                // The WebSocket permessage-deflate extension.
+                .linkedLibrary("z")
             ]
         )
     ]
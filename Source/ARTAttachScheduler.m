@@ -0,0 +1,167 @@
+#import "ARTAttachScheduler.h"
+#import "ARTInternalLog.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface ARTAttachBatchProgress ()
+
+@property (nonatomic, readwrite) NSUInteger requested;
+@property (nonatomic, readwrite) NSUInteger succeeded;
+@property (nonatomic, readwrite) NSUInteger failed;
+@property (nonatomic, readwrite) NSUInteger inFlight;
+@property (nonatomic, readwrite) NSUInteger waiting;
+@property (nonatomic, readwrite) NSTimeInterval duration;
+@property (nonatomic, readwrite) NSTimeInterval averageAttachLatency;
+@property (nonatomic, readwrite) NSTimeInterval maxAttachLatency;
+
+@end
+
+@interface ARTAttachScheduler ()
+
+@property (nonatomic, readonly) ARTInternalLog *logger;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+@implementation ARTAttachBatchProgress
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ - requested: %lu, succeeded: %lu, failed: %lu, in flight: %lu, waiting: %lu, duration: %.3fs, average latency: %.3fs, max latency: %.3fs", [super description], (unsigned long)self.requested, (unsigned long)self.succeeded, (unsigned long)self.failed, (unsigned long)self.inFlight, (unsigned long)self.waiting, self.duration, self.averageAttachLatency, self.maxAttachLatency];
+}
+
+@end
+
+@implementation ARTAttachScheduler {
+    NSMutableArray<NSString *> *_waitingChannels;
+    NSMutableDictionary<NSString *, void (^)(void)> *_sendAttachByChannel;
+    // The system uptime at which the ATTACH of each channel in flight was sent.
+    NSMutableDictionary<NSString *, NSNumber *> *_attachSentAtByChannel;
+    // The current or last batch.
+    NSUInteger _requested;
+    NSUInteger _succeeded;
+    NSUInteger _failed;
+    NSTimeInterval _batchStartedAt;
+    NSTimeInterval _batchEndedAt; // 0 while the batch is in progress
+    NSTimeInterval _totalAttachLatency;
+    NSUInteger _attachLatencyCount;
+    NSTimeInterval _maxAttachLatency;
+}
+
+- (instancetype)initWithMaxConcurrentAttaches:(NSUInteger)maxConcurrentAttaches logger:(ARTInternalLog *)logger {
+    if (self = [super init]) {
+        _maxConcurrentAttaches = maxConcurrentAttaches;
+        _logger = logger;
+        _waitingChannels = [NSMutableArray array];
+        _sendAttachByChannel = [NSMutableDictionary dictionary];
+        _attachSentAtByChannel = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+static NSTimeInterval ARTUptime(void) {
+    return [NSProcessInfo processInfo].systemUptime;
+}
+
+- (BOOL)isIdle {
+    return _waitingChannels.count == 0 && _attachSentAtByChannel.count == 0;
+}
+
+- (BOOL)hasFreeSlot {
+    return _maxConcurrentAttaches == 0 || _attachSentAtByChannel.count < _maxConcurrentAttaches;
+}
+
+- (void)scheduleAttachOfChannel:(NSString *)channelName sendAttach:(void (^)(void))sendAttach {
+    if ([self isIdle]) {
+        _requested = 0;
+        _succeeded = 0;
+        _failed = 0;
+        _batchStartedAt = ARTUptime();
+        _batchEndedAt = 0;
+        _totalAttachLatency = 0;
+        _attachLatencyCount = 0;
+        _maxAttachLatency = 0;
+    }
+
+    if ([_attachSentAtByChannel objectForKey:channelName]) {
+        // Attaching again, for instance after a reconnection: the channel keeps its slot.
+        sendAttach();
+        return;
+    }
+    if (![_sendAttachByChannel objectForKey:channelName]) {
+        [_waitingChannels addObject:channelName];
+        _requested++;
+    }
+    [_sendAttachByChannel setObject:[sendAttach copy] forKey:channelName];
+    if (![self hasFreeSlot]) {
+        ARTLogDebug(self.logger, @"attach of channel %@ waits for one of %lu attaches in flight", channelName, (unsigned long)_attachSentAtByChannel.count);
+    }
+    [self sendWaitingAttaches];
+}
+
+- (void)sendWaitingAttaches {
+    NSUInteger sent = 0;
+    while (_waitingChannels.count > 0 && [self hasFreeSlot]) {
+        NSString *const channelName = _waitingChannels.firstObject;
+        [_waitingChannels removeObjectAtIndex:0];
+        void (^const sendAttach)(void) = [_sendAttachByChannel objectForKey:channelName];
+        [_sendAttachByChannel removeObjectForKey:channelName];
+        [_attachSentAtByChannel setObject:@(ARTUptime()) forKey:channelName];
+        sendAttach();
+        sent++;
+    }
+    if (sent > 1) {
+        ARTLogDebug(self.logger, @"sent %lu ATTACH messages together, %lu still waiting", (unsigned long)sent, (unsigned long)_waitingChannels.count);
+    }
+}
+
+- (void)attachOfChannelDidEnd:(NSString *)channelName attached:(BOOL)attached {
+    NSNumber *const sentAt = [_attachSentAtByChannel objectForKey:channelName];
+    if (sentAt) {
+        [_attachSentAtByChannel removeObjectForKey:channelName];
+        const NSTimeInterval latency = ARTUptime() - sentAt.doubleValue;
+        _totalAttachLatency += latency;
+        _attachLatencyCount++;
+        _maxAttachLatency = MAX(_maxAttachLatency, latency);
+    }
+    else if ([_sendAttachByChannel objectForKey:channelName]) {
+        // Ended, for instance detached, before its ATTACH was sent.
+        [_sendAttachByChannel removeObjectForKey:channelName];
+        [_waitingChannels removeObject:channelName];
+    }
+    else {
+        return;
+    }
+    if (attached) {
+        _succeeded++;
+    }
+    else {
+        _failed++;
+    }
+
+    // Refilling the slots once half of them are free, rather than one by one, packs the ATTACH messages into fewer writes.
+    if (_attachSentAtByChannel.count <= _maxConcurrentAttaches / 2) {
+        [self sendWaitingAttaches];
+    }
+    if ([self isIdle]) {
+        _batchEndedAt = ARTUptime();
+        ARTLogInfo(self.logger, @"attach batch ended: %@", self.progress);
+    }
+}
+
+- (ARTAttachBatchProgress *)progress {
+    ARTAttachBatchProgress *const progress = [[ARTAttachBatchProgress alloc] init];
+    progress.requested = _requested;
+    progress.succeeded = _succeeded;
+    progress.failed = _failed;
+    progress.inFlight = _attachSentAtByChannel.count;
+    progress.waiting = _waitingChannels.count;
+    if (_batchStartedAt > 0) {
+        progress.duration = (_batchEndedAt > 0 ? _batchEndedAt : ARTUptime()) - _batchStartedAt;
+    }
+    progress.averageAttachLatency = _attachLatencyCount > 0 ? _totalAttachLatency / _attachLatencyCount : 0;
+    progress.maxAttachLatency = _maxAttachLatency;
+    return progress;
+}
+
+@end
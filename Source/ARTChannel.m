@@ -15,6 +15,7 @@
 @implementation ARTChannel {
     dispatch_queue_t _queue;
     ARTChannelOptions *_options;
+    ARTDataEncoder *_dataEncoder;
 }
 
 - (instancetype)initWithName:(NSString *)name andOptions:(ARTChannelOptions *)options rest:(ARTRestInternal *)rest logger:(ARTInternalLog *)logger {
@@ -23,16 +24,18 @@
         _logger = logger;
         _queue = rest.queue;
         _options = options;
-        NSError *error = nil;
-        _dataEncoder = [[ARTDataEncoder alloc] initWithCipherParams:_options.cipher logger:_logger error:&error];
-        if (error != nil) {
-            ARTLogWarn(_logger, @"creating ARTDataEncoder: %@", error);
-            _dataEncoder = [[ARTDataEncoder alloc] initWithCipherParams:nil logger:_logger error:nil];
-        }
     }
     return self;
 }
 
+// Created on first use, as it isn't needed by a channel that is only held onto, and recreated from the options when they change.
+- (ARTDataEncoder *)dataEncoder {
+    if (!_dataEncoder) {
+        [self recreateDataEncoderWith:_options.cipher];
+    }
+    return _dataEncoder;
+}
+
 - (ARTChannelOptions *)options {
     __block ARTChannelOptions *ret;
     dispatch_sync(_queue, ^{
@@ -53,7 +56,7 @@
 
 - (void)setOptions_nosync:(ARTChannelOptions *)options {
     _options = options;
-    [self recreateDataEncoderWith:options.cipher];
+    _dataEncoder = nil;
 }
 
 - (void)recreateDataEncoderWith:(ARTCipherParams*)cipher {
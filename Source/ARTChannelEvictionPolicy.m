@@ -0,0 +1,38 @@
+#import "ARTChannelEvictionPolicy+Private.h"
+
+@implementation ARTChannelEvictionPolicy
+
+- (id)copyWithZone:(NSZone *)zone {
+    ARTChannelEvictionPolicy *const policy = [[self.class allocWithZone:zone] init];
+    policy.idleTimeout = self.idleTimeout;
+    policy.maxChannels = self.maxChannels;
+    policy.maxBytes = self.maxBytes;
+    return policy;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ - idleTimeout: %.3fs, maxChannels: %lu, maxBytes: %lu", [super description], self.idleTimeout, (unsigned long)self.maxChannels, (unsigned long)self.maxBytes];
+}
+
+@end
+
+@implementation ARTChannelEvictionStats
+
+- (instancetype)initWithIdleEvictions:(NSUInteger)idleEvictions countEvictions:(NSUInteger)countEvictions sizeEvictions:(NSUInteger)sizeEvictions {
+    if (self = [super init]) {
+        _idleEvictions = idleEvictions;
+        _countEvictions = countEvictions;
+        _sizeEvictions = sizeEvictions;
+    }
+    return self;
+}
+
+- (NSUInteger)totalEvictions {
+    return _idleEvictions + _countEvictions + _sizeEvictions;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ - idle: %lu, count: %lu, size: %lu", [super description], (unsigned long)self.idleEvictions, (unsigned long)self.countEvictions, (unsigned long)self.sizeEvictions];
+}
+
+@end
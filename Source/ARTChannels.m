@@ -4,10 +4,22 @@
 #import "ARTChannel+Private.h"
 #import "ARTChannelOptions.h"
 #import "ARTRestChannel.h"
+#import "ARTChannelEvictionPolicy+Private.h"
+#import "ARTGCD.h"
+
+// How often, at most, the channels are checked for eviction.
+static const NSTimeInterval ARTChannelEvictionCheckInterval = 10.0;
 
 @interface ARTChannels() {
     __weak id<ARTChannelsDelegate> _delegate; // weak because delegates outlive their counterpart
     dispatch_queue_t _queue;
+    // With an eviction policy: the names of the channels, least recently used first, and when each was last used.
+    NSMutableOrderedSet<NSString *> *_recentlyUsed;
+    NSMutableDictionary<NSString *, NSNumber *> *_lastUsedAt;
+    // The channels being got ready for eviction; one used meanwhile is kept.
+    NSMutableSet<NSString *> *_evicting;
+    ARTScheduledBlockHandle *_evictionCheck;
+    NSUInteger _evictions[ARTChannelEvictionReasonSize + 1];
 }
 
 @end
@@ -67,7 +79,11 @@ dispatch_sync(_queue, ^{
 }
 
 - (void)_release:(NSString *)name {
-    [self->_channels removeObjectForKey:[self addPrefix:name]];
+    name = [self addPrefix:name];
+    [self->_channels removeObjectForKey:name];
+    [_recentlyUsed removeObject:name];
+    [_lastUsedAt removeObjectForKey:name];
+    [_evicting removeObject:name];
 }
 
 - (ARTRestChannel *)getChannel:(NSString *)name options:(ARTChannelOptions *)options {
@@ -89,9 +105,145 @@ dispatch_sync(_queue, ^{
     } else if (options) {
         [channel setOptions_nosync:options];
     }
+    if (_evictionPolicy) {
+        [self channelWasUsed:name];
+    }
     return channel;
 }
 
+#pragma mark - Eviction
+
+static NSTimeInterval ARTUptime(void) {
+    return [NSProcessInfo processInfo].systemUptime;
+}
+
+- (void)setEvictionPolicy:(ARTChannelEvictionPolicy *)evictionPolicy {
+    _evictionPolicy = [evictionPolicy copy];
+    if (_evictionPolicy && !_recentlyUsed) {
+        _recentlyUsed = [NSMutableOrderedSet orderedSet];
+        _lastUsedAt = [NSMutableDictionary dictionary];
+        _evicting = [NSMutableSet set];
+    }
+}
+
+- (void)_channelWasUsed:(ARTChannel *)channel {
+    // A channel that has been released or evicted meanwhile isn't tracked again.
+    if (_evictionPolicy && _channels[channel.name] == channel) {
+        [self channelWasUsed:channel.name];
+    }
+}
+
+- (void)channelWasUsed:(NSString *)name {
+    [_evicting removeObject:name];
+    if (_recentlyUsed.lastObject != name) {
+        [_recentlyUsed removeObject:name];
+        [_recentlyUsed addObject:name];
+    }
+    _lastUsedAt[name] = @(ARTUptime());
+
+    if (_evictionPolicy.maxChannels > 0 && _recentlyUsed.count > _evictionPolicy.maxChannels) {
+        [self evictChannelsSparing:name];
+    }
+    else {
+        [self scheduleEvictionCheck];
+    }
+}
+
+- (void)scheduleEvictionCheck {
+    if (_evictionCheck || _recentlyUsed.count == 0) {
+        return;
+    }
+    const NSTimeInterval idleTimeout = _evictionPolicy.idleTimeout;
+    const NSTimeInterval interval = idleTimeout > 0 ? MIN(idleTimeout, ARTChannelEvictionCheckInterval) : ARTChannelEvictionCheckInterval;
+    __weak ARTChannels *weakSelf = self;
+    _evictionCheck = artDispatchScheduled(interval, _queue, ^{
+        ARTChannels *const strongSelf = weakSelf;
+        if (strongSelf) {
+            strongSelf->_evictionCheck = nil;
+            [strongSelf _evictChannels];
+        }
+    });
+}
+
+- (NSUInteger)estimatedSizeOfChannels {
+    NSUInteger size = 0;
+    for (NSString *name in _recentlyUsed) {
+        size += [_delegate estimatedSizeOfChannel:_channels[name]];
+    }
+    return size;
+}
+
+- (void)_evictChannels {
+    [self evictChannelsSparing:nil];
+}
+
+// `spared` is the channel being used, which mustn't be evicted in its place when the others can't be.
+- (void)evictChannelsSparing:(NSString *)spared {
+    ARTChannelEvictionPolicy *const policy = _evictionPolicy;
+    if (!policy) {
+        return;
+    }
+    const NSTimeInterval now = ARTUptime();
+    NSUInteger count = _recentlyUsed.count;
+    NSUInteger size = policy.maxBytes > 0 ? [self estimatedSizeOfChannels] : 0;
+
+    // From the least recently used channel, evicting while the limits are exceeded and then while channels have been idle for too long.
+    NSUInteger index = 0;
+    while (index < _recentlyUsed.count) {
+        NSString *const name = _recentlyUsed[index];
+        ARTChannelEvictionReason reason;
+        if (policy.maxChannels > 0 && count > policy.maxChannels) {
+            reason = ARTChannelEvictionReasonCount;
+        }
+        else if (policy.maxBytes > 0 && size > policy.maxBytes) {
+            reason = ARTChannelEvictionReasonSize;
+        }
+        else if (policy.idleTimeout > 0 && now - _lastUsedAt[name].doubleValue >= policy.idleTimeout) {
+            reason = ARTChannelEvictionReasonIdle;
+        }
+        else {
+            break;
+        }
+
+        id const channel = _channels[name];
+        if ([name isEqualToString:spared] || ![_delegate canEvictChannel:channel]) {
+            index++;
+            continue;
+        }
+        count--;
+        if (policy.maxBytes > 0) {
+            size -= MIN(size, [_delegate estimatedSizeOfChannel:channel]);
+        }
+        [self evictChannel:channel named:name reason:reason];
+    }
+    [self scheduleEvictionCheck];
+}
+
+- (void)evictChannel:(id)channel named:(NSString *)name reason:(ARTChannelEvictionReason)reason {
+    [_recentlyUsed removeObject:name];
+    [_lastUsedAt removeObjectForKey:name];
+    [_evicting addObject:name];
+    [_delegate prepareEvictionOfChannel:channel completion:^BOOL{
+        // Unless it was used meanwhile, in which case it's tracked again.
+        if (![self->_evicting containsObject:name] || self->_channels[name] != channel) {
+            return NO;
+        }
+        [self->_evicting removeObject:name];
+        [self->_channels removeObjectForKey:name];
+        self->_evictions[reason]++;
+        if (self.evictionHandler) {
+            self.evictionHandler(name, reason);
+        }
+        return YES;
+    }];
+}
+
+- (ARTChannelEvictionStats *)evictionStats {
+    return [[ARTChannelEvictionStats alloc] initWithIdleEvictions:_evictions[ARTChannelEvictionReasonIdle]
+                                                   countEvictions:_evictions[ARTChannelEvictionReasonCount]
+                                                    sizeEvictions:_evictions[ARTChannelEvictionReasonSize]];
+}
+
 - (id)_get:(NSString *)name {
     return self->_channels[name];
 }
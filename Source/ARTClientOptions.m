@@ -6,6 +6,7 @@
 #import "ARTStatus.h"
 #import "ARTTokenParams.h"
 #import "ARTDeltaCodec.h"
+#import "ARTChannelEvictionPolicy.h"
 #import "ARTStringifiable.h"
 #import "ARTNSString+ARTUtil.h"
 #import "ARTTestClientOptions.h"
@@ -35,6 +36,7 @@ NSString *ARTDefaultEnvironment = nil;
     _disconnectedRetryTimeout = 15.0; //Seconds
     _suspendedRetryTimeout = 30.0; //Seconds
     _channelRetryTimeout = 15.0; //Seconds
+    _maxConcurrentAttaches = 0; // No limit
     _httpOpenTimeout = 4.0; //Seconds
     _httpRequestTimeout = 10.0; //Seconds
     _fallbackRetryTimeout = 600.0; // Seconds, TO3l10
@@ -118,6 +120,11 @@ NSString *ARTDefaultEnvironment = nil;
     options.suspendedRetryTimeout = self.suspendedRetryTimeout;
     options.disconnectedRetryTimeout = self.disconnectedRetryTimeout;
     options.channelRetryTimeout = self.channelRetryTimeout;
+    options.maxConcurrentAttaches = self.maxConcurrentAttaches;
+    options.useWebSocketCompression = self.useWebSocketCompression;
+    options.webSocketQueueCount = self.webSocketQueueCount;
+    options.webSocketMaximumFragmentLength = self.webSocketMaximumFragmentLength;
+    options.channelEvictionPolicy = self.channelEvictionPolicy;
     options.httpMaxRetryCount = self.httpMaxRetryCount;
     options.httpMaxRetryDuration = self.httpMaxRetryDuration;
     options.httpOpenTimeout = self.httpOpenTimeout;
@@ -1,6 +1,6 @@
 #import "ARTCrypto+Private.h"
 #import "ARTDataEncoder.h"
-#import "ARTDeltaCodec.h"
+#import "ARTDeltaArena.h"
 
 @implementation ARTDataEncoderOutput
 
@@ -18,7 +18,7 @@
 
 @implementation ARTDataEncoder {
     id<ARTChannelCipher> _cipher;
-    ARTDeltaCodec *_deltaCodec;
+    ARTDeltaArena *_deltaArena;
     NSString *_baseId;
 }
 
@@ -38,18 +38,25 @@
             }
         }
 
-        _deltaCodec = [[ARTDeltaCodec alloc] init];
     }
     return self;
 }
 
+// The arena's buffers are only allocated once a message has been decoded, which a channel that is only published to never does.
+- (ARTDeltaArena *)deltaArena {
+    if (!_deltaArena) {
+        _deltaArena = [[ARTDeltaArena alloc] init];
+    }
+    return _deltaArena;
+}
+
 - (void)setDeltaCodecBase:(nullable id)data identifier:(NSString *)identifier {
     _baseId = identifier;
     if ([data isKindOfClass:[NSData class]]) {
-        [_deltaCodec setBase:data withId:identifier];
+        [self.deltaArena setBase:data withId:identifier];
     }
     else if ([data isKindOfClass:[NSString class]]) {
-        [_deltaCodec setBase:[data dataUsingEncoding:NSUTF8StringEncoding] withId:identifier];
+        [self.deltaArena setBaseString:data withId:identifier];
     }
 }
 
@@ -138,7 +145,13 @@
     ARTErrorInfo *errorInfo = nil;
     NSArray *encodings = [encoding componentsSeparatedByString:@"/"];
     NSString *outputEncoding = [NSString stringWithString:encoding];
-    
+
+    // RTL19b: the base payload is the result of applying a delta or, for any other message, the data after an outermost base64 decoding.
+    const BOOL isDelta = [encodings containsObject:@"vcdiff"];
+    if (!isDelta && ![[encodings lastObject] isEqualToString:@"base64"]) {
+        [self setDeltaCodecBase:data identifier:identifier];
+    }
+
     for (NSUInteger i = [encodings count]; i > 0; i--) {
         errorInfo = nil;
         NSString *encoding = [encodings objectAtIndex:i-1];
@@ -149,6 +162,9 @@
             }
             if ([data isKindOfClass:[NSString class]]) {
                 data = [[NSData alloc] initWithBase64EncodedString:(NSString *)data options:0];
+                if (!isDelta && i == [encodings count]) {
+                    [self setDeltaCodecBase:data identifier:identifier];
+                }
             } else {
                 errorInfo = [ARTErrorInfo createWithCode:ARTErrorInvalidMessageDataOrEncoding
                                                  message:[NSString stringWithFormat:@"invalid data type for 'base64' decoding: '%@'", [data class]]];
@@ -162,11 +178,9 @@
                                                  message:[NSString stringWithFormat:@"invalid data type for '%@' decoding: '%@'", encoding, [data class]]];
             }
         } else if ([encoding isEqualToString:@"json"]) {
-            if ([data isKindOfClass:[NSData class]]) { // E. g. when decrypted.
-                data = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-            }
-            if ([data isKindOfClass:[NSString class]]) {
-                NSData *jsonData = [data dataUsingEncoding:NSUTF8StringEncoding];
+            if ([data isKindOfClass:[NSData class]] || [data isKindOfClass:[NSString class]]) {
+                // Data (e. g. when decrypted or delta decoded) is parsed as is, without a round trip through NSString.
+                NSData *jsonData = [data isKindOfClass:[NSData class]] ? data : [data dataUsingEncoding:NSUTF8StringEncoding];
                 NSError *error = nil;
                 data = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:&error];
                 if (error != nil) {
@@ -181,30 +195,43 @@
             if (status.state != ARTStateOk) {
                 errorInfo = status.errorInfo ? status.errorInfo : [ARTErrorInfo createWithCode:ARTErrorInvalidMessageDataOrEncoding message:@"decrypt failed"];
             }
-        } else if ([encoding isEqualToString:@"vcdiff"] && _deltaCodec) {
-            NSError *decodeError;
-            data = [_deltaCodec applyDelta:data deltaId:identifier baseId:_baseId error:&decodeError];
-
-            if (decodeError) {
-                errorInfo = [ARTErrorInfo createWithCode:ARTErrorUnableToDecodeMessage message:decodeError.localizedDescription];
+        } else if ([encoding isEqualToString:@"vcdiff"]) {
+            if (![data isKindOfClass:[NSData class]]) {
+                errorInfo = [ARTErrorInfo createWithCode:ARTErrorUnableToDecodeMessage
+                                                 message:[NSString stringWithFormat:@"invalid data type for 'vcdiff' decoding: '%@'", [data class]]];
             }
-            else if (!data) {
-                errorInfo = [ARTErrorInfo createWithCode:ARTErrorUnableToDecodeMessage message:@"Data is nil"];
+            else {
+                // On success the arena keeps the decoded payload as the new base, without copying it.
+                NSError *decodeError;
+                data = [self.deltaArena applyDelta:data deltaId:identifier baseId:_baseId error:&decodeError];
+
+                if (decodeError) {
+                    errorInfo = [ARTErrorInfo createWithCode:ARTErrorUnableToDecodeMessage message:decodeError.localizedDescription];
+                }
+                else if (!data) {
+                    errorInfo = [ARTErrorInfo createWithCode:ARTErrorUnableToDecodeMessage message:@"Data is nil"];
+                }
+                else {
+                    _baseId = identifier;
+                }
             }
         } else {
             errorInfo = [ARTErrorInfo createWithCode:ARTErrorInvalidMessageDataOrEncoding
                                              message:[NSString stringWithFormat:@"unknown encoding: '%@'", encoding]];
         }
 
-        [self setDeltaCodecBase:data identifier:identifier];
-
         if (errorInfo == nil) {
             outputEncoding = [outputEncoding artRemoveLastEncoding];
         } else {
             break;
         }
     }
-    
+
+    if (data != nil && data == _deltaArena.base) {
+        // The arena's buffer is reused for subsequent deltas, so binary payloads are handed out as a copy.
+        data = [data copy];
+    }
+
     return [[ARTDataEncoderOutput alloc] initWithData:data
                                              encoding:outputEncoding
                                             errorInfo:errorInfo];
@@ -73,6 +73,10 @@ static NSInteger _maxMessageSize = 65536;
     return _maxMessageSize;
 }
 
++ (NSUInteger)channelMessageSliceSize {
+    return 500;
+}
+
 + (void)setConnectionStateTtl:(NSTimeInterval)value {
     @synchronized (self) {
         _connectionStateTtl = value;
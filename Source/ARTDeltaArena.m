@@ -0,0 +1,381 @@
+#import "ARTDeltaArena.h"
+#import "ARTStatus.h"
+
+/*
+ A decoder for the subset of VCDIFF (RFC 3284) produced by Ably: the default code table, no secondary compression. Windows may carry a checksum after the section lengths (the `VCD_ADLER32` extension); it is skipped, since its size can be derived from the delta encoding length.
+ */
+
+enum {
+    ARTVCDiffHeaderDecompress = 0x01,
+    ARTVCDiffHeaderCodeTable = 0x02,
+    ARTVCDiffHeaderAppHeader = 0x04,
+};
+
+enum {
+    ARTVCDiffWindowSource = 0x01,
+    ARTVCDiffWindowTarget = 0x02,
+};
+
+typedef NS_ENUM(uint8_t, ARTVCDiffInstructionType) {
+    ARTVCDiffInstructionNoop = 0,
+    ARTVCDiffInstructionAdd,
+    ARTVCDiffInstructionRun,
+    ARTVCDiffInstructionCopy,
+};
+
+typedef struct {
+    ARTVCDiffInstructionType type[2];
+    uint8_t size[2];
+    uint8_t mode[2];
+} ARTVCDiffCodeTableEntry;
+
+enum {
+    ARTVCDiffNearCacheSize = 4,
+    ARTVCDiffSameCacheSize = 3,
+};
+
+static ARTVCDiffCodeTableEntry ARTVCDiffDefaultCodeTable[256];
+
+/// RFC 3284, section 5.6.
+static void ARTVCDiffBuildDefaultCodeTable(void) {
+    size_t i = 0;
+    ARTVCDiffCodeTableEntry *table = ARTVCDiffDefaultCodeTable;
+
+    table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionRun, ARTVCDiffInstructionNoop }, { 0, 0 }, { 0, 0 } };
+    for (uint8_t size = 0; size <= 17; size++) {
+        table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionAdd, ARTVCDiffInstructionNoop }, { size, 0 }, { 0, 0 } };
+    }
+    for (uint8_t mode = 0; mode <= 8; mode++) {
+        table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionCopy, ARTVCDiffInstructionNoop }, { 0, 0 }, { mode, 0 } };
+        for (uint8_t size = 4; size <= 18; size++) {
+            table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionCopy, ARTVCDiffInstructionNoop }, { size, 0 }, { mode, 0 } };
+        }
+    }
+    for (uint8_t mode = 0; mode <= 5; mode++) {
+        for (uint8_t addSize = 1; addSize <= 4; addSize++) {
+            for (uint8_t copySize = 4; copySize <= 6; copySize++) {
+                table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionAdd, ARTVCDiffInstructionCopy }, { addSize, copySize }, { 0, mode } };
+            }
+        }
+    }
+    for (uint8_t mode = 6; mode <= 8; mode++) {
+        for (uint8_t addSize = 1; addSize <= 4; addSize++) {
+            table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionAdd, ARTVCDiffInstructionCopy }, { addSize, 4 }, { 0, mode } };
+        }
+    }
+    for (uint8_t mode = 0; mode <= 8; mode++) {
+        table[i++] = (ARTVCDiffCodeTableEntry){ { ARTVCDiffInstructionCopy, ARTVCDiffInstructionAdd }, { 4, 1 }, { mode, 0 } };
+    }
+}
+
+typedef struct {
+    const uint8_t *position;
+    const uint8_t *end;
+} ARTVCDiffReader;
+
+static BOOL ARTVCDiffReadByte(ARTVCDiffReader *reader, uint8_t *byte) {
+    if (reader->position >= reader->end) {
+        return NO;
+    }
+    *byte = *reader->position++;
+    return YES;
+}
+
+/// Reads a base-128, most significant digit first, integer (RFC 3284, section 2).
+static BOOL ARTVCDiffReadInteger(ARTVCDiffReader *reader, size_t *value) {
+    size_t result = 0;
+    uint8_t byte;
+    do {
+        if (!ARTVCDiffReadByte(reader, &byte) || result > (SIZE_MAX >> 7)) {
+            return NO;
+        }
+        result = (result << 7) | (byte & 0x7F);
+    } while (byte & 0x80);
+    *value = result;
+    return YES;
+}
+
+typedef struct {
+    size_t near[ARTVCDiffNearCacheSize];
+    size_t nextNearSlot;
+    size_t same[ARTVCDiffSameCacheSize * 256];
+} ARTVCDiffAddressCache;
+
+/// RFC 3284, section 5.3.
+static BOOL ARTVCDiffDecodeAddress(ARTVCDiffAddressCache *cache, ARTVCDiffReader *addresses, uint8_t mode, size_t here, size_t *address) {
+    size_t value;
+    if (mode == 0) {
+        if (!ARTVCDiffReadInteger(addresses, &value)) {
+            return NO;
+        }
+        *address = value;
+    }
+    else if (mode == 1) {
+        if (!ARTVCDiffReadInteger(addresses, &value) || value > here) {
+            return NO;
+        }
+        *address = here - value;
+    }
+    else if (mode < 2 + ARTVCDiffNearCacheSize) {
+        if (!ARTVCDiffReadInteger(addresses, &value)) {
+            return NO;
+        }
+        *address = cache->near[mode - 2] + value;
+    }
+    else if (mode < 2 + ARTVCDiffNearCacheSize + ARTVCDiffSameCacheSize) {
+        uint8_t byte;
+        if (!ARTVCDiffReadByte(addresses, &byte)) {
+            return NO;
+        }
+        *address = cache->same[(mode - 2 - ARTVCDiffNearCacheSize) * 256 + byte];
+    }
+    else {
+        return NO;
+    }
+
+    if (*address >= here) {
+        return NO;
+    }
+
+    cache->near[cache->nextNearSlot] = *address;
+    cache->nextNearSlot = (cache->nextNearSlot + 1) % ARTVCDiffNearCacheSize;
+    cache->same[*address % (ARTVCDiffSameCacheSize * 256)] = *address;
+    return YES;
+}
+
+/**
+ Decodes `delta` against `source`, replacing the contents of `target`. `target` is only ever grown, so once it has reached the size of the payloads being decoded no further allocations happen.
+
+ @return `nil` on success, otherwise a description of the failure.
+ */
+static NSString *ARTVCDiffDecode(const uint8_t *delta, size_t deltaLength, const uint8_t *source, size_t sourceLength, NSMutableData *target) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        ARTVCDiffBuildDefaultCodeTable();
+    });
+
+    ARTVCDiffReader reader = { delta, delta + deltaLength };
+    uint8_t header[5];
+    for (size_t i = 0; i < sizeof(header); i++) {
+        if (!ARTVCDiffReadByte(&reader, &header[i])) {
+            return @"vcdiff header is truncated";
+        }
+    }
+    if (header[0] != 0xD6 || header[1] != 0xC3 || header[2] != 0xC4 || header[3] != 0x00) {
+        return @"vcdiff header has an invalid magic number";
+    }
+    if (header[4] & ARTVCDiffHeaderDecompress) {
+        return @"vcdiff secondary compression is not supported";
+    }
+    if (header[4] & ARTVCDiffHeaderCodeTable) {
+        return @"vcdiff application-defined code tables are not supported";
+    }
+    if (header[4] & ARTVCDiffHeaderAppHeader) {
+        size_t appHeaderLength;
+        if (!ARTVCDiffReadInteger(&reader, &appHeaderLength) || appHeaderLength > (size_t)(reader.end - reader.position)) {
+            return @"vcdiff application header is truncated";
+        }
+        reader.position += appHeaderLength;
+    }
+
+    size_t targetLength = 0;
+    [target setLength:0];
+
+    while (reader.position < reader.end) {
+        uint8_t windowIndicator;
+        ARTVCDiffReadByte(&reader, &windowIndicator);
+
+        size_t segmentLength = 0, segmentPosition = 0;
+        if (windowIndicator & (ARTVCDiffWindowSource | ARTVCDiffWindowTarget)) {
+            if ((windowIndicator & ARTVCDiffWindowSource) && (windowIndicator & ARTVCDiffWindowTarget)) {
+                return @"vcdiff window has both a source and a target segment";
+            }
+            if (!ARTVCDiffReadInteger(&reader, &segmentLength) || !ARTVCDiffReadInteger(&reader, &segmentPosition)) {
+                return @"vcdiff window header is truncated";
+            }
+            const size_t available = (windowIndicator & ARTVCDiffWindowSource) ? sourceLength : targetLength;
+            if (segmentPosition > available || segmentLength > available - segmentPosition) {
+                return @"vcdiff window segment is out of bounds";
+            }
+        }
+
+        size_t encodingLength;
+        if (!ARTVCDiffReadInteger(&reader, &encodingLength) || encodingLength > (size_t)(reader.end - reader.position)) {
+            return @"vcdiff window is truncated";
+        }
+        const uint8_t *const windowEnd = reader.position + encodingLength;
+        ARTVCDiffReader window = { reader.position, windowEnd };
+        reader.position = windowEnd;
+
+        size_t windowLength, dataLength, instructionsLength, addressesLength;
+        uint8_t deltaIndicator;
+        if (!ARTVCDiffReadInteger(&window, &windowLength)
+            || !ARTVCDiffReadByte(&window, &deltaIndicator)
+            || !ARTVCDiffReadInteger(&window, &dataLength)
+            || !ARTVCDiffReadInteger(&window, &instructionsLength)
+            || !ARTVCDiffReadInteger(&window, &addressesLength)) {
+            return @"vcdiff window header is truncated";
+        }
+        if (deltaIndicator != 0) {
+            return @"vcdiff secondary compression is not supported";
+        }
+        const size_t windowRemaining = (size_t)(windowEnd - window.position);
+        if (dataLength > windowRemaining || instructionsLength > windowRemaining - dataLength || addressesLength > windowRemaining - dataLength - instructionsLength) {
+            return @"vcdiff window sections are truncated";
+        }
+        if (windowLength > SIZE_MAX - targetLength) {
+            return @"vcdiff target window is too large";
+        }
+
+        // Anything between the section lengths and the sections themselves is a checksum.
+        const uint8_t *const sections = windowEnd - (dataLength + instructionsLength + addressesLength);
+        ARTVCDiffReader data = { sections, sections + dataLength };
+        ARTVCDiffReader instructions = { data.end, data.end + instructionsLength };
+        ARTVCDiffReader addresses = { instructions.end, instructions.end + addressesLength };
+
+        const size_t windowOffset = targetLength;
+        targetLength += windowLength;
+        [target setLength:targetLength];
+        uint8_t *const bytes = target.mutableBytes;
+        uint8_t *const output = bytes + windowOffset;
+        const uint8_t *const segment = (windowIndicator & ARTVCDiffWindowTarget) ? bytes + segmentPosition : source + segmentPosition;
+
+        ARTVCDiffAddressCache cache = { 0 };
+        size_t outputPosition = 0;
+
+        while (instructions.position < instructions.end) {
+            const ARTVCDiffCodeTableEntry *const entry = &ARTVCDiffDefaultCodeTable[*instructions.position++];
+
+            for (int half = 0; half < 2; half++) {
+                const ARTVCDiffInstructionType type = entry->type[half];
+                if (type == ARTVCDiffInstructionNoop) {
+                    continue;
+                }
+                size_t size = entry->size[half];
+                if (size == 0 && !ARTVCDiffReadInteger(&instructions, &size)) {
+                    return @"vcdiff instruction size is truncated";
+                }
+                if (size > windowLength - outputPosition) {
+                    return @"vcdiff instruction overflows the target window";
+                }
+
+                switch (type) {
+                    case ARTVCDiffInstructionAdd:
+                        if (size > (size_t)(data.end - data.position)) {
+                            return @"vcdiff ADD overflows the data section";
+                        }
+                        memcpy(output + outputPosition, data.position, size);
+                        data.position += size;
+                        break;
+                    case ARTVCDiffInstructionRun: {
+                        uint8_t byte;
+                        if (!ARTVCDiffReadByte(&data, &byte)) {
+                            return @"vcdiff RUN overflows the data section";
+                        }
+                        memset(output + outputPosition, byte, size);
+                        break;
+                    }
+                    case ARTVCDiffInstructionCopy: {
+                        size_t address;
+                        if (!ARTVCDiffDecodeAddress(&cache, &addresses, entry->mode[half], segmentLength + outputPosition, &address)) {
+                            return @"vcdiff COPY has an invalid address";
+                        }
+                        size_t copied = 0;
+                        if (address < segmentLength) {
+                            copied = MIN(size, segmentLength - address);
+                            memcpy(output + outputPosition, segment + address, copied);
+                            address = segmentLength;
+                        }
+                        if (copied < size) {
+                            // The remainder comes from the target window itself and may overlap the bytes being written, in which case the bytes must be copied one at a time.
+                            const size_t from = address - segmentLength;
+                            const size_t to = outputPosition + copied;
+                            const size_t remaining = size - copied;
+                            if (from + remaining <= to) {
+                                memcpy(output + to, output + from, remaining);
+                            }
+                            else {
+                                for (size_t i = 0; i < remaining; i++) {
+                                    output[to + i] = output[from + i];
+                                }
+                            }
+                        }
+                        break;
+                    }
+                    case ARTVCDiffInstructionNoop:
+                        break;
+                }
+                outputPosition += size;
+            }
+        }
+
+        if (outputPosition != windowLength) {
+            return @"vcdiff target window length does not match its instructions";
+        }
+    }
+
+    return nil;
+}
+
+@implementation ARTDeltaArena {
+    NSMutableData *_buffers[2];
+    NSUInteger _baseIndex;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _buffers[0] = [NSMutableData data];
+        _buffers[1] = [NSMutableData data];
+    }
+    return self;
+}
+
+- (NSData *)base {
+    return _baseId ? _buffers[_baseIndex] : nil;
+}
+
+- (void)setBase:(NSData *)data withId:(NSString *)baseId {
+    NSMutableData *const buffer = _buffers[_baseIndex];
+    [buffer setLength:data.length];
+    if (data.length) {
+        memcpy(buffer.mutableBytes, data.bytes, data.length);
+    }
+    _baseId = baseId;
+}
+
+- (void)setBaseString:(NSString *)string withId:(NSString *)baseId {
+    NSMutableData *const buffer = _buffers[_baseIndex];
+    const NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    [buffer setLength:length];
+    if (length) {
+        [string getBytes:buffer.mutableBytes maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+    }
+    _baseId = baseId;
+}
+
+- (NSData *)applyDelta:(NSData *)delta deltaId:(NSString *)deltaId baseId:(NSString *)baseId error:(NSError **)error {
+    NSString *failure = nil;
+    if (!_baseId) {
+        failure = @"No base payload is available to apply the vcdiff delta to";
+    }
+    else if (![baseId isEqualToString:_baseId]) {
+        failure = [NSString stringWithFormat:@"vcdiff delta base id '%@' does not match the stored base id '%@'", baseId, _baseId];
+    }
+    else {
+        NSData *const base = _buffers[_baseIndex];
+        failure = ARTVCDiffDecode(delta.bytes, delta.length, base.bytes, base.length, _buffers[1 - _baseIndex]);
+    }
+
+    if (failure) {
+        if (error) {
+            *error = [NSError errorWithDomain:ARTAblyErrorDomain code:ARTErrorUnableToDecodeMessage userInfo:@{NSLocalizedDescriptionKey: failure}];
+        }
+        return nil;
+    }
+
+    _baseIndex = 1 - _baseIndex;
+    _baseId = deltaId;
+    return _buffers[_baseIndex];
+}
+
+@end
@@ -160,6 +160,10 @@
 
 @implementation ARTEventEmitter
 
+@synthesize notificationCenter = _notificationCenter;
+@synthesize listeners = _listeners;
+@synthesize anyListeners = _anyListeners;
+
 - (instancetype)initWithQueue:(dispatch_queue_t)queue {
     self = [self initWithQueues:queue userQueue:nil];
     return self;
@@ -168,24 +172,49 @@
 - (instancetype)initWithQueues:(dispatch_queue_t)queue userQueue:(dispatch_queue_t)userQueue {
     self = [super init];
     if (self) {
-        _notificationCenter = [[NSNotificationCenter alloc] init];
         _queue = queue;
         _userQueue = userQueue;
-        [self resetListeners];
     }
     return self;
 }
 
+// Most emitters never get a listener, so the notification center and the collections of listeners are only created with the first one.
+
+- (NSNotificationCenter *)notificationCenter {
+    if (!_notificationCenter) {
+        _notificationCenter = [[NSNotificationCenter alloc] init];
+    }
+    return _notificationCenter;
+}
+
+- (NSMutableDictionary<NSString *, NSMutableArray<ARTEventListener *> *> *)listeners {
+    if (!_listeners) {
+        _listeners = [[NSMutableDictionary alloc] init];
+    }
+    return _listeners;
+}
+
+- (NSMutableArray<ARTEventListener *> *)anyListeners {
+    if (!_anyListeners) {
+        _anyListeners = [[NSMutableArray alloc] init];
+    }
+    return _anyListeners;
+}
+
+- (BOOL)hasListeners {
+    return _listeners.count > 0 || _anyListeners.count > 0;
+}
+
 - (ARTEventListener *)on:(id<ARTEventIdentification>)event callback:(void (^)(id))cb {
     NSString *eventId = [NSString stringWithFormat:@"%p-%@", self, [event identification]];
     __block ARTEventListener *listener;
-    id<NSObject> observer = [_notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
+    id<NSObject> observer = [self.notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
         if (listener == nil || [listener invalidated]) return;
         if ([listener hasTimer] && ![listener timerIsRunning]) return;
         [listener stopTimer];
         cb(note.object);
     }];
-    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:_notificationCenter];
+    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:self.notificationCenter];
     [self addObject:listener toArrayWithKey:listener.eventId inDictionary:self.listeners];
     return listener;
 }
@@ -194,7 +223,7 @@
     NSString *eventId = [NSString stringWithFormat:@"%p-%@", self, [event identification]];
     __block ARTEventListener *listener;
     __weak typeof(self) weakSelf = self; // weak to avoid a warning, but strong should be safe too since the cycle is broken when the notification fires or the observer is cancelled
-    id<NSObject> observer = [_notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
+    id<NSObject> observer = [self.notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
         if (listener == nil || [listener invalidated]) return;
         if ([listener hasTimer] && ![listener timerIsRunning]) return;
         if ([listener handled]) return;
@@ -202,7 +231,7 @@
         [weakSelf removeObject:listener fromArrayWithKey:[listener eventId] inDictionary:[weakSelf listeners]];
         cb(note.object);
     }];
-    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:_notificationCenter];
+    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:self.notificationCenter];
     [self addObject:listener toArrayWithKey:listener.eventId inDictionary:self.listeners];
     return listener;
 }
@@ -210,13 +239,13 @@
 - (ARTEventListener *)on:(void (^)(id))cb {
     NSString *eventId = [NSString stringWithFormat:@"%p", self];
     __block ARTEventListener *listener;
-    id<NSObject> observer = [_notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
+    id<NSObject> observer = [self.notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
         if (listener == nil || [listener invalidated]) return;
         if ([listener hasTimer] && ![listener timerIsRunning]) return;
         [listener stopTimer];
         cb(note.object);
     }];
-    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:_notificationCenter];
+    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:self.notificationCenter];
     [self.anyListeners addObject:listener];
     return listener;
 }
@@ -225,7 +254,7 @@
     NSString *eventId = [NSString stringWithFormat:@"%p", self];
     __block ARTEventListener *listener;
     __weak typeof(self) weakSelf = self; // weak to avoid a warning, but strong should be safe too since the cycle is broken when the notification fires or the observer is cancelled
-    id<NSObject> observer = [_notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
+    id<NSObject> observer = [self.notificationCenter addObserverForName:eventId object:nil queue:nil usingBlock:^(NSNotification * _Nonnull note) {
         if (listener == nil || [listener invalidated]) return;
         if ([listener hasTimer] && ![listener timerIsRunning]) return;
         if ([listener handled]) return;
@@ -233,7 +262,7 @@
         [[weakSelf anyListeners] removeObject:listener];
         cb(note.object);
     }];
-    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:_notificationCenter];
+    listener = [[ARTEventListener alloc] initWithId:eventId observer:observer handler:self center:self.notificationCenter];
     [self.anyListeners addObject:listener];
     return listener;
 }
@@ -265,20 +294,24 @@
         }
     }
     [_listeners removeAllObjects];
-    _listeners = [[NSMutableDictionary alloc] init];
+    _listeners = nil;
 
     for (ARTEventListener *item in _anyListeners) {
         [item removeObserver];
     }
     [_anyListeners removeAllObjects];
-    _anyListeners = [[NSMutableArray alloc] init];
+    _anyListeners = nil;
 }
 
 - (void)emit:(id<ARTEventIdentification>)event with:(id)data {
+    if (!_notificationCenter) {
+        // No listener was ever added.
+        return;
+    }
     if (event) {
-        [self.notificationCenter postNotificationName:[NSString stringWithFormat:@"%p-%@", self, [event identification]] object:data];
+        [_notificationCenter postNotificationName:[NSString stringWithFormat:@"%p-%@", self, [event identification]] object:data];
     }
-    [self.notificationCenter postNotificationName:[NSString stringWithFormat:@"%p", self] object:data];
+    [_notificationCenter postNotificationName:[NSString stringWithFormat:@"%p", self] object:data];
 }
 
 - (void)addObject:(id)obj toArrayWithKey:(id)key inDictionary:(NSMutableDictionary *)dict {
@@ -340,10 +373,6 @@
     return self;
 }
 
-- (void)dealloc {
-    [self.notificationCenter removeObserver:self];
-}
-
 - (ARTEventListener *)on:(id)event callback:(void (^)(id _Nullable))cb {
     if (cb) {
         void (^userCallback)(id _Nullable) = cb;
@@ -0,0 +1,145 @@
+#import "ARTOutboundScheduler.h"
+#import "ARTQueuedMessage.h"
+#import "ARTProtocolMessage.h"
+
+enum {
+    ARTOutboundPriorityCount = ARTOutboundPriorityPublish + 1
+};
+
+@interface ARTOutboundEntry : NSObject
+
+@property (nonatomic, readonly) ARTQueuedMessage *message;
+@property (nonatomic, readonly) NSUInteger sequence;
+
+@end
+
+@implementation ARTOutboundEntry
+
+- (instancetype)initWithMessage:(ARTQueuedMessage *)message sequence:(NSUInteger)sequence {
+    if (self = [super init]) {
+        _message = message;
+        _sequence = sequence;
+    }
+    return self;
+}
+
+@end
+
+@implementation ARTOutboundScheduler {
+    NSUInteger _fairnessInterval;
+    NSMutableArray<ARTOutboundEntry *> *_queues[ARTOutboundPriorityCount];
+    // How many messages of higher priorities have been dequeued since a message of each priority last was.
+    NSUInteger _waits[ARTOutboundPriorityCount];
+    NSUInteger _nextSequence;
+    // The sequences of the messages waiting in each priority, by channel, so that the oldest one for a channel is looked up rather than searched for.
+    NSMutableDictionary<NSString *, NSMutableIndexSet *> *_channelSequences[ARTOutboundPriorityCount];
+}
+
+- (instancetype)initWithFairnessInterval:(NSUInteger)fairnessInterval {
+    if (self = [super init]) {
+        _fairnessInterval = MAX(fairnessInterval, 1);
+        for (NSUInteger priority = 0; priority < ARTOutboundPriorityCount; priority++) {
+            _queues[priority] = [NSMutableArray array];
+            _channelSequences[priority] = [NSMutableDictionary dictionary];
+        }
+    }
+    return self;
+}
+
++ (ARTOutboundPriority)priorityOfProtocolMessage:(ARTProtocolMessage *)message {
+    switch (message.action) {
+        case ARTProtocolMessageMessage:
+            return ARTOutboundPriorityPublish;
+        case ARTProtocolMessagePresence:
+            return ARTOutboundPriorityPresence;
+        default:
+            return ARTOutboundPriorityControl;
+    }
+}
+
+- (NSUInteger)count {
+    NSUInteger count = 0;
+    for (NSUInteger priority = 0; priority < ARTOutboundPriorityCount; priority++) {
+        count += _queues[priority].count;
+    }
+    return count;
+}
+
+- (void)enqueue:(ARTQueuedMessage *)message {
+    const ARTOutboundPriority priority = [self.class priorityOfProtocolMessage:message.msg];
+    if (_queues[priority].count == 0) {
+        _waits[priority] = 0;
+    }
+    const NSUInteger sequence = _nextSequence++;
+    [_queues[priority] addObject:[[ARTOutboundEntry alloc] initWithMessage:message sequence:sequence]];
+
+    NSString *const channel = message.msg.channel;
+    if (channel) {
+        NSMutableIndexSet *sequences = _channelSequences[priority][channel];
+        if (!sequences) {
+            sequences = [NSMutableIndexSet indexSet];
+            _channelSequences[priority][channel] = sequences;
+        }
+        [sequences addIndex:sequence];
+    }
+}
+
+- (ARTQueuedMessage *)dequeue {
+    const NSUInteger priority = [self nextPriority];
+    if (priority == NSNotFound) {
+        return nil;
+    }
+    ARTOutboundEntry *const entry = _queues[priority].firstObject;
+    [_queues[priority] removeObjectAtIndex:0];
+    NSString *const channel = entry.message.msg.channel;
+    if (channel) {
+        NSMutableIndexSet *const sequences = _channelSequences[priority][channel];
+        [sequences removeIndex:entry.sequence];
+        if (sequences.count == 0) {
+            [_channelSequences[priority] removeObjectForKey:channel];
+        }
+    }
+    _waits[priority] = 0;
+    for (NSUInteger lower = priority + 1; lower < ARTOutboundPriorityCount; lower++) {
+        if (_queues[lower].count > 0) {
+            _waits[lower]++;
+        }
+    }
+    return entry.message;
+}
+
+- (NSUInteger)nextPriority {
+    // The oldest message of a lower priority that has waited for long enough goes first.
+    for (NSUInteger priority = 1; priority < ARTOutboundPriorityCount; priority++) {
+        if (_queues[priority].count > 0 && _waits[priority] >= _fairnessInterval && [self canDequeueEntry:_queues[priority].firstObject ofPriority:priority]) {
+            return priority;
+        }
+    }
+    // The message enqueued first of all can always be dequeued, so one of the priorities can.
+    for (NSUInteger priority = 0; priority < ARTOutboundPriorityCount; priority++) {
+        if (_queues[priority].count > 0 && [self canDequeueEntry:_queues[priority].firstObject ofPriority:priority]) {
+            return priority;
+        }
+    }
+    return NSNotFound;
+}
+
+/// A message can be sent unless a message of another priority for the same channel was enqueued before it, so that the messages of a channel are sent in the order they were enqueued in.
+- (BOOL)canDequeueEntry:(ARTOutboundEntry *)entry ofPriority:(NSUInteger)priority {
+    NSString *const channel = entry.message.msg.channel;
+    if (channel == nil) {
+        return YES;
+    }
+    for (NSUInteger other = 0; other < ARTOutboundPriorityCount; other++) {
+        if (other == priority) {
+            continue;
+        }
+        NSIndexSet *const sequences = _channelSequences[other][channel];
+        if (sequences && sequences.firstIndex < entry.sequence) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+@end
@@ -3,11 +3,16 @@
 #import "ARTPresenceMessage+Private.h"
 #import "ARTEventEmitter+Private.h"
 #import "ARTInternalLog.h"
+#import "ARTPresenceSnapshot+Private.h"
+#import "ARTPresenceMemberStore.h"
+
+/// How many changes of the presence set are remembered for `changesSinceVersion:`.
+static const NSUInteger ARTPresenceMapChangeLogCapacity = 10000;
 
 typedef NS_ENUM(NSUInteger, ARTPresenceSyncState) {
     ARTPresenceSyncInitialized,
     ARTPresenceSyncStarted, //ItemType: nil
-    ARTPresenceSyncEnded, //ItemType: NSArray<ARTPresenceMessage *>*
+    ARTPresenceSyncEnded, //ItemType: nil
     ARTPresenceSyncFailed //ItemType: ARTErrorInfo*
 };
 
@@ -33,13 +38,53 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
 
 @end
 
+#pragma mark - ARTPresenceMapChange
+
+/// A change of the presence of a single member, recorded at the version of the presence set it produced.
+@interface ARTPresenceMapChange : NSObject
+
+@property (nonatomic, readonly) BOOL wasPresent;
+@property (nonatomic, readonly) BOOL isPresent;
+/// The member after the change, or as it was last seen if it left.
+@property (nonatomic, readonly) ARTPresenceMessage *member;
+
+@end
+
+@implementation ARTPresenceMapChange
+
+- (instancetype)initWithWasPresent:(BOOL)wasPresent isPresent:(BOOL)isPresent member:(ARTPresenceMessage *)member {
+    self = [super init];
+    if (self) {
+        _wasPresent = wasPresent;
+        _isPresent = isPresent;
+        _member = member;
+    }
+    return self;
+}
+
+@end
+
 #pragma mark - ARTPresenceMap
 
 @interface ARTPresenceMap () {
     ARTPresenceSyncState _syncState;
     ARTEventEmitter<ARTEvent * /*ARTSyncState*/, id> *_syncEventEmitter;
-    NSMutableDictionary<NSString *, ARTPresenceMessage *> *_members;
+    // The members, materialized only when asked for. Also indexes them by clientId and connectionId.
+    ARTPresenceMemberStore *_store;
     NSMutableSet<ARTPresenceMessage *> *_localMembers;
+    // Every slot of `_store` is in exactly one of these: members tagged with the current `syncSessionId`, or with an older one. `startSync` moves all members to the stale set, so what is left there when the sync ends is the members that weren't part of it.
+    // The sync session of a member is only kept here, outside of the store, so that marking a member as part of the sync doesn't copy a shared store.
+    NSMutableIndexSet *_syncedSlots;
+    NSMutableIndexSet *_staleSlots;
+    // The members marked as ABSENT while a sync is in progress (RTP2h2a).
+    NSMutableIndexSet *_absentSlots;
+    // Set once `_store` has been handed to a snapshot; it is then copied before being mutated again.
+    BOOL _storeShared;
+    // `members`, materialized on first access after each change of `_store`.
+    NSDictionary<NSString *, ARTPresenceMessage *> *_members;
+    // The change that produced version `_changeLogBaseVersion + 1 + i` is at index i.
+    NSMutableArray<ARTPresenceMapChange *> *_changeLog;
+    NSUInteger _changeLogBaseVersion;
 }
 
 @end
@@ -52,6 +97,7 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
     self = [super init];
     if(self) {
         _logger = logger;
+        _version = 0;
         [self reset];
         _syncSessionId = 0;
         _syncState = ARTPresenceSyncInitialized;
@@ -61,16 +107,34 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
 }
 
 - (NSDictionary<NSString *, ARTPresenceMessage *> *)members {
+    if (!_members) {
+        _members = [_store membersByKey];
+    }
     return _members;
 }
 
+- (NSUInteger)memberCount {
+    return _store.count;
+}
+
 - (NSMutableSet<ARTPresenceMessage *> *)localMembers {
     return _localMembers;
 }
 
+- (NSArray<ARTPresenceMessage *> *)membersWithClientId:(NSString *)clientId connectionId:(NSString *)connectionId {
+    if (clientId == nil && connectionId == nil) {
+        return [_store membersAtSlots:_store.slots];
+    }
+    if (clientId != nil && connectionId != nil) {
+        const NSUInteger slot = [_store slotOfMemberWithClientId:clientId connectionId:connectionId];
+        return slot != NSNotFound ? @[[_store memberAtSlot:slot]] : @[];
+    }
+    return [_store membersAtSlots:clientId ? [_store slotsOfMembersWithClientId:clientId] : [_store slotsOfMembersWithConnectionId:connectionId]];
+}
+
 - (BOOL)add:(ARTPresenceMessage *)message {
-    ARTPresenceMessage *latest = [_members objectForKey:message.memberKey];
-    if ([message isNewerThan:latest]) {
+    const NSUInteger slot = [_store slotOfMemberWithClientId:message.clientId connectionId:message.connectionId];
+    if (slot == NSNotFound || [_store isMessage:message newerThanMemberAtSlot:slot]) {
         ARTPresenceMessage *messageCopy = [message copy];
         switch (message.action) {
             case ARTPresenceEnter:
@@ -89,7 +153,9 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
         return YES;
     }
     ARTLogDebug(_logger, @"Presence member \"%@\" with action %@ has been ignored", message.memberKey, ARTPresenceActionToStr(message.action));
-    latest.syncSessionId = _syncSessionId;
+    [self trackSlot:slot syncSessionId:_syncSessionId];
+    // The local member with the same clientId and connectionId must be marked as part of the sync too (RTP17).
+    [[_localMembers member:message] setSyncSessionId:_syncSessionId];
     return NO;
 }
 
@@ -99,7 +165,14 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
 
 - (void)internalAdd:(ARTPresenceMessage *)message withSessionId:(NSUInteger)sessionId {
     message.syncSessionId = sessionId;
-    [_members setObject:message forKey:message.memberKey];
+    const NSUInteger previousSlot = [_store slotOfMemberWithClientId:message.clientId connectionId:message.connectionId];
+    const BOOL wasPresent = previousSlot != NSNotFound && [_store actionAtSlot:previousSlot] != ARTPresenceAbsent;
+    const BOOL isPresent = message.action != ARTPresenceAbsent;
+    if (wasPresent || isPresent) {
+        [self recordChangeWasPresent:wasPresent isPresent:isPresent member:isPresent ? message : [_store memberAtSlot:previousSlot]];
+    }
+    [self willMutateStore];
+    [self trackSlot:[_store setMember:message] syncSessionId:sessionId];
     // Local member
     if ([message.connectionId isEqualToString:self.delegate.connectionId]) {
         [_localMembers addObject:message];
@@ -124,51 +197,157 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
         [self internalAdd:message withSessionId:message.syncSessionId];
     }
     else {
-        [_members removeObjectForKey:message.memberKey];
+        const NSUInteger slot = [_store slotOfMemberWithClientId:message.clientId connectionId:message.connectionId];
+        if (slot != NSNotFound) {
+            [self removeMemberAtSlot:slot];
+        }
+    }
+}
+
+- (void)removeMemberAtSlot:(NSUInteger)slot {
+    if ([_store actionAtSlot:slot] != ARTPresenceAbsent) {
+        [self recordChangeWasPresent:YES isPresent:NO member:[_store memberAtSlot:slot]];
+    }
+    [self willMutateStore];
+    [_store removeMemberAtSlot:slot];
+    [_syncedSlots removeIndex:slot];
+    [_staleSlots removeIndex:slot];
+    [_absentSlots removeIndex:slot];
+}
+
+- (void)trackSlot:(NSUInteger)slot syncSessionId:(NSUInteger)syncSessionId {
+    if (syncSessionId == _syncSessionId) {
+        [_staleSlots removeIndex:slot];
+        [_syncedSlots addIndex:slot];
+    }
+    else {
+        [_syncedSlots removeIndex:slot];
+        [_staleSlots addIndex:slot];
+    }
+    if ([_store actionAtSlot:slot] == ARTPresenceAbsent) {
+        [_absentSlots addIndex:slot];
+    }
+    else {
+        [_absentSlots removeIndex:slot];
+    }
+}
+
+- (void)willMutateStore {
+    if (_storeShared) {
+        _store = [_store copy];
+        _storeShared = NO;
+    }
+    _members = nil;
+}
+
+- (void)recordChangeWasPresent:(BOOL)wasPresent isPresent:(BOOL)isPresent member:(ARTPresenceMessage *)member {
+    _version++;
+    if (_changeLog.count == ARTPresenceMapChangeLogCapacity) {
+        // Forget the oldest half at once rather than one change per new one.
+        const NSUInteger forgotten = ARTPresenceMapChangeLogCapacity / 2;
+        [_changeLog removeObjectsInRange:NSMakeRange(0, forgotten)];
+        _changeLogBaseVersion += forgotten;
+    }
+    [_changeLog addObject:[[ARTPresenceMapChange alloc] initWithWasPresent:wasPresent isPresent:isPresent member:member]];
+}
+
+- (ARTPresenceSnapshot *)snapshot {
+    _storeShared = YES;
+    return [[ARTPresenceSnapshot alloc] initWithStore:_store version:_version];
+}
+
+- (ARTPresenceChanges *)changesSinceVersion:(NSUInteger)version {
+    if (version < _changeLogBaseVersion || version > _version) {
+        return nil;
     }
+    // Fold the changes of each member into its net change: only whether it was present before the first one and is after the last one matters.
+    NSMutableDictionary<NSString *, ARTPresenceMapChange *> *const firstChanges = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, ARTPresenceMapChange *> *const lastChanges = [NSMutableDictionary dictionary];
+    for (NSUInteger i = version - _changeLogBaseVersion; i < _changeLog.count; i++) {
+        ARTPresenceMapChange *const change = [_changeLog objectAtIndex:i];
+        NSString *const memberKey = change.member.memberKey;
+        if (![firstChanges objectForKey:memberKey]) {
+            [firstChanges setObject:change forKey:memberKey];
+        }
+        [lastChanges setObject:change forKey:memberKey];
+    }
+    NSMutableArray<ARTPresenceMessage *> *const entered = [NSMutableArray array];
+    NSMutableArray<ARTPresenceMessage *> *const updated = [NSMutableArray array];
+    NSMutableArray<ARTPresenceMessage *> *const left = [NSMutableArray array];
+    [lastChanges enumerateKeysAndObjectsUsingBlock:^(NSString *memberKey, ARTPresenceMapChange *last, BOOL *stop) {
+        const BOOL wasPresent = [firstChanges objectForKey:memberKey].wasPresent;
+        if (!wasPresent && last.isPresent) {
+            [entered addObject:last.member];
+        }
+        else if (wasPresent && last.isPresent) {
+            [updated addObject:last.member];
+        }
+        else if (wasPresent) {
+            [left addObject:last.member];
+        }
+    }];
+    return [[ARTPresenceChanges alloc] initFromVersion:version toVersion:_version entered:entered updated:updated left:left];
 }
 
 - (void)cleanUpAbsentMembers {
     ARTLogDebug(_logger, @"%p cleaning up absent members (syncSessionId=%lu)", self, (unsigned long)_syncSessionId);
-    NSSet<NSString *> *filteredMembers = [_members keysOfEntriesPassingTest:^BOOL(NSString *key, ARTPresenceMessage *message, BOOL *stop) {
-        return message.action == ARTPresenceAbsent;
+    NSIndexSet *const absentSlots = _absentSlots;
+    _absentSlots = [NSMutableIndexSet indexSet];
+    [absentSlots enumerateIndexesUsingBlock:^(NSUInteger slot, BOOL *stop) {
+        [self internalRemove:[self->_store memberAtSlot:slot] force:true];
     }];
-    for (NSString *key in filteredMembers) {
-        [self internalRemove:[_members objectForKey:key] force:true];
-    }
 }
 
 - (void)leaveMembersNotPresentInSync {
     ARTLogDebug(_logger, @"%p leaving members not present in sync (syncSessionId=%lu)", self, (unsigned long)_syncSessionId);
-    for (ARTPresenceMessage *member in [_members allValues]) {
-        if (member.syncSessionId != _syncSessionId) {
-            // Handle members that have not been added or updated in the PresenceMap during the sync process
-            ARTPresenceMessage *leave = [member copy];
-            [self internalRemove:member];
-            [self.delegate map:self didRemovedMemberNoLongerPresent:leave];
-        }
-    }
+    // Handle members that have not been added or updated in the PresenceMap during the sync process
+    NSIndexSet *const staleSlots = _staleSlots;
+    _staleSlots = [NSMutableIndexSet indexSet];
+    [staleSlots enumerateIndexesUsingBlock:^(NSUInteger slot, BOOL *stop) {
+        ARTPresenceMessage *const leave = [self->_store memberAtSlot:slot];
+        [self internalRemove:leave force:true];
+        [self.delegate map:self didRemovedMemberNoLongerPresent:leave];
+    }];
 }
 
 - (void)reenterLocalMembersMissingFromSync {
     ARTLogDebug(_logger, @"%p reentering local members missed from sync (syncSessionId=%lu)", self, (unsigned long)_syncSessionId);
-    NSSet *filteredLocalMembers = [_localMembers filteredSetUsingPredicate:[NSPredicate predicateWithFormat:@"syncSessionId != %lu", (unsigned long)_syncSessionId]];
-    for (ARTPresenceMessage *localMember in filteredLocalMembers) {
+    NSMutableArray<ARTPresenceMessage *> *const missingLocalMembers = [NSMutableArray array];
+    for (ARTPresenceMessage *localMember in _localMembers) {
+        if (localMember.syncSessionId != _syncSessionId) {
+            [missingLocalMembers addObject:localMember];
+        }
+    }
+    for (ARTPresenceMessage *localMember in missingLocalMembers) {
         ARTPresenceMessage *reenter = [localMember copy];
         [self internalRemove:localMember];
         [self.delegate map:self shouldReenterLocalMember:reenter];
     }
-    [self cleanUpAbsentMembers];
 }
 
 - (void)reset {
-    _members = [NSMutableDictionary dictionary];
+    if (_store.count > 0) {
+        // Members are dropped without a change of their own, so changes since an earlier version can't be told anymore.
+        _version++;
+    }
+    _store = [[ARTPresenceMemberStore alloc] init];
+    _storeShared = NO;
+    _members = nil;
+    _changeLog = [NSMutableArray array];
+    _changeLogBaseVersion = _version;
     _localMembers = [NSMutableSet set];
+    _syncedSlots = [NSMutableIndexSet indexSet];
+    _staleSlots = [NSMutableIndexSet indexSet];
+    _absentSlots = [NSMutableIndexSet indexSet];
 }
 
 - (void)startSync {
     ARTLogDebug(_logger, @"%p PresenceMap sync started", self);
     _syncSessionId++;
+    // Every member now has an older syncSessionId than the current one.
+    [_syncedSlots addIndexes:_staleSlots];
+    _staleSlots = _syncedSlots;
+    _syncedSlots = [NSMutableIndexSet indexSet];
     _syncState = ARTPresenceSyncStarted;
     [_syncEventEmitter emit:[ARTEvent newWithPresenceSyncState:_syncState] with:nil];
 }
@@ -179,7 +358,7 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
     [self leaveMembersNotPresentInSync];
     _syncState = ARTPresenceSyncEnded;
     [self reenterLocalMembersMissingFromSync];
-    [_syncEventEmitter emit:[ARTEvent newWithPresenceSyncState:ARTPresenceSyncEnded] with:[_members allValues]];
+    [_syncEventEmitter emit:[ARTEvent newWithPresenceSyncState:ARTPresenceSyncEnded] with:nil];
     [_syncEventEmitter off];
     ARTLogDebug(_logger, @"%p PresenceMap sync ended", self);
 }
@@ -191,8 +370,10 @@ NSString *ARTPresenceSyncStateToStr(ARTPresenceSyncState state) {
     [_syncEventEmitter off];
 }
 
-- (void)onceSyncEnds:(void (^)(NSArray<ARTPresenceMessage *> *))callback {
-    [_syncEventEmitter once:[ARTEvent newWithPresenceSyncState:ARTPresenceSyncEnded] callback:callback];
+- (void)onceSyncEnds:(void (^)(void))callback {
+    [_syncEventEmitter once:[ARTEvent newWithPresenceSyncState:ARTPresenceSyncEnded] callback:^(id _) {
+        callback();
+    }];
 }
 
 - (void)onceSyncFails:(ARTCallback)callback {
@@ -0,0 +1,260 @@
+#import "ARTPresenceMemberStore.h"
+#import "ARTPresenceMessage+Private.h"
+
+typedef struct {
+    NSInteger msgSerial;
+    NSInteger index;
+    NSTimeInterval timestamp; // NAN when the member has no timestamp
+    uint8_t action;
+    BOOL hasCanonicalId; // when set, the id is rebuilt from connectionId, msgSerial and index
+    BOOL hasParsableId; // when not set, the member is materialized to be compared for newness, which raises
+    BOOL isSynthesized;
+} ARTPresenceMemberRow;
+
+static id ARTColumnGet(NSPointerArray *column, NSUInteger slot) {
+    return (__bridge id)[column pointerAtIndex:slot];
+}
+
+static void ARTColumnSet(NSPointerArray *column, NSUInteger slot, id value) {
+    [column replacePointerAtIndex:slot withPointer:(__bridge void *)value];
+}
+
+static NSString *ARTIntern(NSMutableSet<NSString *> *strings, NSString *string) {
+    NSString *interned = [strings member:string];
+    if (interned == nil) {
+        interned = [string copy];
+        [strings addObject:interned];
+    }
+    return interned;
+}
+
+@implementation ARTPresenceMemberStore {
+    NSMutableData *_rows;
+    // Object columns, indexed by slot like `_rows`.
+    NSPointerArray *_clientIds;
+    NSPointerArray *_connectionIds;
+    NSPointerArray *_ids;
+    NSPointerArray *_data;
+    NSPointerArray *_encodings;
+    NSMutableIndexSet *_usedSlots;
+    NSMutableIndexSet *_freeSlots;
+    // connectionId -> clientId -> slot. A missing clientId or connectionId is keyed by NSNull.
+    NSMutableDictionary<id, NSMutableDictionary<id, NSNumber *> *> *_slotsByConnectionId;
+    NSMutableDictionary<NSString *, NSMutableIndexSet *> *_slotsByClientId;
+    // Each interned string is dropped along with the last index entry that uses it.
+    NSMutableSet<NSString *> *_internedClientIds;
+    NSMutableSet<NSString *> *_internedConnectionIds;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _rows = [NSMutableData data];
+        _clientIds = [NSPointerArray strongObjectsPointerArray];
+        _connectionIds = [NSPointerArray strongObjectsPointerArray];
+        _ids = [NSPointerArray strongObjectsPointerArray];
+        _data = [NSPointerArray strongObjectsPointerArray];
+        _encodings = [NSPointerArray strongObjectsPointerArray];
+        _usedSlots = [NSMutableIndexSet indexSet];
+        _freeSlots = [NSMutableIndexSet indexSet];
+        _slotsByConnectionId = [NSMutableDictionary dictionary];
+        _slotsByClientId = [NSMutableDictionary dictionary];
+        _internedClientIds = [NSMutableSet set];
+        _internedConnectionIds = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    ARTPresenceMemberStore *const store = [[self.class allocWithZone:zone] init];
+    store->_rows = [_rows mutableCopy];
+    store->_clientIds = [_clientIds copy];
+    store->_connectionIds = [_connectionIds copy];
+    store->_ids = [_ids copy];
+    store->_data = [_data copy];
+    store->_encodings = [_encodings copy];
+    store->_usedSlots = [_usedSlots mutableCopy];
+    store->_freeSlots = [_freeSlots mutableCopy];
+    for (id connectionKey in _slotsByConnectionId) {
+        [store->_slotsByConnectionId setObject:[[_slotsByConnectionId objectForKey:connectionKey] mutableCopy] forKey:connectionKey];
+    }
+    for (NSString *clientId in _slotsByClientId) {
+        [store->_slotsByClientId setObject:[[_slotsByClientId objectForKey:clientId] mutableCopy] forKey:clientId];
+    }
+    store->_internedClientIds = [_internedClientIds mutableCopy];
+    store->_internedConnectionIds = [_internedConnectionIds mutableCopy];
+    return store;
+}
+
+- (NSUInteger)count {
+    return _usedSlots.count;
+}
+
+- (NSIndexSet *)slots {
+    return _usedSlots;
+}
+
+- (ARTPresenceMemberRow *)rowAtSlot:(NSUInteger)slot {
+    // Not to be kept across slot allocations, which may move the rows.
+    return (ARTPresenceMemberRow *)_rows.mutableBytes + slot;
+}
+
+- (NSUInteger)slotOfMemberWithClientId:(NSString *)clientId connectionId:(NSString *)connectionId {
+    NSNumber *const slot = [[_slotsByConnectionId objectForKey:connectionId ?: [NSNull null]] objectForKey:clientId ?: [NSNull null]];
+    return slot ? slot.unsignedIntegerValue : NSNotFound;
+}
+
+- (NSIndexSet *)slotsOfMembersWithClientId:(NSString *)clientId {
+    return [_slotsByClientId objectForKey:clientId] ?: [NSIndexSet indexSet];
+}
+
+- (NSIndexSet *)slotsOfMembersWithConnectionId:(NSString *)connectionId {
+    NSMutableIndexSet *const slots = [NSMutableIndexSet indexSet];
+    for (NSNumber *slot in [[_slotsByConnectionId objectForKey:connectionId] objectEnumerator]) {
+        [slots addIndex:slot.unsignedIntegerValue];
+    }
+    return slots;
+}
+
+- (NSUInteger)allocateSlotForClientId:(NSString *)clientId connectionId:(NSString *)connectionId {
+    NSUInteger slot = _freeSlots.firstIndex;
+    if (slot != NSNotFound) {
+        [_freeSlots removeIndex:slot];
+    }
+    else {
+        slot = _rows.length / sizeof(ARTPresenceMemberRow);
+        [_rows increaseLengthBy:sizeof(ARTPresenceMemberRow)];
+        _clientIds.count = slot + 1;
+        _connectionIds.count = slot + 1;
+        _ids.count = slot + 1;
+        _data.count = slot + 1;
+        _encodings.count = slot + 1;
+    }
+    [_usedSlots addIndex:slot];
+
+    if (clientId) {
+        clientId = ARTIntern(_internedClientIds, clientId);
+        NSMutableIndexSet *slots = [_slotsByClientId objectForKey:clientId];
+        if (!slots) {
+            slots = [NSMutableIndexSet indexSet];
+            [_slotsByClientId setObject:slots forKey:clientId];
+        }
+        [slots addIndex:slot];
+    }
+    if (connectionId) {
+        connectionId = ARTIntern(_internedConnectionIds, connectionId);
+    }
+    id const connectionKey = connectionId ?: [NSNull null];
+    NSMutableDictionary<id, NSNumber *> *slotsByClientId = [_slotsByConnectionId objectForKey:connectionKey];
+    if (!slotsByClientId) {
+        slotsByClientId = [NSMutableDictionary dictionary];
+        [_slotsByConnectionId setObject:slotsByClientId forKey:connectionKey];
+    }
+    [slotsByClientId setObject:@(slot) forKey:clientId ?: [NSNull null]];
+
+    ARTColumnSet(_clientIds, slot, clientId);
+    ARTColumnSet(_connectionIds, slot, connectionId);
+    return slot;
+}
+
+- (NSUInteger)setMember:(ARTPresenceMessage *)message {
+    NSUInteger slot = [self slotOfMemberWithClientId:message.clientId connectionId:message.connectionId];
+    if (slot == NSNotFound) {
+        slot = [self allocateSlotForClientId:message.clientId connectionId:message.connectionId];
+    }
+    ARTPresenceMemberRow *const row = [self rowAtSlot:slot];
+    row->action = (uint8_t)message.action;
+    NSDate *const timestamp = message.timestamp;
+    row->timestamp = timestamp ? timestamp.timeIntervalSince1970 : NAN;
+    row->hasCanonicalId = message.hasCanonicalId;
+    row->hasParsableId = message.hasParsableId;
+    row->isSynthesized = row->hasParsableId && message.isSynthesized;
+    const BOOL hasIdParts = row->hasParsableId && message.id != nil;
+    row->msgSerial = hasIdParts ? message.msgSerialFromId : 0;
+    row->index = hasIdParts ? message.indexFromId : 0;
+    ARTColumnSet(_ids, slot, row->hasCanonicalId ? nil : message.id);
+    ARTColumnSet(_data, slot, message.data);
+    ARTColumnSet(_encodings, slot, message.encoding);
+    return slot;
+}
+
+- (void)removeMemberAtSlot:(NSUInteger)slot {
+    NSString *const clientId = ARTColumnGet(_clientIds, slot);
+    NSString *const connectionId = ARTColumnGet(_connectionIds, slot);
+
+    id const connectionKey = connectionId ?: [NSNull null];
+    NSMutableDictionary<id, NSNumber *> *const slotsByClientId = [_slotsByConnectionId objectForKey:connectionKey];
+    [slotsByClientId removeObjectForKey:clientId ?: [NSNull null]];
+    if (slotsByClientId.count == 0) {
+        [_slotsByConnectionId removeObjectForKey:connectionKey];
+        if (connectionId) {
+            [_internedConnectionIds removeObject:connectionId];
+        }
+    }
+    if (clientId) {
+        NSMutableIndexSet *const slots = [_slotsByClientId objectForKey:clientId];
+        [slots removeIndex:slot];
+        if (slots.count == 0) {
+            [_slotsByClientId removeObjectForKey:clientId];
+            [_internedClientIds removeObject:clientId];
+        }
+    }
+
+    ARTColumnSet(_clientIds, slot, nil);
+    ARTColumnSet(_connectionIds, slot, nil);
+    ARTColumnSet(_ids, slot, nil);
+    ARTColumnSet(_data, slot, nil);
+    ARTColumnSet(_encodings, slot, nil);
+    memset([self rowAtSlot:slot], 0, sizeof(ARTPresenceMemberRow));
+    [_usedSlots removeIndex:slot];
+    [_freeSlots addIndex:slot];
+}
+
+- (ARTPresenceAction)actionAtSlot:(NSUInteger)slot {
+    return (ARTPresenceAction)[self rowAtSlot:slot]->action;
+}
+
+- (BOOL)isMessage:(ARTPresenceMessage *)message newerThanMemberAtSlot:(NSUInteger)slot {
+    const ARTPresenceMemberRow *const row = [self rowAtSlot:slot];
+    if (!row->hasParsableId) {
+        return [message isNewerThan:[self memberAtSlot:slot]];
+    }
+    return [message isNewerThanMemberSynthesized:row->isSynthesized timestamp:row->timestamp msgSerial:row->msgSerial index:row->index];
+}
+
+- (ARTPresenceMessage *)memberAtSlot:(NSUInteger)slot {
+    const ARTPresenceMemberRow *const row = [self rowAtSlot:slot];
+    ARTPresenceMessage *const member = [[ARTPresenceMessage alloc] init];
+    member.clientId = ARTColumnGet(_clientIds, slot);
+    member.connectionId = ARTColumnGet(_connectionIds, slot);
+    if (row->hasCanonicalId) {
+        [member setCanonicalIdWithMsgSerial:row->msgSerial index:row->index];
+    }
+    else {
+        member.id = ARTColumnGet(_ids, slot);
+    }
+    member.timestamp = isnan(row->timestamp) ? nil : [NSDate dateWithTimeIntervalSince1970:row->timestamp];
+    member.data = ARTColumnGet(_data, slot);
+    member.encoding = ARTColumnGet(_encodings, slot);
+    member.action = (ARTPresenceAction)row->action;
+    return member;
+}
+
+- (NSArray<ARTPresenceMessage *> *)membersAtSlots:(NSIndexSet *)slots {
+    NSMutableArray<ARTPresenceMessage *> *const members = [NSMutableArray arrayWithCapacity:slots.count];
+    [slots enumerateIndexesUsingBlock:^(NSUInteger slot, BOOL *stop) {
+        [members addObject:[self memberAtSlot:slot]];
+    }];
+    return members;
+}
+
+- (NSDictionary<NSString *, ARTPresenceMessage *> *)membersByKey {
+    NSMutableDictionary<NSString *, ARTPresenceMessage *> *const members = [NSMutableDictionary dictionaryWithCapacity:_usedSlots.count];
+    [_usedSlots enumerateIndexesUsingBlock:^(NSUInteger slot, BOOL *stop) {
+        ARTPresenceMessage *const member = [self memberAtSlot:slot];
+        [members setObject:member forKey:member.memberKey];
+    }];
+    return members;
+}
+
+@end
@@ -3,7 +3,21 @@
 NSString *const ARTPresenceMessageException = @"ARTPresenceMessageException";
 NSString *const ARTAblyMessageInvalidPresenceId = @"Received presence message id is invalid %@";
 
-@implementation ARTPresenceMessage
+static NSUInteger ARTDecimalLength(NSInteger value) {
+    NSUInteger length = value < 0 ? 2 : 1;
+    for (NSInteger rest = value / 10; rest != 0; rest /= 10) {
+        length++;
+    }
+    return length;
+}
+
+@implementation ARTPresenceMessage {
+    // The `connectionId:msgSerial:index` parts of `id`, parsed once when the id is set so that comparing for newness (RTP2b) doesn't split strings.
+    BOOL _idIsValid;
+    NSUInteger _idConnectionIdLength;
+    NSInteger _idMsgSerial;
+    NSInteger _idIndex;
+}
 
 - (instancetype)init {
     self = [super init];
@@ -19,6 +33,10 @@ NSString *const ARTAblyMessageInvalidPresenceId = @"Received presence message id
     ARTPresenceMessage *message = [super copyWithZone:zone];
     message->_action = self.action;
     message->_syncSessionId = self.syncSessionId;
+    message->_idIsValid = _idIsValid;
+    message->_idConnectionIdLength = _idConnectionIdLength;
+    message->_idMsgSerial = _idMsgSerial;
+    message->_idIndex = _idIndex;
     return message;
 }
 
@@ -47,30 +65,71 @@ NSString *const ARTAblyMessageInvalidPresenceId = @"Received presence message id
     return haveEqualConnectionId && haveEqualCliendId;
 }
 
-- (NSArray<NSString *> *)parseId {
-    if (self.id == nil) {
-        return nil;
+- (void)setId:(NSString *)id {
+    [super setId:id];
+
+    _idIsValid = NO;
+    _idConnectionIdLength = 0;
+    _idMsgSerial = 0;
+    _idIndex = 0;
+    if (id == nil) {
+        return;
+    }
+    NSArray<NSString *> *idParts = [id componentsSeparatedByString:@":"];
+    if (idParts.count == 3) {
+        _idIsValid = YES;
+        _idConnectionIdLength = idParts[0].length;
+        _idMsgSerial = [idParts[1] integerValue];
+        _idIndex = [idParts[2] integerValue];
     }
-    NSArray<NSString *> *idParts = [self.id componentsSeparatedByCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@":"]];
-    if (idParts.count != 3) {
+}
+
+- (void)validateId {
+    if (self.id != nil && !_idIsValid) {
         [ARTException raise:ARTPresenceMessageException format:ARTAblyMessageInvalidPresenceId, self.id];
     }
-    return idParts;
 }
 
 - (BOOL)isSynthesized {
-    NSString *connectionId = [[self parseId] objectAtIndex:0];
-    return ![connectionId isEqualToString:self.connectionId];
+    [self validateId];
+    NSString *const connectionId = self.connectionId;
+    if (self.id == nil || connectionId == nil) {
+        return YES;
+    }
+    return !(connectionId.length == _idConnectionIdLength && [self.id hasPrefix:connectionId]);
 }
 
 - (NSInteger)msgSerialFromId {
-    NSInteger msgSerial = [[[self parseId] objectAtIndex:1] integerValue];
-    return msgSerial;
+    [self validateId];
+    return _idMsgSerial;
 }
 
 - (NSInteger)indexFromId {
-    NSInteger index = [[[self parseId] objectAtIndex:2] integerValue];
-    return index;
+    [self validateId];
+    return _idIndex;
+}
+
+- (BOOL)hasParsableId {
+    return self.id == nil || _idIsValid;
+}
+
+- (BOOL)hasCanonicalId {
+    NSString *const connectionId = self.connectionId;
+    if (!_idIsValid || connectionId == nil || connectionId.length != _idConnectionIdLength) {
+        return NO;
+    }
+    // Any other text that parses to the same numbers is longer, so comparing lengths is enough.
+    NSString *const id = self.id;
+    return id.length == _idConnectionIdLength + ARTDecimalLength(_idMsgSerial) + ARTDecimalLength(_idIndex) + 2 && [id hasPrefix:connectionId];
+}
+
+- (void)setCanonicalIdWithMsgSerial:(NSInteger)msgSerial index:(NSInteger)index {
+    NSString *const connectionId = self.connectionId;
+    [super setId:[NSString stringWithFormat:@"%@:%ld:%ld", connectionId, (long)msgSerial, (long)index]];
+    _idIsValid = YES;
+    _idConnectionIdLength = connectionId.length;
+    _idMsgSerial = msgSerial;
+    _idIndex = index;
 }
 
 - (BOOL)isNewerThan:(ARTPresenceMessage *)latest {
@@ -78,14 +137,20 @@ NSString *const ARTAblyMessageInvalidPresenceId = @"Received presence message id
         return YES;
     }
 
-    if ([self isSynthesized] || [latest isSynthesized]) {
-        return !self.timestamp || [latest.timestamp timeIntervalSince1970] <= [self.timestamp timeIntervalSince1970];
+    const BOOL latestIsSynthesized = [latest isSynthesized];
+    return [self isNewerThanMemberSynthesized:latestIsSynthesized
+                                    timestamp:latest.timestamp ? latest.timestamp.timeIntervalSince1970 : NAN
+                                    msgSerial:latestIsSynthesized ? 0 : [latest msgSerialFromId]
+                                        index:latestIsSynthesized ? 0 : [latest indexFromId]];
+}
+
+- (BOOL)isNewerThanMemberSynthesized:(BOOL)latestIsSynthesized timestamp:(NSTimeInterval)latestTimestamp msgSerial:(NSInteger)latestMsgSerial index:(NSInteger)latestIndex {
+    if ([self isSynthesized] || latestIsSynthesized) {
+        return !self.timestamp || (isnan(latestTimestamp) ? 0 : latestTimestamp) <= [self.timestamp timeIntervalSince1970];
     }
 
     NSInteger currentMsgSerial = [self msgSerialFromId];
     NSInteger currentIndex = [self indexFromId];
-    NSInteger latestMsgSerial = [latest msgSerialFromId];
-    NSInteger latestIndex = [latest indexFromId];
 
     if (currentMsgSerial == latestMsgSerial) {
         return currentIndex > latestIndex;
@@ -95,6 +160,58 @@ NSString *const ARTAblyMessageInvalidPresenceId = @"Received presence message id
     }
 }
 
+#pragma mark - Net presence
+
+static BOOL ARTPresenceActionIsPresent(ARTPresenceAction action) {
+    return action == ARTPresenceEnter || action == ARTPresencePresent || action == ARTPresenceUpdate;
+}
+
++ (NSArray<ARTPresenceMessage *> *)netPresenceOfMessages:(NSArray<ARTPresenceMessage *> *)messages {
+    NSMutableArray<NSString *> *const memberKeys = [NSMutableArray array];
+    NSMutableDictionary<NSString *, ARTPresenceMessage *> *const firstMessages = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, ARTPresenceMessage *> *const lastMessages = [NSMutableDictionary dictionary];
+    for (ARTPresenceMessage *message in messages) {
+        NSString *const memberKey = message.memberKey;
+        if (![firstMessages objectForKey:memberKey]) {
+            [memberKeys addObject:memberKey];
+            [firstMessages setObject:message forKey:memberKey];
+        }
+        [lastMessages setObject:message forKey:memberKey];
+    }
+
+    NSMutableArray<ARTPresenceMessage *> *const netMessages = [NSMutableArray arrayWithCapacity:memberKeys.count];
+    for (NSString *memberKey in memberKeys) {
+        ARTPresenceMessage *const first = [firstMessages objectForKey:memberKey];
+        ARTPresenceMessage *const last = [lastMessages objectForKey:memberKey];
+        if (first == last) {
+            [netMessages addObject:last];
+            continue;
+        }
+        // Only an ENTER implies the member wasn't present before.
+        const BOOL wasPresent = first.action != ARTPresenceEnter;
+        const BOOL isPresent = ARTPresenceActionIsPresent(last.action);
+        ARTPresenceAction action = last.action;
+        if (!wasPresent && !isPresent) {
+            continue;
+        }
+        if (!wasPresent) {
+            action = ARTPresenceEnter;
+        }
+        else if (isPresent && action == ARTPresenceEnter) {
+            action = ARTPresenceUpdate;
+        }
+        if (action == last.action) {
+            [netMessages addObject:last];
+        }
+        else {
+            ARTPresenceMessage *const message = [last copy];
+            message.action = action;
+            [netMessages addObject:message];
+        }
+    }
+    return netMessages;
+}
+
 #pragma mark - NSObject
 
 - (BOOL)isEqual:(id)object {
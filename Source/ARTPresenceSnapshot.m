@@ -0,0 +1,68 @@
+#import "ARTPresenceSnapshot+Private.h"
+#import "ARTPresenceMessage.h"
+#import "ARTPresenceMemberStore.h"
+
+@implementation ARTPresenceSnapshot {
+    ARTPresenceMemberStore *_store;
+    NSArray<ARTPresenceMessage *> *_members;
+}
+
+- (instancetype)initWithStore:(ARTPresenceMemberStore *)store version:(NSUInteger)version {
+    self = [super init];
+    if (self) {
+        _store = store;
+        _version = version;
+    }
+    return self;
+}
+
+- (NSArray<ARTPresenceMessage *> *)members {
+    @synchronized (self) {
+        if (_members == nil) {
+            // Members that left during a sync are kept as ABSENT until it ends (RTP2h2a).
+            NSIndexSet *const slots = [_store.slots indexesPassingTest:^BOOL(NSUInteger slot, BOOL *stop) {
+                return [self->_store actionAtSlot:slot] != ARTPresenceAbsent;
+            }];
+            _members = [_store membersAtSlots:slots];
+        }
+        return _members;
+    }
+}
+
+- (ARTPresenceMessage *)memberWithClientId:(NSString *)clientId connectionId:(NSString *)connectionId {
+    const NSUInteger slot = [_store slotOfMemberWithClientId:clientId connectionId:connectionId];
+    if (slot == NSNotFound || [_store actionAtSlot:slot] == ARTPresenceAbsent) {
+        return nil;
+    }
+    return [_store memberAtSlot:slot];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> version: %lu, members: %lu", self.class, self, (unsigned long)_version, (unsigned long)_store.count];
+}
+
+@end
+
+@implementation ARTPresenceChanges
+
+- (instancetype)initFromVersion:(NSUInteger)fromVersion
+                      toVersion:(NSUInteger)toVersion
+                        entered:(NSArray<ARTPresenceMessage *> *)entered
+                        updated:(NSArray<ARTPresenceMessage *> *)updated
+                           left:(NSArray<ARTPresenceMessage *> *)left {
+    self = [super init];
+    if (self) {
+        _fromVersion = fromVersion;
+        _toVersion = toVersion;
+        _entered = entered;
+        _updated = updated;
+        _left = left;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> versions: %lu-%lu, entered: %lu, updated: %lu, left: %lu", self.class, self, (unsigned long)_fromVersion, (unsigned long)_toVersion, (unsigned long)_entered.count, (unsigned long)_updated.count, (unsigned long)_left.count];
+}
+
+@end
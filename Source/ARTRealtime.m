@@ -6,6 +6,8 @@
 #import "ARTRealtime+Private.h"
 
 #import "ARTRealtimeChannel+Private.h"
+#import "ARTOutboundScheduler.h"
+#import "ARTAttachScheduler.h"
 #import "ARTStatus.h"
 #import "ARTDefault.h"
 #import "ARTRest+Private.h"
@@ -181,6 +183,8 @@ NS_ASSUME_NONNULL_END
 
 const NSTimeInterval _immediateReconnectionDelay = 0.1;
 const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
+// The most higher-priority messages sent while a lower-priority one is waiting, see `scheduleOutbound:`.
+static const NSUInteger ARTOutboundFairnessInterval = 8;
 
 @implementation ARTRealtimeInternal {
     BOOL _resuming;
@@ -201,6 +205,10 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
     ARTScheduledBlockHandle *_idleTimer;
     dispatch_queue_t _userQueue;
     dispatch_queue_t _queue;
+    // Channel messages received but not processed yet, see `enqueueChannelMessage:`.
+    NSMutableArray<ARTProtocolMessage *> *_channelMessageLane;
+    ARTOutboundScheduler *_outboundScheduler;
+    BOOL _schedulesOutbound; // see `scheduleOutbound:`
 }
 
 - (instancetype)initWithOptions:(ARTClientOptions *)options {
@@ -221,6 +229,9 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
         _msgSerial = 0;
         _queuedMessages = [NSMutableArray array];
         _pendingMessages = [NSMutableArray array];
+        _channelMessageLane = [NSMutableArray array];
+        _attachScheduler = [[ARTAttachScheduler alloc] initWithMaxConcurrentAttaches:options.maxConcurrentAttaches logger:_logger];
+        _outboundScheduler = [[ARTOutboundScheduler alloc] initWithFairnessInterval:ARTOutboundFairnessInterval];
         _pendingMessageStartSerial = 0;
         _pendingAuthorizations = [NSMutableArray array];
         _connection = [[ARTConnectionInternal alloc] initWithRealtime:self logger:self.logger];
@@ -501,6 +512,9 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
 - (void)transition:(ARTRealtimeConnectionState)state withMetadata:(ARTConnectionStateChangeMetadata *)metadata {
     ARTLogVerbose(self.logger, @"R:%p realtime state transitions to %tu - %@%@", self, state, ARTRealtimeConnectionStateToStr(state), metadata.retryAttempt ? [NSString stringWithFormat: @" (result of %@)", metadata.retryAttempt.id] : @"");
     
+    // Channel messages received before the state change are processed before it.
+    [self processChannelMessageLane];
+
     ARTConnectionStateChange *stateChange = [[ARTConnectionStateChange alloc] initWithCurrent:state previous:self.connection.state_nosync event:(ARTRealtimeConnectionEvent)state reason:metadata.errorInfo retryIn:0 retryAttempt:metadata.retryAttempt];
 
     [self.connection setState:state];
@@ -738,17 +752,20 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
     }
     
     if ([self shouldSendEvents]) {
-        [self sendQueuedMessages];
-        
-        // Channels
-        for (ARTRealtimeChannelInternal *channel in channels) {
-            if (stateChange.previous == ARTRealtimeInitialized ||
-                stateChange.previous == ARTRealtimeConnecting ||
-                stateChange.previous == ARTRealtimeDisconnected) {
-                // RTL4i
-                [channel _attach:nil];
+        // So that the channels' ATTACH messages aren't sent after the backlog of publishes.
+        [self scheduleOutbound:^{
+            [self sendQueuedMessages];
+
+            // Channels
+            for (ARTRealtimeChannelInternal *channel in channels) {
+                if (stateChange.previous == ARTRealtimeInitialized ||
+                    stateChange.previous == ARTRealtimeConnecting ||
+                    stateChange.previous == ARTRealtimeDisconnected) {
+                    // RTL4i
+                    [channel _attach:nil];
+                }
             }
-        }
+        }];
     } else if (![self shouldQueueEvents]) {
         if (!channelStateChangeMetadata) {
             if (stateChange.reason) {
@@ -1280,9 +1297,28 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
     }
 }
 
+- (BOOL)hasPendingMessagesForChannel:(NSString *)channelName {
+    for (ARTQueuedMessage *message in self.queuedMessages) {
+        if ([message.msg.channel isEqualToString:channelName]) {
+            return YES;
+        }
+    }
+    for (ARTPendingMessage *message in self.pendingMessages) {
+        if ([message.msg.channel isEqualToString:channelName]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
 - (void)send:(ARTProtocolMessage *)msg sentCallback:(ARTCallback)sentCallback ackCallback:(ARTStatusCallback)ackCallback {
     if ([self shouldSendEvents]) {
-        [self sendImpl:msg sentCallback:sentCallback ackCallback:ackCallback];
+        if (_schedulesOutbound) {
+            [_outboundScheduler enqueue:[[ARTQueuedMessage alloc] initWithProtocolMessage:msg sentCallback:sentCallback ackCallback:ackCallback]];
+        }
+        else {
+            [self sendImpl:msg sentCallback:sentCallback ackCallback:ackCallback];
+        }
     }
     else if ([self shouldQueueEvents]) {
         ARTQueuedMessage *lastQueuedMessage = self.queuedMessages.lastObject; //RTL6d5
@@ -1329,8 +1365,38 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
     self.queuedMessages = [NSMutableArray array];
     
     for (ARTQueuedMessage *message in qms) {
-        [self sendImpl:message.msg sentCallback:message.sentCallback ackCallback:message.ackCallback];
+        if (_schedulesOutbound) {
+            [_outboundScheduler enqueue:message];
+        }
+        else {
+            [self sendImpl:message.msg sentCallback:message.sentCallback ackCallback:message.ackCallback];
+        }
+    }
+}
+
+/**
+ Sends the messages that are sent while `block` runs, and while they are being sent, by priority rather than in order: control messages first, then presence, then publishes. See `ARTOutboundScheduler`.
+ */
+- (void)scheduleOutbound:(void (^)(void))block {
+    if (_schedulesOutbound) {
+        block();
+        return;
+    }
+    _schedulesOutbound = YES;
+    block();
+    ARTQueuedMessage *message;
+    while ((message = [_outboundScheduler dequeue])) {
+        if ([self shouldSendEvents]) {
+            [self sendImpl:message.msg sentCallback:message.sentCallback ackCallback:message.ackCallback];
+        }
+        else {
+            // The connection was lost meanwhile: queue or fail the rest as `send:` would.
+            _schedulesOutbound = NO;
+            [self send:message.msg sentCallback:message.sentCallback ackCallback:message.ackCallback];
+            _schedulesOutbound = YES;
+        }
     }
+    _schedulesOutbound = NO;
 }
 
 - (void)failQueuedMessages:(ARTStatus *)status {
@@ -1532,14 +1598,21 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
         [self.connection setSerial:message.connectionSerial];
     }
     
+    // Heartbeats, ACKs and NACKs are handled straight away, ahead of the channel messages received before them. Connection state changes are handled in order, once those channel messages have been processed.
     switch (message.action) {
         case ARTProtocolMessageHeartbeat:
             [self onHeartbeat];
             break;
         case ARTProtocolMessageError:
+            if (message.channel) {
+                [self enqueueChannelMessage:message];
+                break;
+            }
+            [self processChannelMessageLane];
             [self onError:message];
             break;
         case ARTProtocolMessageConnected:
+            [self processChannelMessageLane];
             // Set Auth#clientId
             if (message.connectionDetails) {
                 [self.auth setProtocolClientId:message.connectionDetails.clientId];
@@ -1549,6 +1622,7 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
             break;
         case ARTProtocolMessageDisconnect:
         case ARTProtocolMessageDisconnected:
+            [self processChannelMessageLane];
             [self onDisconnected:message];
             break;
         case ARTProtocolMessageAck:
@@ -1558,17 +1632,57 @@ const NSTimeInterval _reachabilityReconnectionAttemptThreshold = 0.1;
             [self onNack:message];
             break;
         case ARTProtocolMessageClosed:
+            [self processChannelMessageLane];
             [self onClosed];
             break;
         case ARTProtocolMessageAuth:
             [self onAuth];
             break;
         default:
-            [self onChannelMessage:message];
+            [self enqueueChannelMessage:message];
             break;
     }
 }
 
+/**
+ Channel messages are processed one per turn of the internal queue instead of as they are received, so that the control messages received after them, which are already waiting on the queue, don't wait for them too.
+ */
+- (void)enqueueChannelMessage:(ARTProtocolMessage *)message {
+    [_channelMessageLane addObject:message];
+    if (_channelMessageLane.count == 1) {
+        dispatch_async(_queue, ^{
+            [self processNextChannelMessage];
+        });
+    }
+}
+
+- (void)processNextChannelMessage {
+    if (_channelMessageLane.count == 0) {
+        return;
+    }
+    ARTProtocolMessage *const message = _channelMessageLane.firstObject;
+    [_channelMessageLane removeObjectAtIndex:0];
+    [self onChannelMessage:message];
+    if (_channelMessageLane.count > 0) {
+        dispatch_async(_queue, ^{
+            [self processNextChannelMessage];
+        });
+    }
+}
+
+/// Processes the channel messages received so far.
+- (void)processChannelMessageLane {
+    while (_channelMessageLane.count > 0) {
+        ARTProtocolMessage *const message = _channelMessageLane.firstObject;
+        [_channelMessageLane removeObjectAtIndex:0];
+        [self onChannelMessage:message];
+    }
+    // The channels that are processing a message a slice at a time finish it, and the ones received since.
+    for (ARTRealtimeChannelInternal *channel in self.channels.nosyncIterable) {
+        [channel processInboundBacklog];
+    }
+}
+
 - (void)realtimeTransportAvailable:(id<ARTRealtimeTransport>)transport {
     // Do nothing
 }
@@ -14,6 +14,7 @@
 #import "ARTProtocolMessage.h"
 #import "ARTProtocolMessage+Private.h"
 #import "ARTPresenceMap.h"
+#import "ARTPresenceMessage+Private.h"
 #import "ARTNSArray+ARTFunctional.h"
 #import "ARTStatus.h"
 #import "ARTDefault.h"
@@ -27,15 +28,18 @@
 #import "ARTConnection+Private.h"
 #import "ARTRestChannels+Private.h"
 #import "ARTEventEmitter+Private.h"
+#import "ARTRealtimeChannels+Private.h"
 #import "ARTChannelStateChangeMetadata.h"
 #import "ARTAttachRequestMetadata.h"
 #import "ARTRetrySequence.h"
 #import "ARTBackoffRetryDelayCalculator.h"
 #import "ARTInternalLog.h"
 #import "ARTAttachRetryState.h"
+#import "ARTAttachScheduler.h"
 #if TARGET_OS_IPHONE
 #import "ARTPushChannel+Private.h"
 #endif
+#import <stdatomic.h>
 
 @implementation ARTRealtimeChannel {
     ARTQueuedDealloc *_dealloc;
@@ -58,10 +62,15 @@
     if (self) {
         _internal = internal;
         _dealloc = dealloc;
+        [_internal publicHandleDidInit];
     }
     return self;
 }
 
+- (void)dealloc {
+    [_internal publicHandleDidDealloc];
+}
+
 - (NSString *)name {
     return _internal.name;
 }
@@ -232,6 +241,12 @@
     NSString * _Nullable _lastPayloadMessageId;
     NSString * _Nullable _lastPayloadProtocolMessageChannelSerial;
     BOOL _decodeFailureRecoveryInProgress;
+    NSMutableArray<ARTPresenceMessage *> * _Nullable _presenceBatch; // non-nil while the presence messages broadcast are being batched
+    NSUInteger _channelMessageSliceSize;
+    // Channel messages waiting for a frame that is being processed a slice at a time, starting with the rest of that frame.
+    NSMutableArray<ARTProtocolMessage *> *_inboundBacklog;
+    NSUInteger _inboundResumeIndex; // where processing resumes in the first message of `_inboundBacklog`
+    ARTAttachRetryState *_attachRetryState;
 }
 
 @end
@@ -246,10 +261,17 @@ NS_ASSUME_NONNULL_BEGIN
 
 NS_ASSUME_NONNULL_END
 
+// Rough memory use, for `estimatedSize_nosync`: of a channel with its emitters, encoder and REST counterpart; of a presence member; of an inbound message.
+static const NSUInteger ARTChannelSizeEstimate = 2048;
+static const NSUInteger ARTPresenceMemberSizeEstimate = 512;
+static const NSUInteger ARTProtocolMessageSizeEstimate = 1024;
+
 @implementation ARTRealtimeChannelInternal {
     dispatch_queue_t _queue;
     dispatch_queue_t _userQueue;
     ARTErrorInfo *_errorReason;
+    // The `ARTRealtimeChannel` objects the app holds onto, which are created and deallocated on any thread.
+    atomic_uint _publicHandleCount;
 }
 
 - (instancetype)initWithRealtime:(ARTRealtimeInternal *)realtime andName:(NSString *)name withOptions:(ARTRealtimeChannelOptions *)options logger:(ARTInternalLog *)logger {
@@ -261,21 +283,29 @@ NS_ASSUME_NONNULL_END
         _restChannel = [_realtime.rest.channels _getChannel:self.name options:options addPrefix:true];
         _state = ARTRealtimeChannelInitialized;
         _attachSerial = nil;
-        _presenceMap = [[ARTPresenceMap alloc] initWithQueue:_queue logger:self.logger];
-        _presenceMap.delegate = self;
         _statesEventEmitter = [[ARTPublicEventEmitter alloc] initWithRest:_realtime.rest logger:logger];
         _messagesEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueues:_queue userQueue:_userQueue];
         _presenceEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueue:_queue];
+        _presenceBatchEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueue:_queue];
+        _channelMessageSliceSize = MAX(realtime.options.testOptions.channelMessageSliceSize, 1);
         _attachedEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueue:_queue];
         _detachedEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueue:_queue];
         _internalEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueue:_queue];
-        const id<ARTRetryDelayCalculator> attachRetryDelayCalculator = [[ARTBackoffRetryDelayCalculator alloc] initWithInitialRetryTimeout:realtime.options.channelRetryTimeout
-                                                                                                                jitterCoefficientGenerator:realtime.options.testOptions.jitterCoefficientGenerator];
+    }
+    return self;
+}
+
+// The presence map, the attach retry state and the inbound backlog, as well as the presence and push objects, are created on first use, so that a channel that is only published to stays small.
+
+- (ARTAttachRetryState *)attachRetryState {
+    if (!_attachRetryState) {
+        const id<ARTRetryDelayCalculator> attachRetryDelayCalculator = [[ARTBackoffRetryDelayCalculator alloc] initWithInitialRetryTimeout:self.realtime.options.channelRetryTimeout
+                                                                                                                jitterCoefficientGenerator:self.realtime.options.testOptions.jitterCoefficientGenerator];
         _attachRetryState = [[ARTAttachRetryState alloc] initWithRetryDelayCalculator:attachRetryDelayCalculator
-                                                                               logger:logger
+                                                                               logger:self.logger
                                                                      logMessagePrefix:[NSString stringWithFormat:@"RT: %p C:%p ", _realtime, self]];
     }
-    return self;
+    return _attachRetryState;
 }
 
 - (ARTRealtimeChannelState)state {
@@ -313,6 +343,39 @@ dispatch_sync(_queue, ^{
     return _errorReason;
 }
 
+- (void)publicHandleDidInit {
+    atomic_fetch_add(&_publicHandleCount, 1);
+}
+
+- (void)publicHandleDidDealloc {
+    atomic_fetch_sub(&_publicHandleCount, 1);
+}
+
+- (void)wasUsed_nosync {
+    [self.realtime.channels channelWasUsed_nosync:self];
+}
+
+- (BOOL)isEvictable_nosync {
+    if (atomic_load(&_publicHandleCount) > 0) {
+        return NO;
+    }
+    if (self.statesEventEmitter.hasListeners || self.messagesEventEmitter.hasListeners || self.presenceEventEmitter.hasListeners || self.presenceBatchEventEmitter.hasListeners) {
+        return NO;
+    }
+    // Callbacks of attach and detach operations in progress.
+    if (_attachedEventEmitter.hasListeners || _detachedEventEmitter.hasListeners) {
+        return NO;
+    }
+    if (_presenceMap.localMembers.count > 0) {
+        return NO;
+    }
+    return ![self.realtime hasPendingMessagesForChannel:self.name];
+}
+
+- (NSUInteger)estimatedSize_nosync {
+    return ARTChannelSizeEstimate + _presenceMap.memberCount * ARTPresenceMemberSizeEstimate + _inboundBacklog.count * ARTProtocolMessageSizeEstimate;
+}
+
 - (ARTRealtimePresenceInternal *)presence {
     if (!_realtimePresence) {
         _realtimePresence = [[ARTRealtimePresenceInternal alloc] initWithChannel:self logger:self.logger];
@@ -369,6 +432,8 @@ dispatch_sync(_queue, ^{
         return;
     }
 
+    [self wasUsed_nosync];
+
     ARTProtocolMessage *msg = [[ARTProtocolMessage alloc] init];
     msg.action = ARTProtocolMessageMessage;
     msg.channel = self.name;
@@ -454,6 +519,10 @@ dispatch_sync(_queue, ^{
 }
 
 - (ARTPresenceMap *)presenceMap {
+    if (!_presenceMap) {
+        _presenceMap = [[ARTPresenceMap alloc] initWithQueue:_queue logger:self.logger];
+        _presenceMap.delegate = self;
+    }
     return _presenceMap;
 }
 
@@ -471,9 +540,6 @@ dispatch_sync(_queue, ^{
     if (cb) {
         ARTMessageCallback userCallback = cb;
         cb = ^(ARTMessage *_Nonnull m) {
-            if (self.state_nosync != ARTRealtimeChannelAttached) { //RTL17
-                return;
-            }
             dispatch_async(self->_userQueue, ^{
                 userCallback(m);
             });
@@ -490,17 +556,28 @@ dispatch_sync(_queue, ^{
 
     __block ARTEventListener *listener = nil;
 dispatch_sync(_queue, ^{
+    listener = [self _subscribeWithAttachCallback:onAttach callback:cb];
+});
+    return listener;
+}
+
+- (ARTEventListener *)_subscribeWithAttachCallback:(ARTCallback)onAttach callback:(ARTMessageCallback)cb {
+    [self wasUsed_nosync];
     if (self.state_nosync == ARTRealtimeChannelFailed) {
         if (onAttach) onAttach([ARTErrorInfo createWithCode:0 message:@"attempted to subscribe while channel is in FAILED state."]);
         ARTLogWarn(self.logger, @"R:%p C:%p (%@) subscribe has been ignored (attempted to subscribe while channel is in FAILED state)", self->_realtime, self, self.name);
-        return;
+        return nil;
     }
     if (self.state_nosync == ARTRealtimeChannelInitialized) { //RTL7c
         [self _attach:onAttach];
     }
-    listener = [self.messagesEventEmitter on:cb];
+    ARTEventListener *const listener = [self.messagesEventEmitter on:^(ARTMessage *_Nonnull m) {
+        if (self.state_nosync != ARTRealtimeChannelAttached) { //RTL17
+            return;
+        }
+        if (cb) cb(m);
+    }];
     ARTLogVerbose(self.logger, @"R:%p C:%p (%@) subscribe to all events", self->_realtime, self, self.name);
-});
     return listener;
 }
 
@@ -528,6 +605,7 @@ dispatch_sync(_queue, ^{
 
     __block ARTEventListener *listener = nil;
 dispatch_sync(_queue, ^{
+    [self wasUsed_nosync];
     if (self.state_nosync == ARTRealtimeChannelFailed) {
         if (onAttach) onAttach([ARTErrorInfo createWithCode:0 message:@"attempted to subscribe while channel is in FAILED state."]);
         ARTLogWarn(self.logger, @"R:%p C:%p (%@) subscribe of '%@' has been ignored (attempted to subscribe while channel is in FAILED state)", self->_realtime, self, self.name, name);
@@ -612,7 +690,16 @@ dispatch_sync(_queue, ^{
         _errorReason = metadata.errorInfo;
     }
 
-    [self.attachRetryState channelWillTransitionToState:state];
+    [_attachRetryState channelWillTransitionToState:state]; // a retry state yet to be created is as good as reset
+
+    if (stateChange.previous == ARTRealtimeChannelAttaching && state != ARTRealtimeChannelAttaching) {
+        [self.realtime.attachScheduler attachOfChannelDidEnd:self.name attached:state == ARTRealtimeChannelAttached];
+    }
+
+    if (stateChange.previous == ARTRealtimeChannelAttached && state != ARTRealtimeChannelAttached) {
+        // What is left of the channel messages received while attached mustn't be delivered in the new state.
+        [self discardInboundBacklog];
+    }
 
     ARTEventListener *channelRetryListener = nil;
     switch (state) {
@@ -638,13 +725,13 @@ dispatch_sync(_queue, ^{
             self.attachResume = false;
             break;
         case ARTRealtimeChannelDetached:
-            [self.presenceMap failsSync:metadata.errorInfo];
+            [_presenceMap failsSync:metadata.errorInfo];
             break;
         case ARTRealtimeChannelFailed:
             self.attachResume = false;
             [_attachedEventEmitter emit:nil with:metadata.errorInfo];
             [_detachedEventEmitter emit:nil with:metadata.errorInfo];
-            [self.presenceMap failsSync:metadata.errorInfo];
+            [_presenceMap failsSync:metadata.errorInfo];
             break;
         default:
             break;
@@ -681,6 +768,18 @@ dispatch_sync(_queue, ^{
 
 - (void)onChannelMessage:(ARTProtocolMessage *)message {
     ARTLogDebug(self.logger, @"R:%p C:%p (%@) received channel message %tu - %@", _realtime, self, self.name, message.action, ARTProtocolMessageActionToStr(message.action));
+    if (_inboundBacklog.count > 0) {
+        // Keep the order in which channel messages were received.
+        [_inboundBacklog addObject:message];
+        return;
+    }
+    [self processChannelMessage:message fromIndex:0];
+}
+
+/**
+ Processes the entries of `message` from the one at `index`. Returns `NO` if a MESSAGE, PRESENCE or SYNC frame had more entries left than fit in a slice, in which case the rest has been re-enqueued.
+ */
+- (BOOL)processChannelMessage:(ARTProtocolMessage *)message fromIndex:(NSUInteger)index {
     switch (message.action) {
         case ARTProtocolMessageAttached:
             ARTLogDebug(self.logger, @"R:%p C:%p (%@) %@", _realtime, self, self.name, message.description);
@@ -695,21 +794,77 @@ dispatch_sync(_queue, ^{
                 ARTLogDebug(self.logger, @"R:%p C:%p (%@) message decode recovery in progress, message skipped: %@", _realtime, self, self.name, message.description);
                 break;
             }
-            [self onMessage:message];
-            break;
+            return [self onMessage:message fromIndex:index];
         case ARTProtocolMessagePresence:
-            [self onPresence:message];
-            break;
+            return [self onPresence:message fromIndex:index];
         case ARTProtocolMessageError:
             [self onError:message];
             break;
         case ARTProtocolMessageSync:
-            [self onSync:message];
-            break;
+            return [self onSync:message fromIndex:index];
         default:
             ARTLogWarn(self.logger, @"R:%p C:%p (%@) unknown ARTProtocolMessage action: %tu", _realtime, self, self.name, message.action);
             break;
     }
+    return YES;
+}
+
+/**
+ Returns the end of the slice of `count` entries starting at `index`.
+
+ A frame with thousands of entries would otherwise hold the internal queue for as long as it takes to process all of them, delaying heartbeats, ACKs and API calls.
+ */
+- (NSUInteger)endOfSliceFromIndex:(NSUInteger)index count:(NSUInteger)count {
+    return MIN(count, index + _channelMessageSliceSize);
+}
+
+/**
+ Re-enqueues the processing of `message` from its entry at `index`. The channel messages received until then are processed after it, in order.
+ */
+- (void)suspendChannelMessage:(ARTProtocolMessage *)message atIndex:(NSUInteger)index {
+    ARTLogDebug(self.logger, @"R:%p C:%p (%@) processing of %@ suspended at entry %tu", _realtime, self, self.name, ARTProtocolMessageActionToStr(message.action), index);
+    if (!_inboundBacklog) {
+        _inboundBacklog = [NSMutableArray array];
+    }
+    [_inboundBacklog insertObject:message atIndex:0];
+    _inboundResumeIndex = index;
+    dispatch_async(_queue, ^{
+        [self resumeInboundBacklog];
+    });
+}
+
+- (void)processInboundBacklog {
+    while (_inboundBacklog.count > 0) {
+        ARTProtocolMessage *const message = _inboundBacklog.firstObject;
+        const NSUInteger index = _inboundResumeIndex;
+        [_inboundBacklog removeObjectAtIndex:0];
+        _inboundResumeIndex = 0;
+        [self processChannelMessage:message fromIndex:index];
+    }
+}
+
+- (void)discardInboundBacklog {
+    if (_inboundBacklog.count > 0) {
+        ARTLogDebug(self.logger, @"R:%p C:%p (%@) discarding %tu unprocessed channel messages", _realtime, self, self.name, _inboundBacklog.count);
+    }
+    [_inboundBacklog removeAllObjects];
+    _inboundResumeIndex = 0;
+}
+
+- (void)resumeInboundBacklog {
+    if (_inboundBacklog.count == 0) {
+        return;
+    }
+    // One message or slice per turn of the queue, so that the backlog doesn't hold it either.
+    ARTProtocolMessage *const message = _inboundBacklog.firstObject;
+    const NSUInteger index = _inboundResumeIndex;
+    [_inboundBacklog removeObjectAtIndex:0];
+    _inboundResumeIndex = 0;
+    if ([self processChannelMessage:message fromIndex:index] && _inboundBacklog.count > 0) {
+        dispatch_async(_queue, ^{
+            [self resumeInboundBacklog];
+        });
+    }
 }
 
 - (void)setAttached:(ARTProtocolMessage *)message {
@@ -731,11 +886,13 @@ dispatch_sync(_queue, ^{
     if (message.hasPresence) {
         [self.presenceMap startSync];
     }
-    else if ([self.presenceMap.members count] > 0 || [self.presenceMap.localMembers count] > 0) {
+    else if (_presenceMap.memberCount > 0 || [_presenceMap.localMembers count] > 0) {
         if (!message.resumed) {
             // When an ATTACHED message is received without a HAS_PRESENCE flag and PresenceMap has existing members
-            [self.presenceMap startSync];
-            [self.presenceMap endSync];
+            [self batchPresence:^{
+                [self.presenceMap startSync];
+                [self.presenceMap endSync];
+            }];
             ARTLogDebug(self.logger, @"R:%p C:%p (%@) PresenceMap has been reset", _realtime, self, self.name);
         }
     }
@@ -818,10 +975,12 @@ dispatch_sync(_queue, ^{
 }
 
 - (void)onMessage:(ARTProtocolMessage *)pm {
-    int i = 0;
+    [self onMessage:pm fromIndex:0];
+}
 
+- (BOOL)onMessage:(ARTProtocolMessage *)pm fromIndex:(NSUInteger)index {
     ARTMessage *firstMessage = pm.messages.firstObject;
-    if (firstMessage.extras) {
+    if (index == 0 && firstMessage.extras) {
         NSError *extrasDecodeError;
         NSDictionary *const extras = [firstMessage.extras toJSON:&extrasDecodeError];
         if (extrasDecodeError) {
@@ -832,18 +991,19 @@ dispatch_sync(_queue, ^{
             if (deltaFrom && _lastPayloadMessageId && ![deltaFrom isEqualToString:_lastPayloadMessageId]) {
                 ARTErrorInfo *incompatibleIdError = [ARTErrorInfo createWithCode:ARTErrorUnableToDecodeMessage message:[NSString stringWithFormat:@"previous id '%@' is incompatible with message delta %@", _lastPayloadMessageId, firstMessage]];
                 ARTLogError(self.logger, @"R:%p C:%p (%@) %@", _realtime, self, self.name, incompatibleIdError.message);
-                for (int j = i + 1; j < pm.messages.count; j++) {
+                for (int j = 1; j < pm.messages.count; j++) {
                     ARTLogVerbose(self.logger, @"R:%p C:%p (%@) message skipped %@", _realtime, self, self.name, pm.messages[j]);
                 }
                 [self startDecodeFailureRecoveryWithChannelSerial:_lastPayloadProtocolMessageChannelSerial error:incompatibleIdError];
-                return;
+                return YES;
             }
         }
     }
 
     ARTDataEncoder *dataEncoder = self.dataEncoder;
-    for (ARTMessage *m in pm.messages) {
-        ARTMessage *msg = m;
+    const NSUInteger end = [self endOfSliceFromIndex:index count:pm.messages.count];
+    for (NSUInteger i = index; i < end; i++) {
+        ARTMessage *msg = pm.messages[i];
 
         if (msg.data && dataEncoder) {
             NSError *decodeError = nil;
@@ -857,7 +1017,7 @@ dispatch_sync(_queue, ^{
 
                 if (decodeError.code == ARTErrorUnableToDecodeMessage) {
                     [self startDecodeFailureRecoveryWithChannelSerial:_lastPayloadProtocolMessageChannelSerial error:errorInfo];
-                    return;
+                    return YES;
                 }
             }
         }
@@ -866,24 +1026,44 @@ dispatch_sync(_queue, ^{
             msg.timestamp = pm.timestamp;
         }
         if (!msg.id) {
-            msg.id = [NSString stringWithFormat:@"%@:%d", pm.id, i];
+            msg.id = [NSString stringWithFormat:@"%@:%tu", pm.id, i];
         }
 
         _lastPayloadMessageId = msg.id;
 
         [self.messagesEventEmitter emit:msg.name with:msg];
+    }
 
-        ++i;
+    if (end < pm.messages.count) {
+        [self suspendChannelMessage:pm atIndex:end];
+        return NO;
     }
 
     _lastPayloadProtocolMessageChannelSerial = pm.channelSerial;
+    return YES;
 }
 
 - (void)onPresence:(ARTProtocolMessage *)message {
+    [self onPresence:message fromIndex:0];
+}
+
+- (BOOL)onPresence:(ARTProtocolMessage *)message fromIndex:(NSUInteger)index {
     ARTLogDebug(self.logger, @"RT:%p C:%p (%@) handle PRESENCE message", _realtime, self, self.name);
-    int i = 0;
+    const NSUInteger end = [self endOfSliceFromIndex:index count:message.presence.count];
+    [self batchPresence:^{
+        [self addPresenceOfMessage:message fromIndex:index toIndex:end];
+    }];
+    if (end < message.presence.count) {
+        [self suspendChannelMessage:message atIndex:end];
+        return NO;
+    }
+    return YES;
+}
+
+- (void)addPresenceOfMessage:(ARTProtocolMessage *)message fromIndex:(NSUInteger)index toIndex:(NSUInteger)end {
     ARTDataEncoder *dataEncoder = self.dataEncoder;
-    for (ARTPresenceMessage *p in message.presence) {
+    for (NSUInteger i = index; i < end; i++) {
+        ARTPresenceMessage *const p = message.presence[i];
         ARTPresenceMessage *presence = p;
         if (presence.data && dataEncoder) {
             NSError *decodeError = nil;
@@ -899,36 +1079,52 @@ dispatch_sync(_queue, ^{
         }
 
         if (!presence.id) {
-            presence.id = [NSString stringWithFormat:@"%@:%d", message.id, i];
+            presence.id = [NSString stringWithFormat:@"%@:%tu", message.id, i];
         }
 
         if ([self.presenceMap add:presence]) {
             [self broadcastPresence:presence];
         }
-
-        ++i;
     }
 }
 
 - (void)onSync:(ARTProtocolMessage *)message {
-    self.presenceMap.syncMsgSerial = [message.msgSerial longLongValue];
-    self.presenceMap.syncChannelSerial = message.channelSerial;
+    [self onSync:message fromIndex:0];
+}
 
-    if (!self.presenceMap.syncInProgress) {
-        [self.presenceMap startSync];
+- (BOOL)onSync:(ARTProtocolMessage *)message fromIndex:(NSUInteger)index {
+    const NSUInteger end = [self endOfSliceFromIndex:index count:message.presence.count];
+    [self batchPresence:^{
+        [self addSyncOfMessage:message fromIndex:index toIndex:end];
+    }];
+    if (end < message.presence.count) {
+        [self suspendChannelMessage:message atIndex:end];
+        return NO;
     }
-    else {
-        ARTLogDebug(self.logger, @"RT:%p C:%p (%@) PresenceMap sync is in progress", _realtime, self, self.name);
+    return YES;
+}
+
+- (void)addSyncOfMessage:(ARTProtocolMessage *)message fromIndex:(NSUInteger)index toIndex:(NSUInteger)end {
+    if (index == 0) {
+        self.presenceMap.syncMsgSerial = [message.msgSerial longLongValue];
+        self.presenceMap.syncChannelSerial = message.channelSerial;
+
+        if (!self.presenceMap.syncInProgress) {
+            [self.presenceMap startSync];
+        }
+        else {
+            ARTLogDebug(self.logger, @"RT:%p C:%p (%@) PresenceMap sync is in progress", _realtime, self, self.name);
+        }
     }
 
-    for (int i=0; i<[message.presence count]; i++) {
+    for (NSUInteger i = index; i < end; i++) {
         ARTPresenceMessage *presence = [message.presence objectAtIndex:i];
         if ([self.presenceMap add:presence]) {
             [self broadcastPresence:presence];
         }
     }
 
-    if ([self isLastChannelSerial:message.channelSerial]) {
+    if (end == message.presence.count && [self isLastChannelSerial:message.channelSerial]) {
         [self.presenceMap endSync];
         self.presenceMap.syncChannelSerial = nil;
         ARTLogDebug(self.logger, @"RT:%p C:%p (%@) PresenceMap sync ended", _realtime, self, self.name);
@@ -937,6 +1133,22 @@ dispatch_sync(_queue, ^{
 
 - (void)broadcastPresence:(ARTPresenceMessage *)pm {
     [self.presenceEventEmitter emit:[ARTEvent newWithPresenceAction:pm.action] with:pm];
+    [_presenceBatch addObject:pm];
+}
+
+/// Runs `block`, then emits the net effect of the presence messages it broadcast as a single batch. Nested calls join the outer batch.
+- (void)batchPresence:(void (^)(void))block {
+    if (_presenceBatch || self.presenceBatchEventEmitter.anyListeners.count == 0) {
+        block();
+        return;
+    }
+    _presenceBatch = [NSMutableArray array];
+    block();
+    NSArray<ARTPresenceMessage *> *const batch = [ARTPresenceMessage netPresenceOfMessages:_presenceBatch];
+    _presenceBatch = nil;
+    if (batch.count > 0) {
+        [self.presenceBatchEventEmitter emit:nil with:batch];
+    }
 }
 
 - (void)onError:(ARTProtocolMessage *)msg {
@@ -960,6 +1172,7 @@ dispatch_sync(_queue, ^{
         };
     }
 dispatch_sync(_queue, ^{
+    [self wasUsed_nosync];
     [self _attach:callback];
 });
 }
@@ -1035,19 +1248,21 @@ dispatch_sync(_queue, ^{
         attachMessage.flags = attachMessage.flags | ARTProtocolMessageFlagAttachResume;
     }
 
-    [self.realtime send:attachMessage sentCallback:^(ARTErrorInfo *error) {
-        if (error) {
-            return;
-        }
-        // Set attach timer after the connection is active
-        [[self unlessStateChangesBefore:self.realtime.options.testOptions.realtimeRequestTimeout do:^{
-            // Timeout
-            ARTErrorInfo *errorInfo = [ARTErrorInfo createWithCode:ARTStateAttachTimedOut message:@"attach timed out"];
-            ARTChannelStateChangeMetadata *const metadata = [[ARTChannelStateChangeMetadata alloc] initWithState:ARTStateAttachTimedOut
-                                                                                                       errorInfo:errorInfo];
-            [self setSuspended:metadata];
-        }] startTimer];
-    } ackCallback:nil];
+    [self.realtime.attachScheduler scheduleAttachOfChannel:self.name sendAttach:^{
+        [self.realtime send:attachMessage sentCallback:^(ARTErrorInfo *error) {
+            if (error) {
+                return;
+            }
+            // Set attach timer after the connection is active
+            [[self unlessStateChangesBefore:self.realtime.options.testOptions.realtimeRequestTimeout do:^{
+                // Timeout
+                ARTErrorInfo *errorInfo = [ARTErrorInfo createWithCode:ARTStateAttachTimedOut message:@"attach timed out"];
+                ARTChannelStateChangeMetadata *const metadata = [[ARTChannelStateChangeMetadata alloc] initWithState:ARTStateAttachTimedOut
+                                                                                                           errorInfo:errorInfo];
+                [self setSuspended:metadata];
+            }] startTimer];
+        } ackCallback:nil];
+    }];
 
     if (![self.realtime shouldQueueEvents]) {
         ARTEventListener *reconnectedListener = [self.realtime.connectedEventEmitter once:^(NSNull *n) {
@@ -1157,8 +1372,8 @@ dispatch_sync(_queue, ^{
         }];
     }
 
-    if (self.presenceMap.syncInProgress) {
-        [self.presenceMap failsSync:[ARTErrorInfo createWithCode:ARTErrorChannelOperationFailed message:@"channel is being DETACHED"]];
+    if (_presenceMap.syncInProgress) {
+        [_presenceMap failsSync:[ARTErrorInfo createWithCode:ARTErrorChannelOperationFailed message:@"channel is being DETACHED"]];
     }
 }
 
@@ -1226,11 +1441,15 @@ dispatch_sync(_queue, ^{
     for (ARTMessage *message in messages) {
         size += [message messageSize];
     }
+    return size > [self maxMessageSize];
+}
+
+- (NSInteger)maxMessageSize {
     NSInteger maxSize = [ARTDefault maxMessageSize];
     if (self.realtime.connection.maxMessageSize) {
         maxSize = self.realtime.connection.maxMessageSize;
     }
-    return size > maxSize;
+    return maxSize;
 }
 
 - (ARTRealtimeChannelOptions *)getOptions {
@@ -6,6 +6,9 @@
 #import "ARTRealtimePresence+Private.h"
 #import "ARTClientOptions+TestConfiguration.h"
 #import "ARTTestClientOptions.h"
+#import "ARTInternalLog.h"
+#import "ARTStatus.h"
+#import "ARTEventEmitter+Private.h"
 
 @implementation ARTRealtimeChannels {
     ARTQueuedDealloc *_dealloc;
@@ -32,6 +35,22 @@
     return [[ARTRealtimeChannel alloc] initWithInternal:[_internal get:(NSString *)name options:options] queuedDealloc:_dealloc];
 }
 
+- (NSArray<ARTRealtimeChannel *> *)getAll:(NSArray<NSString *> *)names options:(nullable ARTRealtimeChannelOptions *)options {
+    return [self publicChannelsOfInternalChannels:[_internal getAll:names options:options]];
+}
+
+- (NSDictionary<NSString *, ARTEventListener *> *)subscribeAll:(NSArray<NSString *> *)names options:(nullable ARTRealtimeChannelOptions *)options onAttach:(nullable ARTChannelsAttachCallback)onAttach callback:(ARTChannelMessageCallback)callback {
+    return [_internal subscribeAll:names options:options onAttach:onAttach callback:callback];
+}
+
+- (NSArray<ARTRealtimeChannel *> *)publicChannelsOfInternalChannels:(NSArray<ARTRealtimeChannelInternal *> *)internalChannels {
+    NSMutableArray<ARTRealtimeChannel *> *channels = [NSMutableArray arrayWithCapacity:internalChannels.count];
+    for (ARTRealtimeChannelInternal *internalChannel in internalChannels) {
+        [channels addObject:[[ARTRealtimeChannel alloc] initWithInternal:internalChannel queuedDealloc:_dealloc]];
+    }
+    return channels;
+}
+
 - (void)release:(NSString *)name callback:(nullable ARTCallback)errorInfo {
     [_internal release:(NSString *)name callback:errorInfo];
 }
@@ -40,6 +59,18 @@
     [_internal release:(NSString *)name];
 }
 
+- (ARTChannelEvictionStats *)evictionStats {
+    return _internal.evictionStats;
+}
+
+- (ARTEventListener *)onEviction:(ARTChannelEvictionCallback)callback {
+    return [_internal onEviction:callback];
+}
+
+- (void)offEviction:(ARTEventListener *)listener {
+    [_internal offEviction:listener];
+}
+
 - (id<NSFastEnumeration>)iterate {
     return [_internal copyIntoIteratorWithMapper:^ARTRealtimeChannel *(ARTRealtimeChannelInternal *internalChannel) {
         return [[ARTRealtimeChannel alloc] initWithInternal:internalChannel queuedDealloc:self->_dealloc];
@@ -48,6 +79,26 @@
 
 @end
 
+/// What `ARTRealtimeChannelsInternal` emits when a channel has been evicted.
+@interface ARTChannelEviction : NSObject
+
+@property (nonatomic, readonly) NSString *channelName;
+@property (nonatomic, readonly) ARTChannelEvictionReason reason;
+
+@end
+
+@implementation ARTChannelEviction
+
+- (instancetype)initWithChannelName:(NSString *)channelName reason:(ARTChannelEvictionReason)reason {
+    if (self = [super init]) {
+        _channelName = channelName;
+        _reason = reason;
+    }
+    return self;
+}
+
+@end
+
 @interface ARTRealtimeChannelsInternal ()
 
 @property (nonatomic, readonly) ARTInternalLog *logger;
@@ -61,6 +112,7 @@
 @implementation ARTRealtimeChannelsInternal {
     ARTChannels *_channels;
     dispatch_queue_t _userQueue;
+    ARTEventEmitter<ARTEvent *, ARTChannelEviction *> *_evictionEventEmitter;
 }
 
 - (instancetype)initWithRealtime:(ARTRealtimeInternal *)realtime logger:(ARTInternalLog *)logger {
@@ -70,6 +122,19 @@
         _queue = _realtime.rest.queue;
         _logger = logger;
         _channels = [[ARTChannels alloc] initWithDelegate:self dispatchQueue:_queue prefix:_realtime.options.testOptions.channelNamePrefix];
+        _evictionEventEmitter = [[ARTInternalEventEmitter alloc] initWithQueue:_queue];
+        ARTChannelEvictionPolicy *const evictionPolicy = _realtime.options.channelEvictionPolicy;
+        if (evictionPolicy) {
+            __weak ARTRealtimeChannelsInternal *weakSelf = self;
+            _channels.evictionPolicy = evictionPolicy;
+            _channels.evictionHandler = ^(NSString *name, ARTChannelEvictionReason reason) {
+                ARTRealtimeChannelsInternal *const strongSelf = weakSelf;
+                if (strongSelf) {
+                    ARTLogDebug(strongSelf.logger, @"R:%p channel %@ evicted (reason: %lu)", strongSelf->_realtime, name, (unsigned long)reason);
+                    [strongSelf->_evictionEventEmitter emit:nil with:[[ARTChannelEviction alloc] initWithChannelName:name reason:reason]];
+                }
+            };
+        }
     }
     return self;
 }
@@ -94,6 +159,84 @@
     return [_channels exists:name];
 }
 
+- (NSArray<ARTRealtimeChannelInternal *> *)getAll:(NSArray<NSString *> *)names options:(ARTRealtimeChannelOptions *)options {
+    __block NSArray<ARTRealtimeChannelInternal *> *channels;
+dispatch_sync(_queue, ^{
+    channels = [self _getAll:names options:options];
+});
+    return channels;
+}
+
+- (NSArray<ARTRealtimeChannelInternal *> *)_getAll:(NSArray<NSString *> *)names options:(ARTRealtimeChannelOptions *)options {
+    NSMutableArray<ARTRealtimeChannelInternal *> *channels = [NSMutableArray arrayWithCapacity:names.count];
+    for (NSString *name in names) {
+        [channels addObject:[_channels _getChannel:name options:options addPrefix:true]];
+    }
+    return channels;
+}
+
+- (NSDictionary<NSString *, ARTEventListener *> *)subscribeAll:(NSArray<NSString *> *)names options:(ARTRealtimeChannelOptions *)options onAttach:(ARTChannelsAttachCallback)onAttach callback:(ARTChannelMessageCallback)cb {
+    if (onAttach) {
+        ARTChannelsAttachCallback userOnAttach = onAttach;
+        onAttach = ^(NSDictionary<NSString *, ARTErrorInfo *> *errors) {
+            dispatch_async(self->_userQueue, ^{
+                userOnAttach(errors);
+            });
+        };
+    }
+
+    NSMutableDictionary<NSString *, ARTEventListener *> *listeners = [NSMutableDictionary dictionaryWithCapacity:names.count];
+dispatch_sync(_queue, ^{
+    NSArray<ARTRealtimeChannelInternal *> *const channels = [self _getAll:names options:options];
+
+    // A single attach callback for all the channels, called once the last of them has attached or failed to.
+    NSMutableDictionary<NSString *, ARTErrorInfo *> *errors = [NSMutableDictionary dictionary];
+    NSMutableSet<ARTRealtimeChannelInternal *> *pending = [NSMutableSet setWithArray:channels];
+    void (^attachDidEnd)(NSString *, ARTRealtimeChannelInternal *, ARTErrorInfo *) = ^(NSString *name, ARTRealtimeChannelInternal *channel, ARTErrorInfo *error) {
+        if (![pending containsObject:channel]) {
+            return;
+        }
+        [pending removeObject:channel];
+        if (error) {
+            errors[name] = error;
+        }
+        if (pending.count == 0 && onAttach) {
+            onAttach(errors.count > 0 ? errors : nil);
+        }
+    };
+
+    NSMutableSet<ARTRealtimeChannelInternal *> *subscribed = [NSMutableSet set];
+    [channels enumerateObjectsUsingBlock:^(ARTRealtimeChannelInternal *channel, NSUInteger i, BOOL *stop) {
+        if ([subscribed containsObject:channel]) {
+            return;
+        }
+        [subscribed addObject:channel];
+        NSString *const name = names[i];
+        // Same rules as a single channel's subscribe: only an INITIALIZED channel gets attached (RTL7c), so
+        // there's nothing to wait for on the others, and a FAILED one reports its error and isn't subscribed to.
+        const BOOL willAttach = channel.state_nosync == ARTRealtimeChannelInitialized || channel.state_nosync == ARTRealtimeChannelFailed;
+        ARTEventListener *const listener = [channel _subscribeWithAttachCallback:^(ARTErrorInfo *error) {
+            attachDidEnd(name, channel, error);
+        } callback:^(ARTMessage *message) {
+            dispatch_async(self->_userQueue, ^{
+                cb(name, message);
+            });
+        }];
+        if (listener) {
+            listeners[name] = listener;
+        }
+        if (!willAttach) {
+            attachDidEnd(name, channel, nil);
+        }
+    }];
+    if (channels.count == 0 && onAttach) {
+        onAttach(nil);
+    }
+    ARTLogDebug(self.logger, @"R:%p subscribed to %lu channels at once", self->_realtime, (unsigned long)listeners.count);
+});
+    return listeners;
+}
+
 - (void)release:(NSString *)name callback:(ARTCallback)cb {
     name = [_channels addPrefix:name];
 
@@ -113,11 +256,7 @@ dispatch_sync(_queue, ^{
     }
 
     ARTRealtimeChannelInternal *channel = [self->_channels _get:name];
-    [channel _detach:^(ARTErrorInfo *errorInfo) {
-        [channel off_nosync];
-        [channel _unsubscribe];
-        [channel.presence _unsubscribe];
-
+    [self detachAndUnsubscribeChannel:channel callback:^(ARTErrorInfo *errorInfo) {
         // Only release if the stored channel now is the same as whne.
         // Otherwise, subsequent calls to this release method race, and
         // a new channel, created between the first call releases the stored
@@ -132,6 +271,15 @@ dispatch_sync(_queue, ^{
 });
 }
 
+- (void)detachAndUnsubscribeChannel:(ARTRealtimeChannelInternal *)channel callback:(ARTCallback)callback {
+    [channel _detach:^(ARTErrorInfo *errorInfo) {
+        [channel off_nosync];
+        [channel _unsubscribe];
+        [channel.presence _unsubscribe];
+        callback(errorInfo);
+    }];
+}
+
 - (void)release:(NSString *)name {
     [self release:name callback:nil];
 }
@@ -148,4 +296,64 @@ dispatch_sync(_queue, ^{
     return [_channels _getChannel:name options:options addPrefix:addPrefix];
 }
 
+- (void)channelWasUsed_nosync:(ARTRealtimeChannelInternal *)channel {
+    [_channels _channelWasUsed:channel];
+}
+
+#pragma mark - Eviction
+
+- (ARTChannelEvictionStats *)evictionStats {
+    __block ARTChannelEvictionStats *ret;
+dispatch_sync(_queue, ^{
+    ret = self->_channels.evictionStats;
+});
+    return ret;
+}
+
+- (ARTEventListener *)onEviction:(ARTChannelEvictionCallback)cb {
+    ARTChannelEvictionCallback userCallback = cb;
+    __block ARTEventListener *listener;
+dispatch_sync(_queue, ^{
+    listener = [self->_evictionEventEmitter on:^(ARTChannelEviction *eviction) {
+        dispatch_async(self->_userQueue, ^{
+            userCallback(eviction.channelName, eviction.reason);
+        });
+    }];
+});
+    return listener;
+}
+
+- (void)offEviction:(ARTEventListener *)listener {
+dispatch_sync(_queue, ^{
+    [self->_evictionEventEmitter off:listener];
+});
+}
+
+- (BOOL)canEvictChannel:(ARTRealtimeChannelInternal *)channel {
+    return [channel isEvictable_nosync];
+}
+
+- (NSUInteger)estimatedSizeOfChannel:(ARTRealtimeChannelInternal *)channel {
+    return [channel estimatedSize_nosync];
+}
+
+- (void)prepareEvictionOfChannel:(ARTRealtimeChannelInternal *)channel completion:(BOOL (^)(void))completion {
+    ARTLogDebug(self.logger, @"R:%p C:%p (%@) evicting idle channel", _realtime, channel, channel.name);
+    const BOOL wasAttached = channel.state_nosync == ARTRealtimeChannelAttached || channel.state_nosync == ARTRealtimeChannelAttaching;
+    [channel _detach:^(ARTErrorInfo *errorInfo) {
+        if (completion()) {
+            [channel off_nosync];
+            [channel _unsubscribe];
+            [channel.presence _unsubscribe];
+        }
+        else {
+            // Used while it was being detached, so it's kept as it was.
+            ARTLogDebug(self.logger, @"R:%p C:%p (%@) eviction cancelled", self->_realtime, channel, channel.name);
+            if (wasAttached) {
+                [channel _attach:nil];
+            }
+        }
+    }];
+}
+
 @end
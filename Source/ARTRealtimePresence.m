@@ -9,7 +9,6 @@
 #import "ARTPresence+Private.h"
 #import "ARTDataQuery+Private.h"
 #import "ARTConnection+Private.h"
-#import "ARTNSArray+ARTFunctional.h"
 #import "ARTInternalLog.h"
 
 #pragma mark - ARTRealtimePresenceQuery
@@ -51,6 +50,14 @@
     [_internal get:query callback:callback];
 }
 
+- (void)snapshot:(ARTPresenceSnapshotCallback)callback {
+    [_internal snapshot:callback];
+}
+
+- (void)changesSinceVersion:(NSUInteger)version callback:(ARTPresenceChangesCallback)callback {
+    [_internal changesSinceVersion:version callback:callback];
+}
+
 - (void)enter:(id _Nullable)data {
     [_internal enter:data];
 }
@@ -99,6 +106,18 @@
     [_internal leaveClient:clientId data:data callback:cb];
 }
 
+- (void)enterClients:(NSArray<ARTPresenceMessage *> *)members callback:(nullable ARTPresenceClientsCallback)callback {
+    [_internal enterClients:members callback:callback];
+}
+
+- (void)updateClients:(NSArray<ARTPresenceMessage *> *)members callback:(nullable ARTPresenceClientsCallback)callback {
+    [_internal updateClients:members callback:callback];
+}
+
+- (void)leaveClients:(NSArray<ARTPresenceMessage *> *)members callback:(nullable ARTPresenceClientsCallback)callback {
+    [_internal leaveClients:members callback:callback];
+}
+
 - (ARTEventListener *_Nullable)subscribe:(ARTPresenceMessageCallback)callback {
     return [_internal subscribe:callback];
 }
@@ -115,6 +134,10 @@
     return [_internal subscribe:action onAttach:onAttach callback:cb];
 }
 
+- (ARTEventListener *_Nullable)subscribeToBatches:(ARTPresenceMessagesBatchCallback)callback {
+    return [_internal subscribeToBatches:callback];
+}
+
 - (void)unsubscribe {
     [_internal unsubscribe];
 }
@@ -189,7 +212,7 @@ dispatch_async(_queue, ^{
             return;
         case ARTRealtimeChannelSuspended:
             if (query && !query.waitForSync) {
-                if (callback) callback(self->_channel.presenceMap.members.allValues, nil);
+                if (callback) callback([self->_channel.presenceMap membersWithClientId:nil connectionId:nil], nil);
                 return;
             }
             if (callback) callback(nil, [ARTErrorInfo createWithCode:ARTErrorPresenceStateIsOutOfSync message:@"presence state is out of sync due to the channel being SUSPENDED"]);
@@ -198,11 +221,6 @@ dispatch_async(_queue, ^{
             break;
     }
 
-    BOOL (^filterMemberBlock)(ARTPresenceMessage *message) = ^BOOL(ARTPresenceMessage *message) {
-        return (query.clientId == nil || [message.clientId isEqualToString:query.clientId]) &&
-            (query.connectionId == nil || [message.connectionId isEqualToString:query.connectionId]);
-    };
-
     [self->_channel _attach:^(ARTErrorInfo *error) {
         if (error) {
             callback(nil, error);
@@ -211,23 +229,63 @@ dispatch_async(_queue, ^{
         const BOOL syncInProgress = self->_channel.presenceMap.syncInProgress;
         if (syncInProgress && query.waitForSync) {
             ARTLogDebug(self.logger, @"R:%p C:%p (%@) sync is in progress, waiting until the presence members is synchronized", self->_channel.realtime, self->_channel, self->_channel.name);
-            [self->_channel.presenceMap onceSyncEnds:^(NSArray<ARTPresenceMessage *> *members) {
-                NSArray<ARTPresenceMessage *> *filteredMembers = [members artFilter:filterMemberBlock];
-                callback(filteredMembers, nil);
+            [self->_channel.presenceMap onceSyncEnds:^{
+                callback([self->_channel.presenceMap membersWithClientId:query.clientId connectionId:query.connectionId], nil);
             }];
             [self->_channel.presenceMap onceSyncFails:^(ARTErrorInfo *error) {
                 callback(nil, error);
             }];
         } else {
             ARTLogDebug(self.logger, @"R:%p C:%p (%@) returning presence members (syncInProgress=%d)", self->_channel.realtime, self->_channel, self->_channel.name, syncInProgress);
-            NSArray<ARTPresenceMessage *> *members = self->_channel.presenceMap.members.allValues;
-            NSArray<ARTPresenceMessage *> *filteredMembers = [members artFilter:filterMemberBlock];
-            callback(filteredMembers, nil);
+            callback([self->_channel.presenceMap membersWithClientId:query.clientId connectionId:query.connectionId], nil);
         }
     }];
 });
 }
 
+- (void)snapshot:(ARTPresenceSnapshotCallback)callback {
+    if (callback) {
+        ARTPresenceSnapshotCallback userCallback = callback;
+        callback = ^(ARTPresenceSnapshot *s, ARTErrorInfo *e) {
+            dispatch_async(self->_userQueue, ^{
+                userCallback(s, e);
+            });
+        };
+    }
+
+dispatch_async(_queue, ^{
+    switch (self->_channel.state_nosync) {
+        case ARTRealtimeChannelDetached:
+        case ARTRealtimeChannelFailed:
+            if (callback) callback(nil, [ARTErrorInfo createWithCode:ARTErrorChannelOperationFailedInvalidState message:[NSString stringWithFormat:@"unable to return a snapshot of the current members (incompatible channel state: %@)", ARTRealtimeChannelStateToStr(self->_channel.state_nosync)]]);
+            return;
+        default:
+            break;
+    }
+    if (callback) callback([self->_channel.presenceMap snapshot], nil);
+});
+}
+
+- (void)changesSinceVersion:(NSUInteger)version callback:(ARTPresenceChangesCallback)callback {
+    if (callback) {
+        ARTPresenceChangesCallback userCallback = callback;
+        callback = ^(ARTPresenceChanges *c, ARTErrorInfo *e) {
+            dispatch_async(self->_userQueue, ^{
+                userCallback(c, e);
+            });
+        };
+    }
+
+dispatch_async(_queue, ^{
+    ARTPresenceChanges *const changes = [self->_channel.presenceMap changesSinceVersion:version];
+    if (!changes) {
+        if (callback) callback(nil, [ARTErrorInfo createWithCode:ARTErrorPresenceStateIsOutOfSync message:[NSString stringWithFormat:@"the changes since version %lu of the presence set are no longer known", (unsigned long)version]]);
+        return;
+    }
+    if (callback) callback(changes, nil);
+});
+}
+
 - (void)history:(ARTPaginatedPresenceCallback)callback {
     [self history:[[ARTRealtimeHistoryQuery alloc] init] callback:callback error:nil];
 }
@@ -396,6 +454,114 @@ dispatch_sync(_queue, ^{
     [self publishPresence:msg callback:cb];
 }
 
+- (void)enterClients:(NSArray<ARTPresenceMessage *> *)members callback:(ARTPresenceClientsCallback)callback {
+    [self publishPresenceOfClients:members action:ARTPresenceEnter callback:callback];
+}
+
+- (void)updateClients:(NSArray<ARTPresenceMessage *> *)members callback:(ARTPresenceClientsCallback)callback {
+    [self publishPresenceOfClients:members action:ARTPresenceUpdate callback:callback];
+}
+
+- (void)leaveClients:(NSArray<ARTPresenceMessage *> *)members callback:(ARTPresenceClientsCallback)callback {
+    [self publishPresenceOfClients:members action:ARTPresenceLeave callback:callback];
+}
+
+- (void)publishPresenceOfClients:(NSArray<ARTPresenceMessage *> *)members action:(ARTPresenceAction)action callback:(ARTPresenceClientsCallback)callback {
+    for (ARTPresenceMessage *member in members) {
+        if (member.clientId == nil) {
+            [ARTException raise:NSInvalidArgumentException format:@"unable to %@ presence on behalf of a member without clientId", ARTPresenceActionToStr(action).lowercaseString];
+        }
+    }
+
+    if (callback) {
+        ARTPresenceClientsCallback userCallback = callback;
+        callback = ^(NSDictionary<NSString *, ARTErrorInfo *> *_Nullable errors) {
+            dispatch_async(self->_userQueue, ^{
+                userCallback(errors);
+            });
+        };
+    }
+
+dispatch_async(_queue, ^{
+    [self publishPresenceOfClientsAfterChecks:members action:action callback:callback];
+});
+}
+
+- (void)publishPresenceOfClientsAfterChecks:(NSArray<ARTPresenceMessage *> *)members action:(ARTPresenceAction)action callback:(ARTPresenceClientsCallback)callback {
+    NSMutableDictionary<NSString *, ARTErrorInfo *> *const errors = [NSMutableDictionary dictionary];
+
+    ARTErrorInfo *batchError = nil;
+    const ARTRealtimeChannelState channelState = _channel.state_nosync;
+    if (action != ARTPresenceLeave && (channelState == ARTRealtimeChannelDetached || channelState == ARTRealtimeChannelFailed)) {
+        batchError = [ARTErrorInfo createWithCode:ARTErrorChannelOperationFailedInvalidState message:[NSString stringWithFormat:@"unable to enter presence channel (incompatible channel state: %@)", ARTRealtimeChannelStateToStr(channelState)]];
+    }
+    else if (!_channel.realtime.connection.isActive_nosync) {
+        batchError = [_channel.realtime.connection error_nosync];
+    }
+    if (batchError) {
+        for (ARTPresenceMessage *member in members) {
+            [errors setObject:batchError forKey:member.clientId];
+        }
+        if (callback) callback(errors);
+        return;
+    }
+
+    // Pack the members into as few ProtocolMessages as the max message size allows (TO3l8).
+    const NSInteger maxSize = [_channel maxMessageSize];
+    NSMutableArray<NSArray<ARTPresenceMessage *> *> *const batches = [NSMutableArray array];
+    NSMutableArray<ARTPresenceMessage *> *batch = [NSMutableArray array];
+    NSInteger batchSize = 0;
+    for (ARTPresenceMessage *member in members) {
+        ARTPresenceMessage *msg = [[ARTPresenceMessage alloc] init];
+        msg.action = action;
+        msg.clientId = member.clientId;
+        msg.data = member.data;
+        msg.connectionId = _channel.realtime.connection.id_nosync;
+
+        const NSInteger size = [msg messageSize];
+        if (size > maxSize) {
+            [errors setObject:[ARTErrorInfo createWithCode:ARTErrorMaxMessageLengthExceeded message:@"Maximum message length exceeded."] forKey:msg.clientId];
+            continue;
+        }
+        if (batch.count > 0 && batchSize + size > maxSize) {
+            [batches addObject:batch];
+            batch = [NSMutableArray array];
+            batchSize = 0;
+        }
+        [self encodePresenceData:msg];
+        [batch addObject:msg];
+        batchSize += size;
+    }
+    if (batch.count > 0) {
+        [batches addObject:batch];
+    }
+
+    if (batches.count == 0) {
+        if (callback) callback(errors.count > 0 ? errors : nil);
+        return;
+    }
+    _lastPresenceAction = action;
+
+    ARTLogDebug(self.logger, @"RT:%p C:%p (%@) publishing %@ of %lu members in %lu messages", _channel.realtime, _channel, _channel.name, ARTPresenceActionToStr(action), (unsigned long)members.count, (unsigned long)batches.count);
+    __block NSUInteger pendingBatches = batches.count;
+    for (NSArray<ARTPresenceMessage *> *presence in batches) {
+        ARTProtocolMessage *pm = [[ARTProtocolMessage alloc] init];
+        pm.action = ARTProtocolMessagePresence;
+        pm.channel = _channel.name;
+        pm.presence = presence;
+        [self sendPresence:pm callback:^(ARTErrorInfo *error) {
+            if (error) {
+                for (ARTPresenceMessage *msg in presence) {
+                    [errors setObject:error forKey:msg.clientId];
+                }
+            }
+            if (--pendingBatches == 0 && callback) {
+                callback(errors.count > 0 ? errors : nil);
+            }
+        }];
+    }
+}
+
 - (BOOL)syncComplete {
     __block BOOL ret;
 dispatch_sync(_queue, ^{
@@ -478,6 +644,28 @@ dispatch_sync(_queue, ^{
     return listener;
 }
 
+- (ARTEventListener *)subscribeToBatches:(ARTPresenceMessagesBatchCallback)cb {
+    if (cb) {
+        ARTPresenceMessagesBatchCallback userCallback = cb;
+        cb = ^(NSArray<ARTPresenceMessage *> *messages) {
+            dispatch_async(self->_userQueue, ^{
+                userCallback(messages);
+            });
+        };
+    }
+
+    __block ARTEventListener *listener = nil;
+dispatch_sync(_queue, ^{
+    if (self->_channel.state_nosync == ARTRealtimeChannelFailed) {
+        return;
+    }
+    [self->_channel _attach:nil];
+    listener = [self->_channel.presenceBatchEventEmitter on:cb];
+    ARTLogVerbose(self.logger, @"R:%p C:%p (%@) presence subscribe to batches", self->_channel.realtime, self->_channel, self->_channel.name);
+});
+    return listener;
+}
+
 - (void)unsubscribe {
 dispatch_sync(_queue, ^{
     [self _unsubscribe];
@@ -487,11 +675,13 @@ dispatch_sync(_queue, ^{
 
 - (void)_unsubscribe {
     [_channel.presenceEventEmitter off];
+    [_channel.presenceBatchEventEmitter off];
 }
 
 - (void)unsubscribe:(ARTEventListener *)listener {
 dispatch_sync(_queue, ^{
     [self->_channel.presenceEventEmitter off:listener];
+    [self->_channel.presenceBatchEventEmitter off:listener];
     ARTLogVerbose(self.logger, @"R:%p C:%p (%@) presence unsubscribe to all actions", self->_channel.realtime, self->_channel, self->_channel.name);
 });
 }
@@ -536,6 +726,17 @@ dispatch_sync(_queue, ^{
 
     _lastPresenceAction = msg.action;
 
+    [self encodePresenceData:msg];
+
+    ARTProtocolMessage *pm = [[ARTProtocolMessage alloc] init];
+    pm.action = ARTProtocolMessagePresence;
+    pm.channel = _channel.name;
+    pm.presence = @[msg];
+
+    [self sendPresence:pm callback:callback];
+}
+
+- (void)encodePresenceData:(ARTPresenceMessage *)msg {
     if (msg.data && _channel.dataEncoder) {
         ARTDataEncoderOutput *encoded = [_channel.dataEncoder encode:msg.data];
         if (encoded.errorInfo) {
@@ -544,12 +745,9 @@ dispatch_sync(_queue, ^{
         msg.data = encoded.data;
         msg.encoding = encoded.encoding;
     }
+}
 
-    ARTProtocolMessage *pm = [[ARTProtocolMessage alloc] init];
-    pm.action = ARTProtocolMessagePresence;
-    pm.channel = _channel.name;
-    pm.presence = @[msg];
-
+- (void)sendPresence:(ARTProtocolMessage *)pm callback:(ARTCallback)callback {
     ARTRealtimeChannelState channelState = _channel.state_nosync;
     switch (channelState) {
         case ARTRealtimeChannelInitialized:
@@ -1,11 +1,17 @@
 #import "ARTRealtimeTransportFactory.h"
 #import "ARTWebSocketTransport+Private.h"
 #import "ARTWebSocketFactory.h"
+#import "ARTSRPerMessageDeflate.h"
+#import "ARTSRWorkQueuePool.h"
+#import "ARTClientOptions.h"
 
 @implementation ARTDefaultRealtimeTransportFactory
 
 - (id<ARTRealtimeTransport>)transportWithRest:(ARTRestInternal *)rest options:(ARTClientOptions *)options resumeKey:(NSString *)resumeKey connectionSerial:(NSNumber *)connectionSerial logger:(ARTInternalLog *)logger {
-    const id<ARTWebSocketFactory> webSocketFactory = [[ARTDefaultWebSocketFactory alloc] init];
+    ARTSRPerMessageDeflateOptions *const perMessageDeflateOptions = options.useWebSocketCompression ? [[ARTSRPerMessageDeflateOptions alloc] init] : nil;
+    ARTSRWorkQueuePool *const workQueuePool = options.webSocketQueueCount > 0 ? [ARTSRWorkQueuePool sharedPoolWithQueueCount:options.webSocketQueueCount] : nil;
+    ARTDefaultWebSocketFactory *const webSocketFactory = [[ARTDefaultWebSocketFactory alloc] initWithPerMessageDeflateOptions:perMessageDeflateOptions workQueuePool:workQueuePool];
+    webSocketFactory.maximumFragmentLength = options.webSocketMaximumFragmentLength;
 
     return [[ARTWebSocketTransport alloc] initWithRest:rest
                                                options:options
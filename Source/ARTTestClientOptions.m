@@ -1,5 +1,5 @@
 #import "ARTTestClientOptions.h"
-#import "ARTDefault.h"
+#import "ARTDefault+Private.h"
 #import "ARTFallback+Private.h"
 #import "ARTRealtimeTransportFactory.h"
 #import "ARTJitterCoefficientGenerator.h"
@@ -12,6 +12,7 @@
         _shuffleArray = ARTFallback_shuffleArray;
         _transportFactory = [[ARTDefaultRealtimeTransportFactory alloc] init];
         _jitterCoefficientGenerator = [[ARTDefaultJitterCoefficientGenerator alloc] init];
+        _channelMessageSliceSize = [ARTDefault channelMessageSliceSize];
     }
 
     return self;
@@ -25,6 +26,7 @@
     copied.transportFactory = self.transportFactory;
     copied.reconnectionRealtimeHost = self.reconnectionRealtimeHost;
     copied.jitterCoefficientGenerator = self.jitterCoefficientGenerator;
+    copied.channelMessageSliceSize = self.channelMessageSliceSize;
 
     return copied;
 }
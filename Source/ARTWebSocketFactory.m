@@ -1,10 +1,34 @@
 #import "ARTWebSocketFactory.h"
 #import "ARTSRWebSocket.h"
+#import "ARTSRPerMessageDeflate.h"
+#import "ARTSRWorkQueuePool.h"
 
 @implementation ARTDefaultWebSocketFactory
 
+- (instancetype)init {
+    return [self initWithPerMessageDeflateOptions:nil];
+}
+
+- (instancetype)initWithPerMessageDeflateOptions:(ARTSRPerMessageDeflateOptions *)perMessageDeflateOptions {
+    return [self initWithPerMessageDeflateOptions:perMessageDeflateOptions workQueuePool:nil];
+}
+
+- (instancetype)initWithPerMessageDeflateOptions:(ARTSRPerMessageDeflateOptions *)perMessageDeflateOptions workQueuePool:(ARTSRWorkQueuePool *)workQueuePool {
+    if (self = [super init]) {
+        _perMessageDeflateOptions = [perMessageDeflateOptions copy];
+        _workQueuePool = workQueuePool;
+    }
+    return self;
+}
+
 - (id<ARTWebSocket>)createWebSocketWithURLRequest:(NSURLRequest *)request logger:(ARTInternalLog *)logger {
-    return [[ARTSRWebSocket alloc] initWithURLRequest:request logger:logger];
+    ARTSRWebSocket *const webSocket = [[ARTSRWebSocket alloc] initWithURLRequest:request logger:logger];
+    webSocket.perMessageDeflateOptions = self.perMessageDeflateOptions;
+    webSocket.maximumFragmentLength = self.maximumFragmentLength;
+    if (self.workQueuePool) {
+        [webSocket scheduleOnTargetQueue:[self.workQueuePool nextQueue]];
+    }
+    return webSocket;
 }
 
 @end
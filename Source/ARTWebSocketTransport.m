@@ -266,6 +266,11 @@ NS_ASSUME_NONNULL_END
     [_delegate realtimeTransportAvailable:self];
 }
 
+// Text frames are decoded straight from their bytes, which the WebSocket has already validated as UTF-8, rather than turned into a string and back.
+- (BOOL)webSocketShouldConvertTextFrameToString:(id<ARTWebSocket>)webSocket {
+    return NO;
+}
+
 - (void)webSocket:(id<ARTWebSocket>)webSocket didCloseWithCode:(NSInteger)code reason:(NSString *)reason wasClean:(BOOL)wasClean {
     ARTLogDebug(self.logger, @"R:%p WS:%p websocket did disconnect (code %ld) %@", _delegate, self, (long)code, reason);
 
@@ -2,6 +2,8 @@
 
 @protocol ARTWebSocket;
 @class ARTInternalLog;
+@class ARTSRPerMessageDeflateOptions;
+@class ARTSRWorkQueuePool;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -20,6 +22,23 @@ NS_SWIFT_NAME(WebSocketFactory)
  */
 NS_SWIFT_NAME(DefaultWebSocketFactory)
 @interface ARTDefaultWebSocketFactory: NSObject <ARTWebSocketFactory>
+
+/// Creates web sockets that offer the permessage-deflate extension with the given parameters, or that don't offer it if they're `nil`.
+- (instancetype)initWithPerMessageDeflateOptions:(nullable ARTSRPerMessageDeflateOptions *)perMessageDeflateOptions;
+
+/**
+ Creates web sockets that offer the permessage-deflate extension with the given parameters, or that don't offer it if they're `nil`.
+ The sockets are scheduled on the queues of `workQueuePool` in turn, or on the shared network thread if it's `nil`.
+ */
+- (instancetype)initWithPerMessageDeflateOptions:(nullable ARTSRPerMessageDeflateOptions *)perMessageDeflateOptions
+                                   workQueuePool:(nullable ARTSRWorkQueuePool *)workQueuePool NS_DESIGNATED_INITIALIZER;
+
+@property (nullable, nonatomic, readonly) ARTSRPerMessageDeflateOptions *perMessageDeflateOptions;
+@property (nullable, nonatomic, readonly) ARTSRWorkQueuePool *workQueuePool;
+
+/// The `maximumFragmentLength` of the web sockets created. Default: 0, for messages in a single frame.
+@property (nonatomic) NSUInteger maximumFragmentLength;
+
 @end
 
 NS_ASSUME_NONNULL_END
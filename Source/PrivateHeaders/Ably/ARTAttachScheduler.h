@@ -0,0 +1,59 @@
+@import Foundation;
+
+@class ARTInternalLog;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The progress of a batch of channel attaches, that is of the attaches requested between two moments when the scheduler had none in progress.
+ */
+NS_SWIFT_NAME(AttachBatchProgress)
+@interface ARTAttachBatchProgress : NSObject
+
+/// The number of attaches requested since the batch started.
+@property (nonatomic, readonly) NSUInteger requested;
+/// The number of attaches that ended with the channel attached.
+@property (nonatomic, readonly) NSUInteger succeeded;
+/// The number of attaches that ended any other way.
+@property (nonatomic, readonly) NSUInteger failed;
+/// The number of ATTACH messages sent and not answered yet.
+@property (nonatomic, readonly) NSUInteger inFlight;
+/// The number of attaches waiting for a free slot.
+@property (nonatomic, readonly) NSUInteger waiting;
+/// The time elapsed since the batch started, up to its end if it has ended.
+@property (nonatomic, readonly) NSTimeInterval duration;
+/// The mean time between an ATTACH message being sent and the attach ending.
+@property (nonatomic, readonly) NSTimeInterval averageAttachLatency;
+/// The longest time between an ATTACH message being sent and the attach ending.
+@property (nonatomic, readonly) NSTimeInterval maxAttachLatency;
+
+@end
+
+/**
+ Limits the number of channels of a connection that attach at the same time.
+
+ Up to `maxConcurrentAttaches` ATTACH messages are sent at once. The others wait, without a timeout timer, until the number of attaches in progress has dropped to half the limit, and then are sent together to fill the free slots, so that they share socket writes.
+ */
+NS_SWIFT_NAME(AttachScheduler)
+@interface ARTAttachScheduler : NSObject
+
+/// `maxConcurrentAttaches` is 0 for no limit.
+- (instancetype)initWithMaxConcurrentAttaches:(NSUInteger)maxConcurrentAttaches logger:(ARTInternalLog *)logger;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSUInteger maxConcurrentAttaches;
+
+/// A snapshot of the progress of the current batch of attaches, or of the last one if none is in progress.
+@property (nonatomic, readonly) ARTAttachBatchProgress *progress;
+
+/**
+ Calls `sendAttach` as soon as there is a free slot for the channel, straight away if there's one already. Scheduling the attach of a channel that is already waiting replaces its `sendAttach`; scheduling the attach of a channel that is already attaching calls `sendAttach` again straight away.
+ */
+- (void)scheduleAttachOfChannel:(NSString *)channelName sendAttach:(void (^)(void))sendAttach;
+
+/// Frees the slot of a channel whose attach ended, and sends the waiting attaches that now fit.
+- (void)attachOfChannelDidEnd:(NSString *)channelName attached:(BOOL)attached;
+
+@end
+
+NS_ASSUME_NONNULL_END
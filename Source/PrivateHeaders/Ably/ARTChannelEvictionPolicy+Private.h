@@ -0,0 +1,11 @@
+#import <Ably/ARTChannelEvictionPolicy.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface ARTChannelEvictionStats ()
+
+- (instancetype)initWithIdleEvictions:(NSUInteger)idleEvictions countEvictions:(NSUInteger)countEvictions sizeEvictions:(NSUInteger)sizeEvictions;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -1,5 +1,7 @@
 #import <Ably/ARTChannels.h>
+#import <Ably/ARTChannelEvictionPolicy.h>
 
+@class ARTChannel;
 @class ARTRestChannel;
 @class ARTChannelOptions;
 
@@ -9,6 +11,14 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (id)makeChannel:(NSString *)channel options:(nullable ARTChannelOptions *)options;
 
+@optional
+
+// Needed by an `evictionPolicy`.
+- (BOOL)canEvictChannel:(id)channel;
+- (NSUInteger)estimatedSizeOfChannel:(id)channel;
+/// Gets `channel` ready to be removed, for instance detaches it, then calls `completion`, which removes it and returns `YES`, or returns `NO` if the channel was used meanwhile and is kept.
+- (void)prepareEvictionOfChannel:(id)channel completion:(BOOL (^)(void))completion;
+
 @end
 
 @interface ARTChannels<ChannelType> ()
@@ -24,6 +34,20 @@ NS_ASSUME_NONNULL_BEGIN
 - (ChannelType)_getChannel:(NSString *)name options:(ARTChannelOptions * _Nullable)options addPrefix:(BOOL)addPrefix;
 - (void)_release:(NSString *)name;
 
+/**
+ When set, the channels are tracked in least recently used order and evicted as the policy says; see `ARTChannelEvictionPolicy`. Set on the queue, before channels are created.
+ */
+@property (nullable, nonatomic) ARTChannelEvictionPolicy *evictionPolicy;
+/// Called on the queue each time a channel has been evicted.
+@property (nullable, nonatomic, copy) void (^evictionHandler)(NSString *name, ARTChannelEvictionReason reason);
+@property (nonatomic, readonly) ARTChannelEvictionStats *evictionStats;
+
+/// Marks `channel` as used for the eviction policy, like getting it does, keeping it if it is being evicted.
+- (void)_channelWasUsed:(ARTChannel *)channel;
+
+/// Evicts the channels the policy says should be. This is also done periodically, and whenever a channel is created beyond `maxChannels`.
+- (void)_evictChannels;
+
 - (instancetype)initWithDelegate:(id<ARTChannelsDelegate>)delegate dispatchQueue:(dispatch_queue_t)queue prefix:(nullable NSString *)prefix;
 
 @end
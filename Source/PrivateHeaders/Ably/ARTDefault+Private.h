@@ -7,4 +7,7 @@ extern NSString *const ARTDefaultProduction;
 + (void)setConnectionStateTtl:(NSTimeInterval)value;
 + (void)setMaxMessageSize:(NSInteger)value;
 
+/// The maximum number of entries of a channel message processed in one go on the internal queue.
++ (NSUInteger)channelMessageSliceSize;
+
 @end
@@ -0,0 +1,48 @@
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Holds the `vcdiff` base payload of a channel and applies deltas against it (RTL19, RTL20).
+
+ The arena owns two reusable buffers: one holds the current base, the other receives the output of the next delta. After a delta has been applied successfully the buffers swap roles, so the decoded payload becomes the new base without being copied and, once the buffers have grown to the size of the channel's payloads, applying a delta performs no allocations.
+
+ The data returned from `applyDelta:deltaId:baseId:error:` is owned by the arena and is overwritten by subsequent calls; callers must copy it if they need it to outlive the next call.
+ */
+NS_SWIFT_NAME(DeltaArena)
+@interface ARTDeltaArena : NSObject
+
+/**
+ The identifier of the current base payload, or `nil` if no base has been stored yet.
+ */
+@property (nullable, nonatomic, readonly) NSString *baseId;
+
+/**
+ The current base payload. Owned by the arena, see the class documentation.
+ */
+@property (nullable, nonatomic, readonly) NSData *base;
+
+/**
+ Copies `data` into the base buffer.
+ */
+- (void)setBase:(NSData *)data withId:(NSString *)baseId;
+
+/**
+ Stores the UTF-8 representation of `string` as the base, encoding it straight into the base buffer.
+ */
+- (void)setBaseString:(NSString *)string withId:(NSString *)baseId;
+
+/**
+ Applies a `vcdiff` delta to the current base. On success the result becomes the new base, identified by `deltaId`.
+
+ @param delta The `vcdiff` encoded delta.
+ @param deltaId The identifier of the message carrying `delta`.
+ @param baseId The identifier of the payload `delta` was computed against; must match `baseId`.
+
+ @return The decoded payload, owned by the arena, or `nil` on failure.
+ */
+- (nullable NSData *)applyDelta:(NSData *)delta deltaId:(NSString *)deltaId baseId:(NSString *)baseId error:(NSError *_Nullable *_Nullable)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -38,6 +38,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (readonly, atomic) NSMutableDictionary<NSString *, NSMutableArray<ARTEventListener *> *> *listeners;
 @property (readonly, atomic) NSMutableArray<ARTEventListener *> *anyListeners;
+@property (readonly, nonatomic) BOOL hasListeners;
 
 @end
 
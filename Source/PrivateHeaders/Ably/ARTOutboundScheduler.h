@@ -0,0 +1,38 @@
+@import Foundation;
+
+@class ARTQueuedMessage;
+@class ARTProtocolMessage;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The priority classes of outbound protocol messages, from the most to the least urgent.
+typedef NS_ENUM(NSUInteger, ARTOutboundPriority) {
+    ARTOutboundPriorityControl,
+    ARTOutboundPriorityPresence,
+    ARTOutboundPriorityPublish,
+};
+
+/**
+ Orders a backlog of outbound protocol messages by priority: control messages such as ATTACH first, then PRESENCE, then MESSAGE.
+
+ Messages of the same priority are dequeued in the order they were enqueued in, so publishes are never reordered, and so are the messages of each channel, whatever their priority: a message waits for the messages for the same channel enqueued before it, so that a DETACH doesn't overtake the publishes before it. Whether a message has to wait is looked up per channel, in constant time, whatever the size of the backlog. A lower priority isn't starved: once `fairnessInterval` messages of higher priorities have been dequeued while it was waiting, its oldest message is dequeued next.
+ */
+NS_SWIFT_NAME(OutboundScheduler)
+@interface ARTOutboundScheduler : NSObject
+
+- (instancetype)initWithFairnessInterval:(NSUInteger)fairnessInterval;
+- (instancetype)init NS_UNAVAILABLE;
+
++ (ARTOutboundPriority)priorityOfProtocolMessage:(ARTProtocolMessage *)message;
+
+/// The number of messages waiting to be dequeued.
+@property (nonatomic, readonly) NSUInteger count;
+
+- (void)enqueue:(ARTQueuedMessage *)message;
+
+/// Returns the next message to send, or `nil` if there are none.
+- (nullable ARTQueuedMessage *)dequeue;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -5,6 +5,8 @@
 @class ARTPresenceMessage;
 @class ARTErrorInfo;
 @class ARTInternalLog;
+@class ARTPresenceSnapshot;
+@class ARTPresenceChanges;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -19,8 +21,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 /// List of members.
 /// The key is the memberKey and the value is the latest relevant ARTPresenceMessage for that clientId.
+/// Members are kept in compact form and materialized on the first access after each change, so prefer `memberCount` and `membersWithClientId:connectionId:`.
 @property (readonly, atomic) NSDictionary<NSString *, ARTPresenceMessage *> *members;
 
+@property (readonly, nonatomic) NSUInteger memberCount;
+
 /// List of internal members.
 /// The key is the clientId and the value is the latest relevant ARTPresenceMessage for that clientId.
 @property (readonly, atomic) NSMutableSet<ARTPresenceMessage *> *localMembers;
@@ -30,12 +35,24 @@ NS_ASSUME_NONNULL_BEGIN
 @property (readwrite, nonatomic) int64_t syncMsgSerial;
 @property (readwrite, nonatomic, nullable) NSString *syncChannelSerial;
 @property (readonly, nonatomic) NSUInteger syncSessionId;
+/// Incremented whenever a member enters, is updated or leaves, and when the map is reset.
+@property (readonly, nonatomic) NSUInteger version;
 @property (readonly, nonatomic, getter=syncComplete) BOOL syncComplete;
 @property (readonly, nonatomic, getter=syncInProgress) BOOL syncInProgress;
 
 - (instancetype)init UNAVAILABLE_ATTRIBUTE;
 - (instancetype)initWithQueue:(_Nonnull dispatch_queue_t)queue logger:(ARTInternalLog *)logger;
 
+/// Returns the members with the given clientId and/or connectionId, or all members if neither is given.
+/// Looked up through secondary indexes, so the cost is proportional to the number of matching members.
+- (NSArray<ARTPresenceMessage *> *)membersWithClientId:(nullable NSString *)clientId connectionId:(nullable NSString *)connectionId;
+
+/// Returns an immutable view of the present members at the current `version`. Shares `members` until the next change, which copies it instead of mutating it.
+- (ARTPresenceSnapshot *)snapshot;
+
+/// Returns the net changes since `version`, or nil if they are no longer known: the map only remembers its latest changes and forgets them all when reset.
+- (nullable ARTPresenceChanges *)changesSinceVersion:(NSUInteger)version;
+
 - (BOOL)add:(ARTPresenceMessage *)message;
 - (void)reset;
 
@@ -43,7 +60,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)endSync;
 - (void)failsSync:(ARTErrorInfo *)error;
 
-- (void)onceSyncEnds:(void (^)(NSArray<ARTPresenceMessage *> *))callback;
+- (void)onceSyncEnds:(void (^)(void))callback;
 - (void)onceSyncFails:(ARTCallback)callback;
 
 - (void)internalAdd:(ARTPresenceMessage *)message;
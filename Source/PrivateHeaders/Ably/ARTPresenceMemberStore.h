@@ -0,0 +1,51 @@
+#import <Foundation/Foundation.h>
+#import <Ably/ARTPresenceMessage.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Compact storage for the members of a presence set.
+
+ Instead of an `ARTPresenceMessage` per member, each member occupies a slot of a struct-of-arrays store: the clientId and connectionId are interned and shared by all the members that have them, the msgSerial and index of the id, the timestamp and the action are kept as scalars, the id string is only kept when it can't be rebuilt from its parts, and the payload is referenced as it was received. `ARTPresenceMessage` objects are materialized when they are asked for.
+
+ Slots are reused once their member has been removed, so a slot only identifies a member while it is in the store.
+ */
+@interface ARTPresenceMemberStore : NSObject <NSCopying>
+
+/// The number of members in the store.
+@property (nonatomic, readonly) NSUInteger count;
+
+/// The slots of all the members in the store.
+@property (nonatomic, readonly) NSIndexSet *slots;
+
+/// Returns the slot of the member with the given clientId and connectionId, or `NSNotFound`.
+- (NSUInteger)slotOfMemberWithClientId:(nullable NSString *)clientId connectionId:(nullable NSString *)connectionId;
+
+/// Returns the slots of the members with the given clientId.
+- (NSIndexSet *)slotsOfMembersWithClientId:(NSString *)clientId;
+
+/// Returns the slots of the members with the given connectionId.
+- (NSIndexSet *)slotsOfMembersWithConnectionId:(NSString *)connectionId;
+
+/// Stores `message` in the slot of its member, allocating one if the member isn't in the store yet, and returns that slot.
+- (NSUInteger)setMember:(ARTPresenceMessage *)message;
+
+- (void)removeMemberAtSlot:(NSUInteger)slot;
+
+- (ARTPresenceAction)actionAtSlot:(NSUInteger)slot;
+
+/// Whether `message` is newer than the member at `slot` (RTP2b), compared from the stored parts of the member rather than a materialized one.
+- (BOOL)isMessage:(ARTPresenceMessage *)message newerThanMemberAtSlot:(NSUInteger)slot;
+
+/// Materializes the member at `slot`. Every call returns a new object.
+- (ARTPresenceMessage *)memberAtSlot:(NSUInteger)slot;
+
+/// Materializes the members at `slots`.
+- (NSArray<ARTPresenceMessage *> *)membersAtSlots:(NSIndexSet *)slots;
+
+/// Materializes all the members, keyed by their memberKey.
+- (NSDictionary<NSString *, ARTPresenceMessage *> *)membersByKey;
+
+@end
+
+NS_ASSUME_NONNULL_END
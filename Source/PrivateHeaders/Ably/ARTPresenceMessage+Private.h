@@ -9,8 +9,35 @@
  */
 - (BOOL)isSynthesized;
 
-- (NSArray<NSString *> *)parseId;
+/**
+ The `msgSerial` and `index` parts of the `connectionId:msgSerial:index` id, which is parsed once when `id` is set. Raise an exception if the id doesn't have this format.
+ */
 - (NSInteger)msgSerialFromId;
 - (NSInteger)indexFromId;
 
+/**
+ Whether `id` is `nil` or has the `connectionId:msgSerial:index` format, so that `isSynthesized`, `msgSerialFromId` and `indexFromId` don't raise.
+ */
+- (BOOL)hasParsableId;
+
+/**
+ Whether this message is newer than a member with the given parts (RTP2b), so that members kept in compact form can be compared without being materialized. `latestTimestamp` is NAN if the member has no timestamp, and `latestMsgSerial` and `latestIndex` are ignored if it's synthesized.
+ */
+- (BOOL)isNewerThanMemberSynthesized:(BOOL)latestIsSynthesized timestamp:(NSTimeInterval)latestTimestamp msgSerial:(NSInteger)latestMsgSerial index:(NSInteger)latestIndex;
+
+/**
+ Whether `id` is exactly `connectionId:msgSerial:index`, with no sign or leading zeros, so that it can be rebuilt from those parts.
+ */
+- (BOOL)hasCanonicalId;
+
+/**
+ Sets `id` to `connectionId:msgSerial:index`, without parsing it back. `connectionId` must be set first.
+ */
+- (void)setCanonicalIdWithMsgSerial:(NSInteger)msgSerial index:(NSInteger)index;
+
+/**
+ Folds the messages of each member into their net effect, in the order in which each member first appears: a member that wasn't present before its first message and isn't after its last one is dropped, one that becomes present is an ENTER, one that stays present is its last message (as an UPDATE if that was an ENTER), and one that stops being present is its last message. Messages whose action changes are copied.
+ */
++ (NSArray<ARTPresenceMessage *> *)netPresenceOfMessages:(NSArray<ARTPresenceMessage *> *)messages NS_SWIFT_NAME(netPresence(ofMessages:));
+
 @end
@@ -0,0 +1,24 @@
+#import <Ably/ARTPresenceSnapshot.h>
+
+@class ARTPresenceMemberStore;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface ARTPresenceSnapshot ()
+
+/// `store` must not be mutated afterwards; `ARTPresenceMap` copies its store before the next change instead.
+- (instancetype)initWithStore:(ARTPresenceMemberStore *)store version:(NSUInteger)version;
+
+@end
+
+@interface ARTPresenceChanges ()
+
+- (instancetype)initFromVersion:(NSUInteger)fromVersion
+                      toVersion:(NSUInteger)toVersion
+                        entered:(NSArray<ARTPresenceMessage *> *)entered
+                        updated:(NSArray<ARTPresenceMessage *> *)updated
+                           left:(NSArray<ARTPresenceMessage *> *)left;
+
+@end
+
+NS_ASSUME_NONNULL_END
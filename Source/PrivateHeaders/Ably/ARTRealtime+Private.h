@@ -15,6 +15,7 @@
 @class ARTProtocolMessage;
 @class ARTConnectionInternal;
 @class ARTRealtimeChannelsInternal;
+@class ARTAttachScheduler;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -46,6 +47,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (readonly, nonatomic) ARTEventEmitter<ARTEvent *, ARTConnectionStateChange *> *internalEventEmitter;
 @property (readonly, nonatomic) ARTEventEmitter<ARTEvent *, NSNull *> *connectedEventEmitter;
+/// Paces the sending of the channels' ATTACH messages, see `ARTClientOptions.maxConcurrentAttaches`.
+@property (readonly, nonatomic) ARTAttachScheduler *attachScheduler;
 
 @property (readonly, nonatomic) NSMutableArray<void (^)(ARTRealtimeConnectionState, ARTErrorInfo *_Nullable)> *pendingAuthorizations;
 
@@ -109,6 +112,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 // Message sending
 - (void)send:(ARTProtocolMessage *)msg sentCallback:(nullable ARTCallback)sentCallback ackCallback:(nullable ARTStatusCallback)ackCallback;
+/// Whether messages for the channel are queued, or sent and waiting to be acknowledged.
+- (BOOL)hasPendingMessagesForChannel:(NSString *)channelName;
 
 @end
 
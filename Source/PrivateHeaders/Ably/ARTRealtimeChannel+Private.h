@@ -33,6 +33,13 @@ NS_ASSUME_NONNULL_BEGIN
 - (ARTErrorInfo *)errorReason_nosync;
 - (NSString * _Nullable)clientId_nosync;
 - (BOOL)canBeReattached;
+/// Whether the app has stopped using the channel as far as an `ARTChannelEvictionPolicy` is concerned: it holds no `ARTRealtimeChannel` for it, and it has no listeners, no pending publishes and no presence members entered.
+- (BOOL)isEvictable_nosync;
+/// Counts the `ARTRealtimeChannel` objects for the channel; can be called on any thread.
+- (void)publicHandleDidInit;
+- (void)publicHandleDidDealloc;
+/// A rough estimate of the memory used by the channel, for `ARTChannelEvictionPolicy.maxBytes`.
+- (NSUInteger)estimatedSize_nosync;
 
 @property (readonly, weak, nonatomic) ARTRealtimeInternal *realtime; // weak because realtime owns self
 @property (readonly, nonatomic) ARTRestChannelInternal *restChannel;
@@ -43,6 +50,8 @@ NS_ASSUME_NONNULL_BEGIN
 @property (readonly, nonatomic) ARTEventEmitter<id<ARTEventIdentification>, ARTMessage *> *messagesEventEmitter;
 
 @property (readonly, nonatomic) ARTEventEmitter<ARTEvent *, ARTPresenceMessage *> *presenceEventEmitter;
+/// Emits the net presence messages of each presence frame or sync page, for `subscribeToBatches:` listeners.
+@property (readonly, nonatomic) ARTEventEmitter<ARTEvent *, NSArray<ARTPresenceMessage *> *> *presenceBatchEventEmitter;
 @property (readwrite, nonatomic) ARTPresenceMap *presenceMap;
 @property (readwrite, nonatomic) BOOL attachResume;
 
@@ -55,6 +64,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)_attach:(nullable ARTCallback)callback;
 - (void)_detach:(nullable ARTCallback)callback;
 
+/// `subscribeWithAttachCallback:callback:`, on the internal queue: the callbacks are called on it too.
+- (nullable ARTEventListener *)_subscribeWithAttachCallback:(nullable ARTCallback)onAttach callback:(nullable ARTMessageCallback)callback;
+
 - (void)_unsubscribe;
 - (void)off_nosync;
 
@@ -67,6 +79,12 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)transition:(ARTRealtimeChannelState)state withMetadata:(ARTChannelStateChangeMetadata *)metadata;
 
 - (void)onChannelMessage:(ARTProtocolMessage *)message;
+
+/// Processes what is left of the channel messages that are being processed a slice at a time, and of the ones received since, all at once.
+- (void)processInboundBacklog;
+
+/// Drops what is left of the channel messages that are being processed a slice at a time, and the ones received since.
+- (void)discardInboundBacklog;
 - (void)publishProtocolMessage:(ARTProtocolMessage *)pm callback:(ARTStatusCallback)cb;
 
 - (void)setAttached:(ARTProtocolMessage *)message;
@@ -82,6 +100,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)throwOnDisconnectedOrFailed;
 
 - (void)broadcastPresence:(ARTPresenceMessage *)pm;
+
+/// The maximum size of the messages of a single ProtocolMessage, as negotiated with the connection (TO3l8).
+- (NSInteger)maxMessageSize;
 - (void)detachChannel:(ARTChannelStateChangeMetadata *)metadata;
 
 - (void)sync;
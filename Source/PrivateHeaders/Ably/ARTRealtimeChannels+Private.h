@@ -15,13 +15,21 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (ARTRealtimeChannelInternal *)get:(NSString *)name;
 - (ARTRealtimeChannelInternal *)get:(NSString *)name options:(ARTRealtimeChannelOptions *)options;
+- (NSArray<ARTRealtimeChannelInternal *> *)getAll:(NSArray<NSString *> *)names options:(nullable ARTRealtimeChannelOptions *)options;
+- (NSDictionary<NSString *, ARTEventListener *> *)subscribeAll:(NSArray<NSString *> *)names options:(nullable ARTRealtimeChannelOptions *)options onAttach:(nullable ARTChannelsAttachCallback)onAttach callback:(ARTChannelMessageCallback)callback;
 - (id<NSFastEnumeration>)copyIntoIteratorWithMapper:(ARTRealtimeChannel *(^)(ARTRealtimeChannelInternal *))mapper;
 
+@property (readonly, nonatomic) ARTChannelEvictionStats *evictionStats;
+- (ARTEventListener *)onEviction:(ARTChannelEvictionCallback)callback;
+- (void)offEviction:(ARTEventListener *)listener;
+
 - (instancetype)initWithRealtime:(ARTRealtimeInternal *)realtime logger:(ARTInternalLog *)logger;
 
 @property (readonly, getter=getNosyncIterable) id<NSFastEnumeration> nosyncIterable;
 @property (nonatomic, readonly, getter=getCollection) NSMutableDictionary<NSString *, ARTRealtimeChannelInternal *> *collection;
 - (ARTRealtimeChannelInternal *)_getChannel:(NSString *)name options:(ARTChannelOptions * _Nullable)options addPrefix:(BOOL)addPrefix;
+/// Called when the app publishes, subscribes or attaches on `channel`, which counts as using it for `ARTClientOptions.channelEvictionPolicy`.
+- (void)channelWasUsed_nosync:(ARTRealtimeChannelInternal *)channel;
 
 @property (nonatomic) dispatch_queue_t queue;
 
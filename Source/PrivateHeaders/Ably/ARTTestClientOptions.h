@@ -43,6 +43,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) id<ARTJitterCoefficientGenerator> jitterCoefficientGenerator;
 
+/**
+ The maximum number of messages or presence messages of a channel message that are processed in one go on the internal queue. The rest of a larger channel message is processed later, in order, so that other work can run in between. Initial value is `ARTDefault.channelMessageSliceSize`.
+ */
+@property (nonatomic) NSUInteger channelMessageSliceSize;
+
 @end
 
 NS_ASSUME_NONNULL_END
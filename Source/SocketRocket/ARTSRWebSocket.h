@@ -40,6 +40,7 @@ typedef NS_ENUM(NSInteger, ARTSRStatusCode) {
 
 @class ARTSRWebSocket;
 @class ARTSRSecurityPolicy;
+@class ARTSRPerMessageDeflateOptions;
 @class ARTInternalLog;
 
 /**
@@ -106,6 +107,19 @@ extern NSString *const ARTSRHTTPResponseErrorKey;
  */
 @property (nullable, nonatomic, copy) NSArray<NSHTTPCookie *> *requestCookies;
 
+/**
+ The parameters of the permessage-deflate extension to offer to the server, or `nil` to send and receive messages uncompressed.
+ Must be set before the socket is opened. Default: `nil`.
+ */
+@property (nullable, nonatomic, copy) ARTSRPerMessageDeflateOptions *perMessageDeflateOptions;
+
+/**
+ The longest payload of an outbound data frame, or 0 to send every message in a single frame.
+ Longer messages are sent in several frames, written as the socket drains, so that the pings and pongs sent meanwhile go out in between the fragments rather than after the whole message. The messages sent meanwhile still follow the whole message. The close frame follows the rest of a message already partly written, and the messages still waiting to be sent are dropped when the socket closes.
+ Must be set before the socket is opened. Default: 0.
+ */
+@property (nonatomic) NSUInteger maximumFragmentLength;
+
 /**
  The negotiated web socket protocol or `nil` if handshake did not yet complete.
  */
@@ -117,6 +131,13 @@ extern NSString *const ARTSRHTTPResponseErrorKey;
  */
 @property (nonatomic, readonly) BOOL allowsUntrustedSSLCertificates;
 
+/**
+ The number of frames sent so far, and the number of writes to the socket that they took. Frames sent in quick succession are written together, so that the average number of frames per write shows how much they were batched.
+ These properties are fully thread-safe.
+ */
+@property (atomic, readonly) NSUInteger sentFrameCount;
+@property (atomic, readonly) NSUInteger socketWriteCount;
+
 ///--------------------------------------
 #pragma mark - Constructors
 ///--------------------------------------
@@ -229,6 +250,14 @@ extern NSString *const ARTSRHTTPResponseErrorKey;
  */
 - (void)unscheduleFromRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode NS_SWIFT_NAME(unschedule(from:forMode:));
 
+/**
+ Schedules the receiver on its own work queue rather than on a run loop: the events of its streams are delivered by GCD straight on the queue where the socket handles them, without a hop from the thread of `+[NSRunLoop ARTSR_networkRunLoop]`.
+ Must be called before the socket is opened, and instead of `scheduleInRunLoop:forMode:`.
+
+ @param targetQueue The queue that the work queue runs on, such as one of the queues of an `ARTSRWorkQueuePool` to spread many sockets across a fixed number of threads, or `nil` for a global queue.
+ */
+- (void)scheduleOnTargetQueue:(nullable dispatch_queue_t)targetQueue NS_SWIFT_NAME(schedule(onTargetQueue:));
+
 ///--------------------------------------
 #pragma mark - Open / Close
 ///--------------------------------------
@@ -11,14 +11,6 @@
 
 #import "ARTSRWebSocket.h"
 
-#if __has_include(<unicode/utf8.h>)
-#define HAS_ICU
-#endif
-
-#ifdef HAS_ICU
-#import <unicode/utf8.h>
-#endif
-
 #import <libkern/OSAtomic.h>
 @import Darwin.os.lock;
 
@@ -37,6 +29,9 @@
 #import "ARTSRLog.h"
 #import "ARTSRMutex.h"
 #import "ARTSRSIMDHelpers.h"
+#import "ARTSRBufferPool.h"
+#import "ARTSRReadBuffer.h"
+#import "ARTSRPerMessageDeflate.h"
 #import "NSURLRequest+ARTSRWebSocketPrivate.h"
 #import "NSRunLoop+ARTSRWebSocketPrivate.h"
 #import "ARTSRConstants.h"
@@ -53,7 +48,7 @@ __attribute__((used)) static void importCategories(void)
 
 typedef struct {
     BOOL fin;
-    //  BOOL rsv1;
+    BOOL rsv1; // Set on the first frame of a compressed message.
     //  BOOL rsv2;
     //  BOOL rsv3;
     uint8_t opcode;
@@ -61,19 +56,52 @@ typedef struct {
     uint64_t payload_length;
 } frame_header;
 
-static NSString *const ARTSRWebSocketAppendToSecKeyString = @"258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+// Where the frame parser is in the frame it's reading.
+typedef NS_ENUM(uint8_t, ARTSRFrameReadState) {
+    ARTSRFrameReadStateNone, // Not reading frames: the handshake hasn't finished, or the connection failed.
+    ARTSRFrameReadStateHeader,
+    ARTSRFrameReadStatePayload,
+};
 
-static inline int32_t validate_dispatch_data_partial_string(NSData *data);
+static NSString *const ARTSRWebSocketAppendToSecKeyString = @"258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
 
 static uint8_t const ARTSRWebSocketProtocolVersion = 13;
 
 NSString *const ARTSRWebSocketErrorDomain = @"ARTSRWebSocketErrorDomain";
 NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
 
+// A data message that waits to be written a fragment at a time, or the close frame that waits for the rest of one.
+@interface ARTSRPendingMessage : NSObject
+
+@property (nonatomic, readonly) ARTSROpCode opCode;
+@property (nonatomic, readonly) NSData *payload;
+@property (nonatomic, readonly) BOOL compressed;
+
+@end
+
+@implementation ARTSRPendingMessage
+
+- (instancetype)initWithOpCode:(ARTSROpCode)opCode payload:(NSData *)payload compressed:(BOOL)compressed
+{
+    self = [super init];
+    if (!self) return self;
+
+    _opCode = opCode;
+    _payload = payload;
+    _compressed = compressed;
+
+    return self;
+}
+
+@end
+
 @interface ARTSRWebSocket ()  <NSStreamDelegate>
 
 @property (atomic, readwrite) ARTWebSocketReadyState readyState;
 
+@property (atomic, readwrite) NSUInteger sentFrameCount;
+@property (atomic, readwrite) NSUInteger socketWriteCount;
+
 // Specifies whether SSL trust chain should NOT be evaluated.
 // By default this flag is set to NO, meaning only secure SSL connections are allowed.
 // For DEBUG builds this flag is ignored, and SSL connections are allowed regardless
@@ -96,17 +124,42 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
     NSInputStream *_inputStream;
     NSOutputStream *_outputStream;
 
-    dispatch_data_t _readBuffer;
-    NSUInteger _readBufferOffset;
+    ARTSRReadBuffer *_readBuffer;
 
     dispatch_data_t _outputBuffer;
     NSUInteger _outputBufferOffset;
 
+    // The buffers that outbound frames are written into, and that inbound bytes are read into.
+    ARTSRBufferPool *_bufferPool;
+
+    // Outbound frames are written one after the other into the corked buffer, which joins the output chain at the next flush point,
+    // so that the frames sent within a turn of the work queue go out in one write.
+    uint8_t *_corkedBuffer;
+    size_t _corkedBufferCapacity;
+    size_t _corkedBufferLength;
+    NSUInteger _corkedFrameCount;
+    BOOL _flushScheduled;
+
+    // Data messages longer than `maximumFragmentLength`, and the messages and close frame sent after them, wait here to be written
+    // a fragment at a time as the output chain drains, while control frames are written straight away, in between the fragments.
+    NSMutableArray<ARTSRPendingMessage *> *_pendingMessages;
+    size_t _pendingMessageOffset; // The length of the first pending message already written.
+
+    ARTSRFrameReadState _frameReadState;
+    frame_header _currentFrameHeader;
+    uint64_t _currentFramePayloadRemaining;
+    // Whether the current frame is a control frame or a message in a single frame, which is handled as a slice of the read buffer.
+    BOOL _currentFrameIsWholeMessage;
+
+    // The data message being read, made of one or more frames.
     uint8_t _currentFrameOpcode;
     size_t _currentFrameCount;
-    size_t _readOpCount;
-    uint32_t _currentStringScanPosition;
-    NSMutableData *_currentFrameData;
+    ARTSRUTF8Validation _currentTextValidation; // Validates the frames of a text message as they arrive.
+    NSMutableData *_currentFrameData; // Only used by messages in several frames.
+    BOOL _currentMessageIsCompressed;
+
+    // Set once the handshake negotiated the permessage-deflate extension.
+    ARTSRPerMessageDeflate *_perMessageDeflate;
 
     NSString *_closeReason;
 
@@ -116,9 +169,6 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
     BOOL _requestRequiresSSL;
     BOOL _streamSecurityValidated;
 
-    uint8_t _currentReadMaskKey[4];
-    size_t _currentReadMaskOffset;
-
     BOOL _closeWhenFinishedWriting;
     BOOL _failed;
 
@@ -132,6 +182,7 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
     BOOL _isPumping;
 
     NSMutableSet<NSArray *> *_scheduledRunloops; // Set<[RunLoop, Mode]>. TODO: (nlutsenko) Fix clowntown
+    BOOL _deliversStreamEventsOnWorkQueue; // Instead of on the run loops, see `scheduleOnTargetQueue:`.
 
     // We use this to retain ourselves.
     __strong ARTSRWebSocket *_selfRetain;
@@ -173,10 +224,10 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
 
     _delegateController = [[ARTSRDelegateController alloc] init];
 
-    _readBuffer = dispatch_data_empty;
+    _bufferPool = [[ARTSRBufferPool alloc] init];
+    _readBuffer = [[ARTSRReadBuffer alloc] initWithBufferPool:_bufferPool queue:_workQueue];
     _outputBuffer = dispatch_data_empty;
-
-    _currentFrameData = [[NSMutableData alloc] init];
+    _pendingMessages = [[NSMutableArray alloc] init];
 
     _consumers = [[NSMutableArray alloc] init];
 
@@ -271,6 +322,10 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
         _receivedHTTPHeaders = NULL;
     }
 
+    if (_corkedBuffer) {
+        [_bufferPool relinquishBuffer:_corkedBuffer capacity:_corkedBufferCapacity];
+    }
+
     ARTSRMutexDestroy(_kvoLock);
 }
 
@@ -351,7 +406,10 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
         _outputStream.delegate = self;
         [self _updateSecureStreamOptions];
 
-        if (!_scheduledRunloops.count) {
+        if (_deliversStreamEventsOnWorkQueue) {
+            CFReadStreamSetDispatchQueue((__bridge CFReadStreamRef)_inputStream, _workQueue);
+            CFWriteStreamSetDispatchQueue((__bridge CFWriteStreamRef)_outputStream, _workQueue);
+        } else if (!_scheduledRunloops.count) {
             [self scheduleInRunLoop:[NSRunLoop ARTSR_networkRunLoop] forMode:NSDefaultRunLoopMode];
         }
 
@@ -414,6 +472,22 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
         _protocol = negotiatedProtocol;
     }
 
+    NSString *negotiatedExtensions = CFBridgingRelease(CFHTTPMessageCopyHeaderFieldValue(_receivedHTTPHeaders, CFSTR("Sec-WebSocket-Extensions")));
+    if (negotiatedExtensions) {
+        if (!_perMessageDeflateOptions) {
+            NSError *error = ARTSRErrorWithCodeDescription(2133, @"Server specified Sec-WebSocket-Extensions that weren't requested.");
+            [self _failWithError:error];
+            return;
+        }
+        NSError *error = nil;
+        _perMessageDeflate = [[ARTSRPerMessageDeflate alloc] initWithOptions:_perMessageDeflateOptions negotiatedExtensions:negotiatedExtensions error:&error];
+        if (!_perMessageDeflate) {
+            [self _failWithError:error];
+            return;
+        }
+        ARTSRDebugLog(self.logger, @"Negotiated %@", negotiatedExtensions);
+    }
+
     self.readyState = ARTWebSocketReadyStateOpen;
 
     if (!_didFail) {
@@ -458,6 +532,9 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
                                                           ARTSRWebSocketProtocolVersion,
                                                           self.requestCookies,
                                                           _requestedProtocols);
+    if (_perMessageDeflateOptions) {
+        CFHTTPMessageSetHeaderFieldValue(message, CFSTR("Sec-WebSocket-Extensions"), (__bridge CFStringRef)_perMessageDeflateOptions.extensionOffer);
+    }
 
     NSData *messageData = CFBridgingRelease(CFHTTPMessageCopySerializedMessage(message));
 
@@ -490,6 +567,17 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
     [_scheduledRunloops addObject:@[aRunLoop, mode]];
 }
 
+- (void)scheduleOnTargetQueue:(nullable dispatch_queue_t)targetQueue
+{
+    NSAssert(_scheduledRunloops.count == 0, @"A web socket can't be scheduled both in run loops and on a dispatch queue.");
+
+    // Nothing has run on the work queue yet, so its target can still be changed.
+    if (targetQueue) {
+        dispatch_set_target_queue(_workQueue, targetQueue);
+    }
+    _deliversStreamEventsOnWorkQueue = YES;
+}
+
 - (void)unscheduleFromRunLoop:(NSRunLoop *)aRunLoop forMode:(NSString *)mode;
 {
     [_outputStream removeFromRunLoop:aRunLoop forMode:mode];
@@ -589,6 +677,8 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
         return;
     }
 
+    [self _uncorkFrames];
+
     __block NSData *strongData = data;
     dispatch_data_t newData = dispatch_data_create(data.bytes, data.length, nil, ^{
         strongData = nil;
@@ -597,6 +687,70 @@ NSString *const ARTSRHTTPResponseErrorKey = @"HTTPResponseStatusCode";
     [self _pumpWriting];
 }
 
+// The frames sent within a turn of the work queue fill a buffer of this size before a new one is started, which matches the size of a TLS record.
+static const size_t ARTSRCorkedBufferMinCapacity = 16 * 1024;
+
+// Returns where to write a frame of at most `maxLength` bytes, at the end of the corked buffer, which is started or replaced if it doesn't have the room.
+- (nullable uint8_t *)_corkedSpaceForFrameWithMaxLength:(size_t)maxLength
+{
+    if (_corkedBuffer && _corkedBufferCapacity - _corkedBufferLength >= maxLength) {
+        return _corkedBuffer + _corkedBufferLength;
+    }
+    [self _uncorkFrames];
+
+    _corkedBuffer = [_bufferPool bufferWithCapacity:MAX(maxLength, ARTSRCorkedBufferMinCapacity) actualCapacity:&_corkedBufferCapacity];
+    if (!_corkedBuffer) {
+        _corkedBufferCapacity = 0;
+    }
+    return _corkedBuffer;
+}
+
+// Records a frame written at the space returned by `_corkedSpaceForFrameWithMaxLength:`, and makes sure it's written at the end of this turn of the work queue at the latest.
+- (void)_didCorkFrameOfLength:(size_t)length
+{
+    assert(_corkedBufferLength + length <= _corkedBufferCapacity);
+    _corkedBufferLength += length;
+    _corkedFrameCount += 1;
+
+    if (!_flushScheduled) {
+        _flushScheduled = YES;
+        // The flush is queued behind the sends already waiting on the work queue, whose frames join this one.
+        dispatch_async(_workQueue, ^{
+            self->_flushScheduled = NO;
+            [self _pumpWriting];
+        });
+    }
+}
+
+// Appends the corked frames to the output chain without copying them, and gives their buffer back to the pool once it's been written.
+- (void)_uncorkFrames
+{
+    [self assertOnWorkQueue];
+
+    if (!_corkedBuffer) {
+        return;
+    }
+
+    uint8_t *const buffer = _corkedBuffer;
+    const size_t capacity = _corkedBufferCapacity;
+    ARTSRBufferPool *const pool = _bufferPool;
+    if (_corkedBufferLength == 0) {
+        [pool relinquishBuffer:buffer capacity:capacity];
+    } else {
+        // The destructor runs on the work queue, which is the only one the pool is used on.
+        dispatch_data_t newData = dispatch_data_create(buffer, _corkedBufferLength, _workQueue, ^{
+            [pool relinquishBuffer:buffer capacity:capacity];
+        });
+        _outputBuffer = dispatch_data_create_concat(_outputBuffer, newData);
+        self.sentFrameCount += _corkedFrameCount;
+    }
+
+    _corkedBuffer = NULL;
+    _corkedBufferCapacity = 0;
+    _corkedBufferLength = 0;
+    _corkedFrameCount = 0;
+}
+
 - (void)send:(nullable id)message
 {
     if (!message) {
@@ -774,37 +928,35 @@ static inline BOOL closeCodeIsValid(int closeCode) {
 {
     [self assertOnWorkQueue];
     ARTSRDebugLog(self.logger, @"Trying to disconnect");
+
+    // What is left of the data waiting to be fragmented is dropped, but a close frame waiting behind it is still written, as control frames may come in between fragments.
+    ARTSRPendingMessage *const pendingClose = _pendingMessages.lastObject.opCode == ARTSROpCodeConnectionClose ? _pendingMessages.lastObject : nil;
+    [_pendingMessages removeAllObjects];
+    _pendingMessageOffset = 0;
+    if (pendingClose) {
+        [self _writeFrameWithOpcode:ARTSROpCodeConnectionClose fin:YES compressed:NO bytes:(const uint8_t *)pendingClose.payload.bytes length:pendingClose.payload.length];
+    }
+
     _closeWhenFinishedWriting = YES;
     [self _pumpWriting];
 }
 
 - (void)_handleFrameWithData:(NSData *)frameData opCode:(ARTSROpCode)opcode
 {
-    // Check that the current data is valid UTF8
-
     BOOL isControlFrame = (opcode == ARTSROpCodePing || opcode == ARTSROpCodePong || opcode == ARTSROpCodeConnectionClose);
     if (isControlFrame) {
         //frameData will be copied before passing to handlers
         //otherwise there can be misbehaviours when value at the pointer is changed
         frameData = [frameData copy];
 
-        dispatch_async(_workQueue, ^{
-            [self _readFrameContinue];
-        });
+        [self _readFrameContinue];
     } else {
         [self _readFrameNew];
     }
 
     switch (opcode) {
         case ARTSROpCodeTextFrame: {
-            NSString *string = [[NSString alloc] initWithData:frameData encoding:NSUTF8StringEncoding];
-            if (!string && frameData) {
-                [self closeWithCode:ARTSRStatusCodeInvalidUTF8 reason:@"Text frames must be valid UTF-8."];
-                dispatch_async(_workQueue, ^{
-                    [self closeConnection];
-                });
-                return;
-            }
+            // The frame reader has already validated the UTF-8, so the string is only created if the delegate wants one.
             ARTSRDebugLog(self.logger, @"Received text message.");
             [self.delegateController performDelegateBlock:^(id<ARTWebSocketDelegate>  _Nullable delegate, ARTSRDelegateAvailableMethods availableMethods) {
                 // Don't convert into string - iff `delegate` tells us not to. Otherwise - create UTF8 string and handle that.
@@ -816,6 +968,7 @@ static inline BOOL closeCodeIsValid(int closeCode) {
                         [delegate webSocket:self didReceiveMessageWithData:frameData];
                     }
                 } else {
+                    NSString *string = [[NSString alloc] initWithData:frameData encoding:NSUTF8StringEncoding];
                     if (availableMethods.didReceiveMessage) {
                         [delegate webSocket:self didReceiveMessage:string];
                     }
@@ -854,60 +1007,6 @@ static inline BOOL closeCodeIsValid(int closeCode) {
     }
 }
 
-- (void)_handleFrameHeader:(frame_header)frame_header curData:(NSData *)curData;
-{
-    assert(frame_header.opcode != 0);
-
-    if (self.readyState == ARTWebSocketReadyStateClosed) {
-        return;
-    }
-
-
-    BOOL isControlFrame = (frame_header.opcode == ARTSROpCodePing || frame_header.opcode == ARTSROpCodePong || frame_header.opcode == ARTSROpCodeConnectionClose);
-
-    if (isControlFrame && !frame_header.fin) {
-        [self _closeWithProtocolError:@"Fragmented control frames not allowed"];
-        return;
-    }
-
-    if (isControlFrame && frame_header.payload_length >= 126) {
-        [self _closeWithProtocolError:@"Control frames cannot have payloads larger than 126 bytes"];
-        return;
-    }
-
-    if (!isControlFrame) {
-        _currentFrameOpcode = frame_header.opcode;
-        _currentFrameCount += 1;
-    }
-
-    if (frame_header.payload_length == 0) {
-        if (isControlFrame) {
-            [self _handleFrameWithData:curData opCode:frame_header.opcode];
-        } else {
-            if (frame_header.fin) {
-                [self _handleFrameWithData:_currentFrameData opCode:frame_header.opcode];
-            } else {
-                // TODO add assert that opcode is not a control;
-                [self _readFrameContinue];
-            }
-        }
-    } else {
-        assert(frame_header.payload_length <= SIZE_T_MAX);
-        [self _addConsumerWithDataLength:(size_t)frame_header.payload_length callback:^(ARTSRWebSocket *sself, NSData *newData) {
-            if (isControlFrame) {
-                [sself _handleFrameWithData:newData opCode:frame_header.opcode];
-            } else {
-                if (frame_header.fin) {
-                    [sself _handleFrameWithData:sself->_currentFrameData opCode:frame_header.opcode];
-                } else {
-                    // TODO add assert that opcode is not a control;
-                    [sself _readFrameContinue];
-                }
-            }
-        } readToCurrentFrame:!isControlFrame unmaskBytes:frame_header.masked];
-    }
-}
-
 /* From RFC:
 
  0                   1                   2                   3
@@ -933,127 +1032,284 @@ static inline BOOL closeCodeIsValid(int closeCode) {
 static const uint8_t ARTSRFinMask          = 0x80;
 static const uint8_t ARTSROpCodeMask       = 0x0F;
 static const uint8_t ARTSRRsvMask          = 0x70;
+static const uint8_t ARTSRRsv1Mask         = 0x40;
 static const uint8_t ARTSRMaskMask         = 0x80;
 static const uint8_t ARTSRPayloadLenMask   = 0x7F;
 
+// The most the read buffer reserves up front for a frame's payload, whatever length the peer declares; a longer payload grows the buffer as it arrives.
+static size_t ARTSRMaximumPayloadReservation(void) {
+    return ARTSRDefaultBufferSize() * 16;
+}
+
+// The frame parser reads from the read buffer in place, one step at a time, driven by `_pumpScanner`.
+// Handling a frame sets the parser up for the next one, so that the pump carries on without allocating anything per frame.
 
 - (void)_readFrameContinue;
 {
     assert((_currentFrameCount == 0 && _currentFrameOpcode == 0) || (_currentFrameCount > 0 && _currentFrameOpcode > 0));
 
-    [self _addConsumerWithDataLength:2 callback:^(ARTSRWebSocket *sself, NSData *data) {
-        __block frame_header header = {0};
+    _frameReadState = ARTSRFrameReadStateHeader;
+}
 
-        const uint8_t *headerBuffer = data.bytes;
-        assert(data.length >= 2);
+- (void)_readFrameNew;
+{
+    // Drop the data rather than reset its length, since Apple doesn't guarantee that this will free the memory (and in tests on
+    // some platforms, it doesn't seem to, effectively causing a leak the size of the biggest frame so far).
+    _currentFrameData = nil;
 
-        if (headerBuffer[0] & ARTSRRsvMask) {
-            [sself _closeWithProtocolError:@"Server used RSV bits"];
-            return;
-        }
+    _currentFrameOpcode = 0;
+    _currentFrameCount = 0;
+    _currentMessageIsCompressed = NO;
+    ARTSRUTF8ValidationReset(&_currentTextValidation);
 
-        uint8_t receivedOpcode = (ARTSROpCodeMask & headerBuffer[0]);
+    [self _readFrameContinue];
+}
 
-        BOOL isControlFrame = (receivedOpcode == ARTSROpCodePing || receivedOpcode == ARTSROpCodePong || receivedOpcode == ARTSROpCodeConnectionClose);
+- (void)_stopReadingFramesWithProtocolError:(NSString *)message
+{
+    _frameReadState = ARTSRFrameReadStateNone;
+    [self _closeWithProtocolError:message];
+}
 
-        if (!isControlFrame && receivedOpcode != 0 && sself->_currentFrameCount > 0) {
-            [sself _closeWithProtocolError:@"all data frames after the initial data frame must have opcode 0"];
-            return;
-        }
+- (void)_stopReadingFramesWithInvalidUTF8
+{
+    _frameReadState = ARTSRFrameReadStateNone;
+    [self closeWithCode:ARTSRStatusCodeInvalidUTF8 reason:@"Text frames must be valid UTF-8"];
+    dispatch_async(_workQueue, ^{
+        [self closeConnection];
+    });
+}
 
-        if (receivedOpcode == 0 && sself->_currentFrameCount == 0) {
-            [sself _closeWithProtocolError:@"cannot continue a message"];
-            return;
-        }
+// Returns true if did work
+- (BOOL)_readFrame
+{
+    switch (_frameReadState) {
+        case ARTSRFrameReadStateNone:
+            return NO;
+        case ARTSRFrameReadStateHeader:
+            return [self _readFrameHeader];
+        case ARTSRFrameReadStatePayload:
+            return [self _readFramePayload];
+    }
+    return NO;
+}
 
-        header.opcode = receivedOpcode == 0 ? sself->_currentFrameOpcode : receivedOpcode;
+- (BOOL)_readFrameHeader
+{
+    const size_t availableLength = _readBuffer.length;
+    if (availableLength < 2) {
+        return NO;
+    }
 
-        header.fin = !!(ARTSRFinMask & headerBuffer[0]);
+    const uint8_t *headerBuffer = _readBuffer.bytes;
+    frame_header header = {0};
 
+    uint8_t receivedOpcode = (ARTSROpCodeMask & headerBuffer[0]);
 
-        header.masked = !!(ARTSRMaskMask & headerBuffer[1]);
-        header.payload_length = ARTSRPayloadLenMask & headerBuffer[1];
+    BOOL isControlFrame = (receivedOpcode == ARTSROpCodePing || receivedOpcode == ARTSROpCodePong || receivedOpcode == ARTSROpCodeConnectionClose);
 
-        headerBuffer = NULL;
+    // permessage-deflate marks a compressed message with RSV1 on its first frame; no other use of the RSV bits was negotiated.
+    header.rsv1 = !!(ARTSRRsv1Mask & headerBuffer[0]);
+    const BOOL rsv1Allowed = _perMessageDeflate && !isControlFrame && receivedOpcode != 0;
+    if ((headerBuffer[0] & ARTSRRsvMask & ~ARTSRRsv1Mask) || (header.rsv1 && !rsv1Allowed)) {
+        [self _stopReadingFramesWithProtocolError:@"Server used RSV bits"];
+        return NO;
+    }
 
-        if (header.masked) {
-            [sself _closeWithProtocolError:@"Client must receive unmasked data"];
-            return;
-        }
+    if (!isControlFrame && receivedOpcode != 0 && _currentFrameCount > 0) {
+        [self _stopReadingFramesWithProtocolError:@"all data frames after the initial data frame must have opcode 0"];
+        return NO;
+    }
 
-        size_t extra_bytes_needed = header.masked ? sizeof(self->_currentReadMaskKey) : 0;
+    if (receivedOpcode == 0 && _currentFrameCount == 0) {
+        [self _stopReadingFramesWithProtocolError:@"cannot continue a message"];
+        return NO;
+    }
 
-        if (header.payload_length == 126) {
-            extra_bytes_needed += sizeof(uint16_t);
-        } else if (header.payload_length == 127) {
-            extra_bytes_needed += sizeof(uint64_t);
-        }
+    header.opcode = receivedOpcode == 0 ? _currentFrameOpcode : receivedOpcode;
 
-        if (extra_bytes_needed == 0) {
-            [sself _handleFrameHeader:header curData:sself->_currentFrameData];
-        } else {
-            [sself _addConsumerWithDataLength:extra_bytes_needed callback:^(ARTSRWebSocket *eself, NSData *edata) {
-                size_t mapped_size = edata.length;
-#pragma unused (mapped_size)
-                const void *mapped_buffer = edata.bytes;
-                size_t offset = 0;
-
-                if (header.payload_length == 126) {
-                    assert(mapped_size >= sizeof(uint16_t));
-                    uint16_t payloadLength = 0;
-                    memcpy(&payloadLength, mapped_buffer, sizeof(uint16_t));
-                    payloadLength = CFSwapInt16BigToHost(payloadLength);
-
-                    header.payload_length = payloadLength;
-                    offset += sizeof(uint16_t);
-                } else if (header.payload_length == 127) {
-                    assert(mapped_size >= sizeof(uint64_t));
-                    uint64_t payloadLength = 0;
-                    memcpy(&payloadLength, mapped_buffer, sizeof(uint64_t));
-                    payloadLength = CFSwapInt64BigToHost(payloadLength);
-
-                    header.payload_length = payloadLength;
-                    offset += sizeof(uint64_t);
-                } else {
-                    assert(header.payload_length < 126 && header.payload_length >= 0);
-                }
+    header.fin = !!(ARTSRFinMask & headerBuffer[0]);
 
-                if (header.masked) {
-                    assert(mapped_size >= sizeof(self->_currentReadMaskOffset) + offset);
-                    memcpy(eself->_currentReadMaskKey, ((uint8_t *)mapped_buffer) + offset, sizeof(eself->_currentReadMaskKey));
-                }
+    header.masked = !!(ARTSRMaskMask & headerBuffer[1]);
+    header.payload_length = ARTSRPayloadLenMask & headerBuffer[1];
 
-                [eself _handleFrameHeader:header curData:eself->_currentFrameData];
-            } readToCurrentFrame:NO unmaskBytes:NO];
+    if (header.masked) {
+        [self _stopReadingFramesWithProtocolError:@"Client must receive unmasked data"];
+        return NO;
+    }
+
+    size_t headerLength = 2;
+
+    if (header.payload_length == 126) {
+        headerLength += sizeof(uint16_t);
+    } else if (header.payload_length == 127) {
+        headerLength += sizeof(uint64_t);
+    }
+
+    if (availableLength < headerLength) {
+        return NO;
+    }
+
+    if (header.payload_length == 126) {
+        uint16_t payloadLength = 0;
+        memcpy(&payloadLength, headerBuffer + 2, sizeof(uint16_t));
+        header.payload_length = CFSwapInt16BigToHost(payloadLength);
+    } else if (header.payload_length == 127) {
+        uint64_t payloadLength = 0;
+        memcpy(&payloadLength, headerBuffer + 2, sizeof(uint64_t));
+        header.payload_length = CFSwapInt64BigToHost(payloadLength);
+    }
+
+    [_readBuffer consumeLength:headerLength];
+
+    return [self _handleFrameHeader:header];
+}
+
+- (BOOL)_handleFrameHeader:(frame_header)frame_header
+{
+    assert(frame_header.opcode != 0);
+
+    if (self.readyState == ARTWebSocketReadyStateClosed) {
+        _frameReadState = ARTSRFrameReadStateNone;
+        return NO;
+    }
+
+    BOOL isControlFrame = (frame_header.opcode == ARTSROpCodePing || frame_header.opcode == ARTSROpCodePong || frame_header.opcode == ARTSROpCodeConnectionClose);
+
+    if (isControlFrame && !frame_header.fin) {
+        [self _stopReadingFramesWithProtocolError:@"Fragmented control frames not allowed"];
+        return NO;
+    }
+
+    if (isControlFrame && frame_header.payload_length >= 126) {
+        [self _stopReadingFramesWithProtocolError:@"Control frames cannot have payloads larger than 126 bytes"];
+        return NO;
+    }
+
+    if (!isControlFrame) {
+        _currentFrameOpcode = frame_header.opcode;
+        _currentFrameCount += 1;
+        if (_currentFrameCount == 1) {
+            _currentMessageIsCompressed = frame_header.rsv1;
         }
-    } readToCurrentFrame:NO unmaskBytes:NO];
+    }
+
+    assert(frame_header.payload_length <= SIZE_T_MAX);
+    _currentFrameHeader = frame_header;
+    _currentFramePayloadRemaining = frame_header.payload_length;
+    _frameReadState = ARTSRFrameReadStatePayload;
+
+    // A message in a single frame is read whole into the read buffer, and handled as a slice of it, rather than assembled into `_currentFrameData`.
+    _currentFrameIsWholeMessage = isControlFrame || (frame_header.fin && _currentFrameCount == 1);
+    if (_currentFrameIsWholeMessage) {
+        const size_t reservation = (size_t)MIN(frame_header.payload_length, (uint64_t)ARTSRMaximumPayloadReservation());
+        if (![_readBuffer reserveCapacity:reservation + ARTSRDefaultBufferSize()]) {
+            _frameReadState = ARTSRFrameReadStateNone;
+            NSError *error = ARTSRErrorWithCodeDescription(ARTSRStatusCodeMessageTooBig,
+                                                        @"Unable to allocate memory to read from socket.");
+            [self _failWithError:error];
+            return NO;
+        }
+    } else if (!_currentFrameData) {
+        _currentFrameData = [[NSMutableData alloc] init];
+    }
+
+    return YES;
 }
 
-- (void)_readFrameNew;
+- (BOOL)_readFramePayload
 {
-    dispatch_async(_workQueue, ^{
-        // Don't reset the length, since Apple doesn't guarantee that this will free the memory (and in tests on
-        // some platforms, it doesn't seem to, effectively causing a leak the size of the biggest frame so far).
-        self->_currentFrameData = [[NSMutableData alloc] init];
+    if (_currentFrameIsWholeMessage) {
+        const size_t payloadLength = (size_t)_currentFramePayloadRemaining;
+        if (_readBuffer.length < payloadLength) {
+            return NO;
+        }
+        // Control frames are never compressed, even in between the frames of a compressed message.
+        const BOOL isCompressed = _currentMessageIsCompressed && _currentFrameHeader.opcode == _currentFrameOpcode;
+        if (!isCompressed && _currentFrameHeader.opcode == ARTSROpCodeTextFrame && !ARTSRUTF8IsValid(_readBuffer.bytes, payloadLength)) {
+            [self _stopReadingFramesWithInvalidUTF8];
+            return NO;
+        }
+        NSData *frameData = (NSData *)[_readBuffer sliceWithLength:payloadLength];
+        [_readBuffer consumeLength:payloadLength];
+        _currentFramePayloadRemaining = 0;
+
+        if (isCompressed) {
+            frameData = [self _decompressMessageData:frameData];
+            if (!frameData) {
+                return NO;
+            }
+        }
+        [self _handleFrameWithData:frameData opCode:_currentFrameHeader.opcode];
+        return YES;
+    }
+
+    const size_t length = (size_t)MIN(_currentFramePayloadRemaining, (uint64_t)_readBuffer.length);
+    if (length == 0 && _currentFramePayloadRemaining > 0) {
+        return NO;
+    }
+    // Text is validated as it arrives, so that the frames already validated aren't scanned again; compressed text can only be validated once decompressed.
+    if (_currentFrameOpcode == ARTSROpCodeTextFrame && !_currentMessageIsCompressed && !ARTSRUTF8ValidationUpdate(&_currentTextValidation, _readBuffer.bytes, length)) {
+        [self _stopReadingFramesWithInvalidUTF8];
+        return NO;
+    }
+    [_currentFrameData appendBytes:_readBuffer.bytes length:length];
+    [_readBuffer consumeLength:length];
+    _currentFramePayloadRemaining -= length;
 
-        self->_currentFrameOpcode = 0;
-        self->_currentFrameCount = 0;
-        self->_readOpCount = 0;
-        self->_currentStringScanPosition = 0;
+    if (_currentFramePayloadRemaining > 0) {
+        return YES;
+    }
 
+    if (_currentFrameHeader.fin) {
+        NSData *messageData = _currentFrameData;
+        if (_currentMessageIsCompressed) {
+            messageData = [self _decompressMessageData:messageData];
+            if (!messageData) {
+                return NO;
+            }
+        } else if (_currentFrameOpcode == ARTSROpCodeTextFrame && !ARTSRUTF8ValidationFinish(&_currentTextValidation)) {
+            [self _stopReadingFramesWithInvalidUTF8];
+            return NO;
+        }
+        [self _handleFrameWithData:messageData opCode:_currentFrameHeader.opcode];
+    } else {
         [self _readFrameContinue];
-    });
+    }
+    return YES;
+}
+
+// Decompresses a whole data message, and validates it if it's text.
+- (nullable NSData *)_decompressMessageData:(NSData *)data
+{
+    NSData *messageData = [_perMessageDeflate decompressData:data];
+    if (!messageData) {
+        [self _stopReadingFramesWithProtocolError:@"Unable to decompress message"];
+        return nil;
+    }
+    if (_currentFrameOpcode == ARTSROpCodeTextFrame && !ARTSRUTF8IsValid(messageData.bytes, messageData.length)) {
+        [self _stopReadingFramesWithInvalidUTF8];
+        return nil;
+    }
+    return messageData;
 }
 
 - (void)_pumpWriting;
 {
     [self assertOnWorkQueue];
 
+    // While the stream is full, frames keep joining the corked buffer, to be written together once it has space again.
+    if (_outputStream.hasSpaceAvailable || _closeWhenFinishedWriting) {
+        [self _uncorkFrames];
+    }
+
     NSUInteger dataLength = dispatch_data_get_size(_outputBuffer);
     if (dataLength - _outputBufferOffset > 0 && _outputStream.hasSpaceAvailable) {
         __block NSInteger bytesWritten = 0;
         __block BOOL streamFailed = NO;
+        __block NSUInteger writeCount = 0;
 
+        // The output chain references each corked buffer as a separate region, which is written in place; NSOutputStream has no vectored write, so the regions are written one after the other.
         dispatch_data_t dataToSend = dispatch_data_create_subrange(_outputBuffer, _outputBufferOffset, dataLength - _outputBufferOffset);
         dispatch_data_apply(dataToSend, ^bool(dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
             NSInteger sentLength = [self->_outputStream write:buffer maxLength:size];
@@ -1061,6 +1317,9 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
                 streamFailed = YES;
                 return false;
             }
+            if (sentLength > 0) {
+                writeCount += 1;
+            }
             bytesWritten += sentLength;
             return (sentLength >= (NSInteger)size); // If we can't write all the data into the stream - bail-out early.
         });
@@ -1074,6 +1333,7 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
         }
 
         _outputBufferOffset += bytesWritten;
+        self.socketWriteCount += writeCount;
 
         if (_outputBufferOffset > ARTSRDefaultBufferSize() && _outputBufferOffset > dataLength / 2) {
             _outputBuffer = dispatch_data_create_subrange(_outputBuffer, _outputBufferOffset, dataLength - _outputBufferOffset);
@@ -1081,6 +1341,8 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
         }
     }
 
+    [self _sendPendingFragments];
+
     if (_closeWhenFinishedWriting &&
         (dispatch_data_get_size(_outputBuffer) - _outputBufferOffset) == 0 &&
         (_inputStream.streamStatus != NSStreamStatusNotOpen &&
@@ -1088,6 +1350,10 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
         !_sentClose) {
         _sentClose = YES;
 
+        const NSUInteger sentFrameCount = self.sentFrameCount;
+        const NSUInteger socketWriteCount = self.socketWriteCount;
+        ARTSRDebugLog(self.logger, @"Sent %lu frames in %lu writes (%.2f frames per write)", (unsigned long)sentFrameCount, (unsigned long)socketWriteCount, socketWriteCount > 0 ? (double)sentFrameCount / socketWriteCount : 0.0);
+
         @synchronized(self) {
             [_outputStream close];
             [_inputStream close];
@@ -1113,22 +1379,7 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
 - (void)_addConsumerWithScanner:(stream_scanner)consumer callback:(data_callback)callback;
 {
     [self assertOnWorkQueue];
-    [self _addConsumerWithScanner:consumer callback:callback dataLength:0];
-}
-
-- (void)_addConsumerWithDataLength:(size_t)dataLength callback:(data_callback)callback readToCurrentFrame:(BOOL)readToCurrentFrame unmaskBytes:(BOOL)unmaskBytes;
-{
-    [self assertOnWorkQueue];
-    assert(dataLength);
-
-    [_consumers addObject:[_consumerPool consumerWithScanner:nil handler:callback bytesNeeded:dataLength readToCurrentFrame:readToCurrentFrame unmaskBytes:unmaskBytes]];
-    [self _pumpScanner];
-}
-
-- (void)_addConsumerWithScanner:(stream_scanner)consumer callback:(data_callback)callback dataLength:(size_t)dataLength;
-{
-    [self assertOnWorkQueue];
-    [_consumers addObject:[_consumerPool consumerWithScanner:consumer handler:callback bytesNeeded:dataLength readToCurrentFrame:NO unmaskBytes:NO]];
+    [_consumers addObject:[_consumerPool consumerWithScanner:consumer handler:callback]];
     [self _pumpScanner];
 }
 
@@ -1142,6 +1393,14 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
 
         _cleanupScheduled = YES;
 
+        if (_deliversStreamEventsOnWorkQueue) {
+            // The streams deliver their events on the work queue, so cleaning up there can't race with them either.
+            dispatch_async(_workQueue, ^{
+                [self _cleanupSelfReference:nil];
+            });
+            return;
+        }
+
         // Cleanup NSStream delegate's in the same RunLoop used by the streams themselves:
         // This way we'll prevent race conditions between handleEvent and ARTSRWebsocket's dealloc
         NSTimer *timer = [NSTimer timerWithTimeInterval:(0.0f) target:self selector:@selector(_cleanupSelfReference:) userInfo:nil repeats:NO];
@@ -1149,13 +1408,18 @@ static const uint8_t ARTSRPayloadLenMask   = 0x7F;
     }
 }
 
-- (void)_cleanupSelfReference:(NSTimer *)timer
+- (void)_cleanupSelfReference:(nullable NSTimer *)timer
 {
     @synchronized(self) {
         // Nuke NSStream delegate's
         _inputStream.delegate = nil;
         _outputStream.delegate = nil;
 
+        if (_deliversStreamEventsOnWorkQueue) {
+            CFReadStreamSetDispatchQueue((__bridge CFReadStreamRef)_inputStream, NULL);
+            CFWriteStreamSetDispatchQueue((__bridge CFWriteStreamRef)_outputStream, NULL);
+        }
+
         // Remove the streams, right now, from the networkRunLoop
         [_inputStream close];
         [_outputStream close];
@@ -1210,106 +1474,34 @@ static const char CRLFCRLFBytes[] = {'\r', '\n', '\r', '\n'};
         return didWork;
     }
 
-    size_t readBufferSize = dispatch_data_get_size(_readBuffer);
+    if (_frameReadState != ARTSRFrameReadStateNone) {
+        return [self _readFrame];
+    }
 
+    // Until the handshake has finished, the HTTP response is read by consumers.
     if (!_consumers.count) {
         return didWork;
     }
 
-    size_t curSize = readBufferSize - _readBufferOffset;
+    size_t curSize = _readBuffer.length;
     if (!curSize) {
         return didWork;
     }
 
     ARTSRIOConsumer *consumer = [_consumers objectAtIndex:0];
+    assert(consumer.consumer);
 
-    size_t bytesNeeded = consumer.bytesNeeded;
-
-    size_t foundSize = 0;
-    if (consumer.consumer) {
-        NSData *subdata = (NSData *)dispatch_data_create_subrange(_readBuffer, _readBufferOffset, readBufferSize - _readBufferOffset);
-        foundSize = consumer.consumer(subdata);
-    } else {
-        assert(consumer.bytesNeeded);
-        if (curSize >= bytesNeeded) {
-            foundSize = bytesNeeded;
-        } else if (consumer.readToCurrentFrame) {
-            foundSize = curSize;
-        }
-    }
-
-    if (consumer.readToCurrentFrame || foundSize) {
-        dispatch_data_t slice = dispatch_data_create_subrange(_readBuffer, _readBufferOffset, foundSize);
-
-        _readBufferOffset += foundSize;
-
-        if (_readBufferOffset > ARTSRDefaultBufferSize() && _readBufferOffset > readBufferSize / 2) {
-            _readBuffer = dispatch_data_create_subrange(_readBuffer, _readBufferOffset, readBufferSize - _readBufferOffset);
-            _readBufferOffset = 0;
-        }
-
-        if (consumer.unmaskBytes) {
-            __block NSMutableData *mutableSlice = [slice mutableCopy];
-
-            NSUInteger len = mutableSlice.length;
-            uint8_t *bytes = mutableSlice.mutableBytes;
-
-            for (NSUInteger i = 0; i < len; i++) {
-                bytes[i] = bytes[i] ^ _currentReadMaskKey[_currentReadMaskOffset % sizeof(_currentReadMaskKey)];
-                _currentReadMaskOffset += 1;
-            }
-
-            slice = dispatch_data_create(bytes, len, nil, ^{
-                mutableSlice = nil;
-            });
-        }
-
-        if (consumer.readToCurrentFrame) {
-            dispatch_data_apply(slice, ^bool(dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
-                [self->_currentFrameData appendBytes:buffer length:size];
-                return true;
-            });
+    NSData *subdata = (NSData *)[_readBuffer sliceWithLength:curSize];
+    size_t foundSize = consumer.consumer(subdata);
 
-            _readOpCount += 1;
+    if (foundSize) {
+        dispatch_data_t slice = [_readBuffer sliceWithLength:foundSize];
+        [_readBuffer consumeLength:foundSize];
 
-            if (_currentFrameOpcode == ARTSROpCodeTextFrame) {
-                // Validate UTF8 stuff.
-                size_t currentDataSize = _currentFrameData.length;
-                if (_currentFrameOpcode == ARTSROpCodeTextFrame && currentDataSize > 0) {
-                    // TODO: Optimize the crap out of this.  Don't really have to copy all the data each time
-
-                    size_t scanSize = currentDataSize - _currentStringScanPosition;
-
-                    NSData *scan_data = [_currentFrameData subdataWithRange:NSMakeRange(_currentStringScanPosition, scanSize)];
-                    int32_t valid_utf8_size = validate_dispatch_data_partial_string(scan_data);
-
-                    if (valid_utf8_size == -1) {
-                        [self closeWithCode:ARTSRStatusCodeInvalidUTF8 reason:@"Text frames must be valid UTF-8"];
-                        dispatch_async(_workQueue, ^{
-                            [self closeConnection];
-                        });
-                        return didWork;
-                    } else {
-                        _currentStringScanPosition += valid_utf8_size;
-                    }
-                }
-
-            }
-
-            consumer.bytesNeeded -= foundSize;
-
-            if (consumer.bytesNeeded == 0) {
-                [_consumers removeObjectAtIndex:0];
-                consumer.handler(self, nil);
-                [_consumerPool returnConsumer:consumer];
-                didWork = YES;
-            }
-        } else if (foundSize) {
-            [_consumers removeObjectAtIndex:0];
-            consumer.handler(self, (NSData *)slice);
-            [_consumerPool returnConsumer:consumer];
-            didWork = YES;
-        }
+        [_consumers removeObjectAtIndex:0];
+        consumer.handler(self, (NSData *)slice);
+        [_consumerPool returnConsumer:consumer];
+        didWork = YES;
     }
     return didWork;
 }
@@ -1331,30 +1523,109 @@ static const char CRLFCRLFBytes[] = {'\r', '\n', '\r', '\n'};
     _isPumping = NO;
 }
 
-static const size_t ARTSRFrameHeaderOverhead = 32;
+// 2 bytes, up to 8 bytes of extended payload length and a 4-byte mask key.
+static const size_t ARTSRFrameHeaderMaxLength = 14;
 
 - (void)_sendFrameWithOpcode:(ARTSROpCode)opCode data:(NSData *)data
 {
     [self assertOnWorkQueue];
 
-    if (!data) {
+    if (!data || _closeWhenFinishedWriting) {
         return;
     }
 
+    const uint8_t *unmaskedPayloadBuffer = (uint8_t *)data.bytes;
     size_t payloadLength = data.length;
+    const BOOL isDataFrame = opCode == ARTSROpCodeTextFrame || opCode == ARTSROpCodeBinaryFrame;
 
-    NSMutableData *frameData = [[NSMutableData alloc] initWithLength:payloadLength + ARTSRFrameHeaderOverhead];
-    if (!frameData) {
-        [self closeWithCode:ARTSRStatusCodeMessageTooBig reason:@"Message too big"];
+    // Data messages are compressed into the extension's scratch buffer, from which they're masked into the frame like any other payload.
+    BOOL compressed = NO;
+    if (isDataFrame && [_perMessageDeflate shouldCompressMessageOfLength:payloadLength]) {
+        if (![_perMessageDeflate compressBytes:unmaskedPayloadBuffer length:payloadLength]) {
+            [self closeWithCode:ARTSRStatusCodeInternalError reason:@"Unable to compress message"];
+            return;
+        }
+        unmaskedPayloadBuffer = _perMessageDeflate.compressedBytes;
+        payloadLength = _perMessageDeflate.compressedLength;
+        compressed = YES;
+    }
+
+    // Nothing may follow the close frame, so it only waits for the rest of a message already partly written, and the messages queued after that one are dropped.
+    if (opCode == ARTSROpCodeConnectionClose && _pendingMessages.count > 0) {
+        const NSUInteger inFlightCount = _pendingMessageOffset > 0 ? 1 : 0;
+        [_pendingMessages removeObjectsInRange:NSMakeRange(inFlightCount, _pendingMessages.count - inFlightCount)];
+    }
+
+    // A message too long for one fragment waits to be fragmented, and so do the messages after it, which mustn't overtake it; pings and pongs never wait.
+    const NSUInteger maximumFragmentLength = self.maximumFragmentLength;
+    const BOOL mustFragment = isDataFrame && maximumFragmentLength > 0 && payloadLength > maximumFragmentLength;
+    if (mustFragment || (_pendingMessages.count > 0 && (isDataFrame || opCode == ARTSROpCodeConnectionClose))) {
+        // The compressed bytes only last until the next message is compressed.
+        NSData *payload = compressed ? [NSData dataWithBytes:unmaskedPayloadBuffer length:payloadLength] : data;
+        [_pendingMessages addObject:[[ARTSRPendingMessage alloc] initWithOpCode:opCode payload:payload compressed:compressed]];
+        [self _sendPendingFragments];
         return;
     }
-    uint8_t *frameBuffer = (uint8_t *)frameData.mutableBytes;
+
+    [self _writeFrameWithOpcode:opCode fin:YES compressed:compressed bytes:unmaskedPayloadBuffer length:payloadLength];
+}
+
+// Writes the pending messages a fragment at a time, for as long as less than a fragment is waiting to be written,
+// so that a control frame sent in the meantime only waits behind the fragment being written.
+- (void)_sendPendingFragments
+{
+    [self assertOnWorkQueue];
+
+    const size_t maximumFragmentLength = self.maximumFragmentLength ?: SIZE_MAX;
+    while (_pendingMessages.count > 0 && !_closeWhenFinishedWriting) {
+        const size_t unwrittenLength = dispatch_data_get_size(_outputBuffer) - _outputBufferOffset + _corkedBufferLength;
+        if (unwrittenLength >= maximumFragmentLength) {
+            return;
+        }
+
+        ARTSRPendingMessage *const message = _pendingMessages.firstObject;
+        const size_t remainingLength = message.payload.length - _pendingMessageOffset;
+        // Control frames can't be fragmented.
+        const size_t length = message.opCode == ARTSROpCodeConnectionClose ? remainingLength : MIN(remainingLength, maximumFragmentLength);
+        const BOOL isFirstFragment = _pendingMessageOffset == 0;
+        const BOOL fin = length == remainingLength;
+
+        // Only the first fragment carries the message's opcode, and whether it's compressed.
+        if (![self _writeFrameWithOpcode:isFirstFragment ? message.opCode : ARTSROpCodeContinuationFrame
+                                     fin:fin
+                              compressed:isFirstFragment && message.compressed
+                                   bytes:(const uint8_t *)message.payload.bytes + _pendingMessageOffset
+                                  length:length]) {
+            // The socket is closing, and the close frame follows what was written of the message.
+            [_pendingMessages removeObjectAtIndex:0];
+            _pendingMessageOffset = 0;
+            return;
+        }
+
+        if (fin) {
+            [_pendingMessages removeObjectAtIndex:0];
+            _pendingMessageOffset = 0;
+        } else {
+            _pendingMessageOffset += length;
+        }
+    }
+}
+
+- (BOOL)_writeFrameWithOpcode:(ARTSROpCode)opCode fin:(BOOL)fin compressed:(BOOL)compressed bytes:(const uint8_t *)unmaskedPayloadBuffer length:(size_t)payloadLength
+{
+    // The header and the masked payload are written straight into the corked buffer, which isn't zeroed, and which the output chain then references rather than copies.
+    const size_t frameMaxLength = payloadLength + ARTSRFrameHeaderMaxLength;
+    uint8_t *frameBuffer = [self _corkedSpaceForFrameWithMaxLength:frameMaxLength];
+    if (!frameBuffer) {
+        [self closeWithCode:ARTSRStatusCodeMessageTooBig reason:@"Message too big"];
+        return NO;
+    }
 
     // set fin
-    frameBuffer[0] = ARTSRFinMask | opCode;
+    frameBuffer[0] = (fin ? ARTSRFinMask : 0) | (compressed ? ARTSRRsv1Mask : 0) | opCode;
 
     // set the mask and header
-    frameBuffer[1] |= ARTSRMaskMask;
+    frameBuffer[1] = ARTSRMaskMask;
 
     size_t frameBufferSize = 2;
 
@@ -1380,7 +1651,6 @@ static const size_t ARTSRFrameHeaderOverhead = 32;
         frameBufferSize += declaredPayloadLengthSize;
     }
 
-    const uint8_t *unmaskedPayloadBuffer = (uint8_t *)data.bytes;
     uint8_t *maskKey = frameBuffer + frameBufferSize;
 
     size_t randomBytesSize = sizeof(uint32_t);
@@ -1390,17 +1660,16 @@ static const size_t ARTSRFrameHeaderOverhead = 32;
     }
     frameBufferSize += randomBytesSize;
 
-    // Copy and unmask the buffer
+    // Copy and mask the payload in a single pass
     uint8_t *frameBufferPayloadPointer = frameBuffer + frameBufferSize;
 
-    memcpy(frameBufferPayloadPointer, unmaskedPayloadBuffer, payloadLength);
-    ARTSRMaskBytesSIMD(frameBufferPayloadPointer, payloadLength, maskKey);
+    ARTSRMaskCopyBytesSIMD(frameBufferPayloadPointer, unmaskedPayloadBuffer, payloadLength, maskKey);
     frameBufferSize += payloadLength;
 
-    assert(frameBufferSize <= frameData.length);
-    frameData.length = frameBufferSize;
+    assert(frameBufferSize <= frameMaxLength);
 
-    [self _writeData:frameData];
+    [self _didCorkFrameOfLength:frameBufferSize];
+    return YES;
 }
 
 - (void)stream:(NSStream *)aStream handleEvent:(NSStreamEvent)eventCode
@@ -1414,21 +1683,32 @@ static const size_t ARTSRFrameHeaderOverhead = 32;
             _streamSecurityValidated = [_securityPolicy evaluateServerTrust:trust forDomain:_urlRequest.URL.host];
         }
         if (!_streamSecurityValidated) {
-            dispatch_async(_workQueue, ^{
+            [self _performStreamEventBlock:^{
                 NSError *error = ARTSRErrorWithDomainCodeDescription(NSURLErrorDomain,
                                                                   NSURLErrorClientCertificateRejected,
                                                                   @"Invalid server certificate.");
                 [wself _failWithError:error];
-            });
+            }];
             return;
         }
-        dispatch_async(_workQueue, ^{
+        [self _performStreamEventBlock:^{
             [self didConnect];
-        });
+        }];
     }
-    dispatch_async(_workQueue, ^{
+    [self _performStreamEventBlock:^{
         [wself safeHandleEvent:eventCode stream:aStream];
-    });
+    }];
+}
+
+// Runs the handling of a stream event on the work queue: straight away if the streams deliver their events there, or after the ones queued before it otherwise.
+- (void)_performStreamEventBlock:(dispatch_block_t)block
+{
+    if (_deliversStreamEventsOnWorkQueue) {
+        [self assertOnWorkQueue];
+        block();
+    } else {
+        dispatch_async(_workQueue, block);
+    }
 }
 
 - (void)safeHandleEvent:(NSStreamEvent)eventCode stream:(NSStream *)aStream
@@ -1455,8 +1735,7 @@ static const size_t ARTSRFrameHeaderOverhead = 32;
             ARTSRDebugLog(self.logger, @"NSStreamEventErrorOccurred %@ %@", aStream, [[aStream streamError] copy]);
             /// TODO specify error better!
             [self _failWithError:aStream.streamError];
-            _readBufferOffset = 0;
-            _readBuffer = dispatch_data_empty;
+            [_readBuffer reset];
             break;
 
         }
@@ -1493,19 +1772,19 @@ static const size_t ARTSRFrameHeaderOverhead = 32;
 
         case NSStreamEventHasBytesAvailable: {
             ARTSRDebugLog(self.logger, @"NSStreamEventHasBytesAvailable %@", aStream);
-            uint8_t buffer[ARTSRDefaultBufferSize()];
-
             while (_inputStream.hasBytesAvailable) {
-                NSInteger bytesRead = [_inputStream read:buffer maxLength:ARTSRDefaultBufferSize()];
+                // Read straight into the read buffer, where frames are then parsed in place.
+                size_t available = 0;
+                uint8_t *buffer = [_readBuffer spaceForWritingWithMinimumLength:ARTSRDefaultBufferSize() available:&available];
+                if (!buffer) {
+                    NSError *error = ARTSRErrorWithCodeDescription(ARTSRStatusCodeMessageTooBig,
+                                                                @"Unable to allocate memory to read from socket.");
+                    [self _failWithError:error];
+                    return;
+                }
+                NSInteger bytesRead = [_inputStream read:buffer maxLength:available];
                 if (bytesRead > 0) {
-                    dispatch_data_t data = dispatch_data_create(buffer, bytesRead, nil, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
-                    if (!data) {
-                        NSError *error = ARTSRErrorWithCodeDescription(ARTSRStatusCodeMessageTooBig,
-                                                                    @"Unable to allocate memory to read from socket.");
-                        [self _failWithError:error];
-                        return;
-                    }
-                    _readBuffer = dispatch_data_create_concat(_readBuffer, data);
+                    [_readBuffer didWriteLength:bytesRead];
                 } else if (bytesRead == -1) {
                     [self _failWithError:_inputStream.streamError];
                 }
@@ -1561,70 +1840,3 @@ static const size_t ARTSRFrameHeaderOverhead = 32;
 }
 
 @end
-
-#ifdef HAS_ICU
-
-static inline int32_t validate_dispatch_data_partial_string(NSData *data) {
-    if ([data length] > INT32_MAX) {
-        // INT32_MAX is the limit so long as this Framework is using 32 bit ints everywhere.
-        return -1;
-    }
-
-    int32_t size = (int32_t)[data length];
-
-    const void * contents = [data bytes];
-    const uint8_t *str = (const uint8_t *)contents;
-
-    UChar32 codepoint = 1;
-    int32_t offset = 0;
-    int32_t lastOffset = 0;
-    while(offset < size && codepoint > 0)  {
-        lastOffset = offset;
-        U8_NEXT(str, offset, size, codepoint);
-    }
-
-    if (codepoint == -1) {
-        // Check to see if the last byte is valid or whether it was just continuing
-        if (!U8_IS_LEAD(str[lastOffset]) || U8_COUNT_TRAIL_BYTES(str[lastOffset]) + lastOffset < (int32_t)size) {
-
-            size = -1;
-        } else {
-            uint8_t leadByte = str[lastOffset];
-            U8_MASK_LEAD_BYTE(leadByte, U8_COUNT_TRAIL_BYTES(leadByte));
-
-            for (int i = lastOffset + 1; i < offset; i++) {
-                if (U8_IS_SINGLE(str[i]) || U8_IS_LEAD(str[i]) || !U8_IS_TRAIL(str[i])) {
-                    size = -1;
-                }
-            }
-
-            if (size != -1) {
-                size = lastOffset;
-            }
-        }
-    }
-
-    if (size != -1 && ![[NSString alloc] initWithBytesNoCopy:(char *)[data bytes] length:size encoding:NSUTF8StringEncoding freeWhenDone:NO]) {
-        size = -1;
-    }
-
-    return size;
-}
-
-#else
-
-// This is a hack, and probably not optimal
-static inline int32_t validate_dispatch_data_partial_string(NSData *data) {
-    static const int maxCodepointSize = 3;
-
-    for (int i = 0; i < maxCodepointSize; i++) {
-        NSString *str = [[NSString alloc] initWithBytesNoCopy:(char *)data.bytes length:data.length - i encoding:NSUTF8StringEncoding freeWhenDone:NO];
-        if (str) {
-            return (int32_t)data.length - i;
-        }
-    }
-
-    return -1;
-}
-
-#endif
@@ -11,6 +11,7 @@
 
 typedef NS_ENUM(uint8_t, ARTSROpCode)
 {
+    ARTSROpCodeContinuationFrame = 0x0,
     ARTSROpCodeTextFrame = 0x1,
     ARTSROpCodeBinaryFrame = 0x2,
     // 3-7 reserved.
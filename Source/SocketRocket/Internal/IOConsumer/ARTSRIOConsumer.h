@@ -18,23 +18,15 @@
 typedef size_t (^stream_scanner)(NSData *collected_data);
 typedef void (^data_callback)(ARTSRWebSocket *webSocket,  NSData *data);
 
+// Only reads the handshake response now that frames are parsed in place, so it's always driven by a scanner.
 @interface ARTSRIOConsumer : NSObject {
     stream_scanner _scanner;
     data_callback _handler;
-    size_t _bytesNeeded;
-    BOOL _readToCurrentFrame;
-    BOOL _unmaskBytes;
 }
 @property (nonatomic, copy, readonly) stream_scanner consumer;
 @property (nonatomic, copy, readonly) data_callback handler;
-@property (nonatomic) size_t bytesNeeded;
-@property (nonatomic, readonly) BOOL readToCurrentFrame;
-@property (nonatomic, readonly) BOOL unmaskBytes;
 
 - (void)resetWithScanner:(stream_scanner)scanner
-                 handler:(data_callback)handler
-             bytesNeeded:(size_t)bytesNeeded
-      readToCurrentFrame:(BOOL)readToCurrentFrame
-             unmaskBytes:(BOOL)unmaskBytes;
+                 handler:(data_callback)handler;
 
 @end
@@ -19,10 +19,7 @@
 - (instancetype)initWithBufferCapacity:(NSUInteger)poolSize;
 
 - (ARTSRIOConsumer *)consumerWithScanner:(stream_scanner)scanner
-                              handler:(data_callback)handler
-                          bytesNeeded:(size_t)bytesNeeded
-                   readToCurrentFrame:(BOOL)readToCurrentFrame
-                          unmaskBytes:(BOOL)unmaskBytes;
+                              handler:(data_callback)handler;
 - (void)returnConsumer:(ARTSRIOConsumer *)consumer;
 
 @end
@@ -33,9 +33,6 @@
 
 - (ARTSRIOConsumer *)consumerWithScanner:(stream_scanner)scanner
                               handler:(data_callback)handler
-                          bytesNeeded:(size_t)bytesNeeded
-                   readToCurrentFrame:(BOOL)readToCurrentFrame
-                          unmaskBytes:(BOOL)unmaskBytes
 {
     ARTSRIOConsumer *consumer = nil;
     if (_bufferedConsumers.count) {
@@ -46,10 +43,7 @@
     }
 
     [consumer resetWithScanner:scanner
-                       handler:handler
-                   bytesNeeded:bytesNeeded
-            readToCurrentFrame:readToCurrentFrame
-                   unmaskBytes:unmaskBytes];
+                       handler:handler];
 
     return consumer;
 }
@@ -0,0 +1,34 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A fixed set of serial dispatch queues, which the work queues of web sockets scheduled with `-[ARTSRWebSocket scheduleOnTargetQueue:]` are spread across.
+
+ Each socket's stream events and frames are then handled on one of these queues rather than after a hop from the single thread of `+[NSRunLoop ARTSR_networkRunLoop]`, so that the sockets of a process use up to `queueCount` threads at once.
+ */
+@interface ARTSRWorkQueuePool : NSObject
+
+/// The pool of the given number of queues shared by the whole process, created on first use. A count of 0 means one queue per active processor.
++ (instancetype)sharedPoolWithQueueCount:(NSUInteger)queueCount;
+
+- (instancetype)initWithQueueCount:(NSUInteger)queueCount NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSUInteger queueCount;
+
+/// Returns the pool's queues in turn. Thread-safe.
+- (dispatch_queue_t)nextQueue;
+
+@end
+
+NS_ASSUME_NONNULL_END
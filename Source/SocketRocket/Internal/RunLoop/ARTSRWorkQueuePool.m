@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import "ARTSRWorkQueuePool.h"
+
+@import Darwin.os.lock;
+
+@implementation ARTSRWorkQueuePool {
+    NSArray<dispatch_queue_t> *_queues;
+    os_unfair_lock _lock;
+    NSUInteger _nextQueueIndex;
+}
+
++ (instancetype)sharedPoolWithQueueCount:(NSUInteger)queueCount
+{
+    static NSMutableDictionary<NSNumber *, ARTSRWorkQueuePool *> *pools;
+    static os_unfair_lock lock = OS_UNFAIR_LOCK_INIT;
+
+    os_unfair_lock_lock(&lock);
+    if (!pools) {
+        pools = [[NSMutableDictionary alloc] init];
+    }
+    ARTSRWorkQueuePool *pool = pools[@(queueCount)];
+    if (!pool) {
+        pool = [[ARTSRWorkQueuePool alloc] initWithQueueCount:queueCount];
+        pools[@(queueCount)] = pool;
+    }
+    os_unfair_lock_unlock(&lock);
+    return pool;
+}
+
+- (instancetype)initWithQueueCount:(NSUInteger)queueCount
+{
+    self = [super init];
+    if (!self) return self;
+
+    _queueCount = queueCount ?: MAX([NSProcessInfo processInfo].activeProcessorCount, 1);
+    _lock = OS_UNFAIR_LOCK_INIT;
+
+    NSMutableArray<dispatch_queue_t> *queues = [[NSMutableArray alloc] initWithCapacity:_queueCount];
+    for (NSUInteger i = 0; i < _queueCount; i++) {
+        NSString *label = [NSString stringWithFormat:@"io.ably.socketrocket.WorkQueue.%lu", (unsigned long)i];
+        [queues addObject:dispatch_queue_create(label.UTF8String, DISPATCH_QUEUE_SERIAL)];
+    }
+    _queues = queues;
+
+    return self;
+}
+
+- (dispatch_queue_t)nextQueue
+{
+    os_unfair_lock_lock(&_lock);
+    dispatch_queue_t queue = _queues[_nextQueueIndex];
+    _nextQueueIndex = (_nextQueueIndex + 1) % _queueCount;
+    os_unfair_lock_unlock(&_lock);
+    return queue;
+}
+
+@end
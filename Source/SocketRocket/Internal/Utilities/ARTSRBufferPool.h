@@ -0,0 +1,37 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Reuses the buffers that outbound frames are written into, so that sending a frame doesn't allocate, nor zero, its memory.
+
+ Buffers come in power-of-two size classes, and only a few of each class up to `ARTSRBufferPoolMaxPooledCapacity` are kept; larger ones are allocated and freed every time.
+ */
+// This class is not thread-safe, and is expected to always be run on the same queue.
+@interface ARTSRBufferPool : NSObject
+
+/**
+ Returns a buffer of at least `capacity` bytes, whose contents are undefined.
+
+ @param actualCapacity Set to the capacity of the buffer, which must be passed back to `relinquishBuffer:capacity:`.
+ */
+- (nullable uint8_t *)bufferWithCapacity:(size_t)capacity actualCapacity:(size_t *)actualCapacity;
+
+/// Gives back a buffer returned by `bufferWithCapacity:actualCapacity:`, which must not be used afterwards.
+- (void)relinquishBuffer:(uint8_t *)buffer capacity:(size_t)capacity;
+
+@end
+
+/// The capacity of the largest buffers that are kept for reuse.
+extern const size_t ARTSRBufferPoolMaxPooledCapacity;
+
+NS_ASSUME_NONNULL_END
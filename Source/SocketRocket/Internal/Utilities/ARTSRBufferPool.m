@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import "ARTSRBufferPool.h"
+
+const size_t ARTSRBufferPoolMaxPooledCapacity = 64 * 1024;
+
+enum {
+    ARTSRBufferPoolMinCapacityShift = 8, // 256 bytes, enough for most control frames and small messages
+    ARTSRBufferPoolMaxCapacityShift = 16,
+    ARTSRBufferPoolClassCount = ARTSRBufferPoolMaxCapacityShift - ARTSRBufferPoolMinCapacityShift + 1,
+    ARTSRBufferPoolBuffersPerClass = 4,
+};
+
+@implementation ARTSRBufferPool {
+    uint8_t *_buffers[ARTSRBufferPoolClassCount][ARTSRBufferPoolBuffersPerClass];
+    NSUInteger _bufferCounts[ARTSRBufferPoolClassCount];
+}
+
+- (void)dealloc
+{
+    for (NSUInteger sizeClass = 0; sizeClass < ARTSRBufferPoolClassCount; sizeClass++) {
+        for (NSUInteger i = 0; i < _bufferCounts[sizeClass]; i++) {
+            free(_buffers[sizeClass][i]);
+        }
+    }
+}
+
+// The size class of the smallest buffers that hold `capacity` bytes, or NSNotFound if they're too large to pool.
+static NSUInteger ARTSRBufferPoolSizeClass(size_t capacity) {
+    if (capacity > ARTSRBufferPoolMaxPooledCapacity) {
+        return NSNotFound;
+    }
+    NSUInteger shift = ARTSRBufferPoolMinCapacityShift;
+    while (((size_t)1 << shift) < capacity) {
+        shift++;
+    }
+    return shift - ARTSRBufferPoolMinCapacityShift;
+}
+
+- (uint8_t *)bufferWithCapacity:(size_t)capacity actualCapacity:(size_t *)actualCapacity
+{
+    const NSUInteger sizeClass = ARTSRBufferPoolSizeClass(capacity);
+    if (sizeClass == NSNotFound) {
+        *actualCapacity = capacity;
+        return malloc(capacity);
+    }
+
+    *actualCapacity = (size_t)1 << (sizeClass + ARTSRBufferPoolMinCapacityShift);
+    if (_bufferCounts[sizeClass] > 0) {
+        return _buffers[sizeClass][--_bufferCounts[sizeClass]];
+    }
+    return malloc(*actualCapacity);
+}
+
+- (void)relinquishBuffer:(uint8_t *)buffer capacity:(size_t)capacity
+{
+    const NSUInteger sizeClass = ARTSRBufferPoolSizeClass(capacity);
+    if (sizeClass == NSNotFound || _bufferCounts[sizeClass] == ARTSRBufferPoolBuffersPerClass) {
+        free(buffer);
+        return;
+    }
+    _buffers[sizeClass][_bufferCounts[sizeClass]++] = buffer;
+}
+
+@end
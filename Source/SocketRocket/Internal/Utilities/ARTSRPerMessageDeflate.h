@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The parameters of the permessage-deflate extension (RFC 7692) that a socket offers to the server in its handshake.
+ */
+@interface ARTSRPerMessageDeflateOptions : NSObject <NSCopying>
+
+/// The zlib compression level of outbound messages, from 1 (fastest) to 9 (smallest), or -1 for zlib's default. Default: -1.
+@property (nonatomic) int compressionLevel;
+
+/// The base-2 logarithm of the window that outbound messages are compressed with, from 9 to 15. Default: 15.
+@property (nonatomic) uint8_t clientMaxWindowBits;
+
+/// The base-2 logarithm of the largest window that the server may compress inbound messages with, from 9 to 15. Default: 15.
+@property (nonatomic) uint8_t serverMaxWindowBits;
+
+/// Whether each outbound message is compressed on its own, trading compression for the memory of the compression context. Default: `NO`.
+@property (nonatomic) BOOL clientNoContextTakeover;
+
+/// Whether the server is asked to compress each inbound message on its own. Default: `NO`.
+@property (nonatomic) BOOL serverNoContextTakeover;
+
+/// Outbound messages shorter than this are sent uncompressed, since they rarely get smaller. Default: 64.
+@property (nonatomic) NSUInteger minimumLengthToCompress;
+
+/// The value of the `Sec-WebSocket-Extensions` request header that offers the extension with these parameters.
+@property (nonatomic, readonly) NSString *extensionOffer;
+
+@end
+
+/**
+ The compression and decompression contexts of a connection that negotiated the permessage-deflate extension.
+ */
+// This class is not thread-safe, and is expected to always be run on the same queue.
+@interface ARTSRPerMessageDeflate : NSObject
+
+/**
+ Negotiates the extension from the `Sec-WebSocket-Extensions` response header of a handshake that offered it with `options`.
+
+ Fails if the server accepted anything else than the extension offered, or with parameters that the offer doesn't allow.
+ */
+- (nullable instancetype)initWithOptions:(ARTSRPerMessageDeflateOptions *)options
+                     negotiatedExtensions:(NSString *)negotiatedExtensions
+                                    error:(NSError **)error NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) uint8_t clientMaxWindowBits;
+@property (nonatomic, readonly) uint8_t serverMaxWindowBits;
+@property (nonatomic, readonly) BOOL clientNoContextTakeover;
+@property (nonatomic, readonly) BOOL serverNoContextTakeover;
+
+/// Whether an outbound message of `length` bytes is worth compressing.
+- (BOOL)shouldCompressMessageOfLength:(size_t)length;
+
+/**
+ Compresses an outbound message into `compressedBytes`, which stays valid until the next call.
+ */
+- (BOOL)compressBytes:(const uint8_t *)bytes length:(size_t)length;
+@property (nonatomic, readonly) const uint8_t *compressedBytes;
+@property (nonatomic, readonly) size_t compressedLength;
+
+/// Decompresses the payload of an inbound message, or returns `nil` if it isn't valid.
+- (nullable NSData *)decompressData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,332 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import "ARTSRPerMessageDeflate.h"
+
+#import <zlib.h>
+
+#import "ARTSRError.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSString *const ARTSRPerMessageDeflateExtensionName = @"permessage-deflate";
+
+// Compressing with Z_SYNC_FLUSH ends a message with an empty stored block, which is left out of the frame and added back before decompressing.
+static const uint8_t ARTSRPerMessageDeflateTrailer[4] = {0x00, 0x00, 0xFF, 0xFF};
+
+static const uint8_t ARTSRMinWindowBits = 9; // zlib's raw deflate doesn't support a 256 byte window.
+static const uint8_t ARTSRMaxWindowBits = 15;
+
+static uint8_t ARTSRClampWindowBits(uint8_t bits)
+{
+    return MAX(ARTSRMinWindowBits, MIN(ARTSRMaxWindowBits, bits));
+}
+
+@implementation ARTSRPerMessageDeflateOptions
+
+- (instancetype)init
+{
+    self = [super init];
+    if (!self) return self;
+
+    _compressionLevel = Z_DEFAULT_COMPRESSION;
+    _clientMaxWindowBits = ARTSRMaxWindowBits;
+    _serverMaxWindowBits = ARTSRMaxWindowBits;
+    _minimumLengthToCompress = 64;
+
+    return self;
+}
+
+- (id)copyWithZone:(nullable NSZone *)zone
+{
+    ARTSRPerMessageDeflateOptions *options = [[[self class] allocWithZone:zone] init];
+    options.compressionLevel = self.compressionLevel;
+    options.clientMaxWindowBits = self.clientMaxWindowBits;
+    options.serverMaxWindowBits = self.serverMaxWindowBits;
+    options.clientNoContextTakeover = self.clientNoContextTakeover;
+    options.serverNoContextTakeover = self.serverNoContextTakeover;
+    options.minimumLengthToCompress = self.minimumLengthToCompress;
+    return options;
+}
+
+- (NSString *)extensionOffer
+{
+    NSMutableString *offer = [NSMutableString stringWithString:ARTSRPerMessageDeflateExtensionName];
+
+    // Offered even without a value, to let the server limit the window of outbound messages rather than decline the extension.
+    [offer appendString:@"; client_max_window_bits"];
+    const uint8_t clientMaxWindowBits = ARTSRClampWindowBits(self.clientMaxWindowBits);
+    if (clientMaxWindowBits < ARTSRMaxWindowBits) {
+        [offer appendFormat:@"=%u", clientMaxWindowBits];
+    }
+    const uint8_t serverMaxWindowBits = ARTSRClampWindowBits(self.serverMaxWindowBits);
+    if (serverMaxWindowBits < ARTSRMaxWindowBits) {
+        [offer appendFormat:@"; server_max_window_bits=%u", serverMaxWindowBits];
+    }
+    if (self.clientNoContextTakeover) {
+        [offer appendString:@"; client_no_context_takeover"];
+    }
+    if (self.serverNoContextTakeover) {
+        [offer appendString:@"; server_no_context_takeover"];
+    }
+    return offer;
+}
+
+@end
+
+// Parses a window bits parameter value, which is a number from 8 to 15 without leading zeros.
+static BOOL ARTSRParseWindowBits(NSString *_Nullable value, uint8_t *bits)
+{
+    if (value.length == 0 || value.length > 2 || [value hasPrefix:@"0"]) {
+        return NO;
+    }
+    NSInteger parsed = 0;
+    for (NSUInteger i = 0; i < value.length; i++) {
+        const unichar c = [value characterAtIndex:i];
+        if (c < '0' || c > '9') {
+            return NO;
+        }
+        parsed = parsed * 10 + (c - '0');
+    }
+    if (parsed < 8 || parsed > ARTSRMaxWindowBits) {
+        return NO;
+    }
+    *bits = (uint8_t)parsed;
+    return YES;
+}
+
+@implementation ARTSRPerMessageDeflate {
+    z_stream _deflateStream;
+    z_stream _inflateStream;
+    BOOL _canCompress;
+    NSUInteger _minimumLengthToCompress;
+
+    NSMutableData *_compressedData; // Reused by every outbound message.
+    size_t _compressedLength;
+}
+
+- (nullable instancetype)initWithOptions:(ARTSRPerMessageDeflateOptions *)options
+                     negotiatedExtensions:(NSString *)negotiatedExtensions
+                                    error:(NSError **)error
+{
+    self = [super init];
+    if (!self) return self;
+
+    if (![self _negotiateWithOptions:options negotiatedExtensions:negotiatedExtensions error:error]) {
+        return nil;
+    }
+
+    // A client can't compress with a smaller window than zlib supports, so it sends every message uncompressed instead, which the extension allows.
+    _canCompress = _clientMaxWindowBits >= ARTSRMinWindowBits;
+    _minimumLengthToCompress = MAX(options.minimumLengthToCompress, 1);
+
+    // A negative window makes zlib read and write raw deflate data, without the zlib header and checksum.
+    if (deflateInit2(&_deflateStream, options.compressionLevel, Z_DEFLATED, -(int)ARTSRClampWindowBits(_clientMaxWindowBits), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        if (error) {
+            *error = ARTSRErrorWithCodeDescription(2133, @"Unable to set up the compression of permessage-deflate.");
+        }
+        return nil;
+    }
+    if (inflateInit2(&_inflateStream, -(int)ARTSRClampWindowBits(_serverMaxWindowBits)) != Z_OK) {
+        deflateEnd(&_deflateStream);
+        if (error) {
+            *error = ARTSRErrorWithCodeDescription(2133, @"Unable to set up the decompression of permessage-deflate.");
+        }
+        return nil;
+    }
+
+    _compressedData = [[NSMutableData alloc] init];
+
+    return self;
+}
+
+- (void)dealloc
+{
+    deflateEnd(&_deflateStream);
+    inflateEnd(&_inflateStream);
+}
+
+- (BOOL)_negotiateWithOptions:(ARTSRPerMessageDeflateOptions *)options negotiatedExtensions:(NSString *)negotiatedExtensions error:(NSError **)error
+{
+    NSString *(^trim)(NSString *) = ^NSString *(NSString *string) {
+        return [string stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    };
+    BOOL (^fail)(NSString *) = ^BOOL(NSString *description) {
+        if (error) {
+            *error = ARTSRErrorWithCodeDescription(2133, description);
+        }
+        return NO;
+    };
+
+    // Only one extension was offered, so the server can only have accepted that one.
+    NSArray<NSString *> *extensions = [negotiatedExtensions componentsSeparatedByString:@","];
+    NSArray<NSString *> *parameters = [extensions.firstObject componentsSeparatedByString:@";"];
+    if (extensions.count != 1 || [trim(parameters.firstObject) caseInsensitiveCompare:ARTSRPerMessageDeflateExtensionName] != NSOrderedSame) {
+        return fail([NSString stringWithFormat:@"Server specified Sec-WebSocket-Extensions that weren't requested: %@", negotiatedExtensions]);
+    }
+
+    _clientMaxWindowBits = ARTSRClampWindowBits(options.clientMaxWindowBits);
+    _serverMaxWindowBits = ARTSRMaxWindowBits;
+    _clientNoContextTakeover = options.clientNoContextTakeover;
+    _serverNoContextTakeover = NO;
+
+    NSMutableSet<NSString *> *seenParameters = [NSMutableSet set];
+    for (NSUInteger i = 1; i < parameters.count; i++) {
+        NSString *parameter = parameters[i];
+        NSString *name = parameter;
+        NSString *value = nil;
+        const NSRange equals = [parameter rangeOfString:@"="];
+        if (equals.location != NSNotFound) {
+            name = [parameter substringToIndex:equals.location];
+            value = [trim([parameter substringFromIndex:NSMaxRange(equals)]) stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\""]];
+        }
+        name = trim(name).lowercaseString;
+
+        if ([seenParameters containsObject:name]) {
+            return fail([NSString stringWithFormat:@"Server specified the permessage-deflate parameter %@ more than once.", name]);
+        }
+        [seenParameters addObject:name];
+
+        if ([name isEqualToString:@"client_no_context_takeover"] && !value) {
+            _clientNoContextTakeover = YES;
+        } else if ([name isEqualToString:@"server_no_context_takeover"] && !value) {
+            _serverNoContextTakeover = YES;
+        } else if ([name isEqualToString:@"client_max_window_bits"]) {
+            uint8_t bits = 0;
+            if (!ARTSRParseWindowBits(value, &bits) || bits > _clientMaxWindowBits) {
+                return fail([NSString stringWithFormat:@"Server specified an invalid permessage-deflate client_max_window_bits: %@", value]);
+            }
+            _clientMaxWindowBits = bits;
+        } else if ([name isEqualToString:@"server_max_window_bits"]) {
+            uint8_t bits = 0;
+            if (!ARTSRParseWindowBits(value, &bits) || bits > ARTSRClampWindowBits(options.serverMaxWindowBits)) {
+                return fail([NSString stringWithFormat:@"Server specified an invalid permessage-deflate server_max_window_bits: %@", value]);
+            }
+            _serverMaxWindowBits = bits;
+        } else {
+            return fail([NSString stringWithFormat:@"Server specified an unknown permessage-deflate parameter: %@", trim(parameter)]);
+        }
+    }
+
+    return YES;
+}
+
+#pragma mark - Compression
+
+- (BOOL)shouldCompressMessageOfLength:(size_t)length
+{
+    return _canCompress && length >= _minimumLengthToCompress;
+}
+
+- (const uint8_t *)compressedBytes
+{
+    return _compressedData.bytes;
+}
+
+- (size_t)compressedLength
+{
+    return _compressedLength;
+}
+
+- (BOOL)compressBytes:(const uint8_t *)bytes length:(size_t)length
+{
+    assert(_canCompress);
+    assert(length <= UINT_MAX);
+
+    // The bound doesn't count the flush's empty stored block, nor the header of the block that the message starts.
+    const size_t capacity = deflateBound(&_deflateStream, length) + 16;
+    if (_compressedData.length < capacity) {
+        _compressedData.length = capacity;
+    }
+
+    _deflateStream.next_in = (Bytef *)bytes;
+    _deflateStream.avail_in = (uInt)length;
+    size_t produced = 0;
+    do {
+        if (produced == _compressedData.length) {
+            _compressedData.length *= 2;
+        }
+        _deflateStream.next_out = (Bytef *)_compressedData.mutableBytes + produced;
+        _deflateStream.avail_out = (uInt)(_compressedData.length - produced);
+        const int status = deflate(&_deflateStream, Z_SYNC_FLUSH);
+        if (status != Z_OK && status != Z_BUF_ERROR) {
+            return NO;
+        }
+        produced = _compressedData.length - _deflateStream.avail_out;
+    } while (_deflateStream.avail_out == 0);
+
+    const uint8_t *compressed = _compressedData.bytes;
+    if (produced < sizeof(ARTSRPerMessageDeflateTrailer) || memcmp(compressed + produced - sizeof(ARTSRPerMessageDeflateTrailer), ARTSRPerMessageDeflateTrailer, sizeof(ARTSRPerMessageDeflateTrailer)) != 0) {
+        return NO;
+    }
+    _compressedLength = produced - sizeof(ARTSRPerMessageDeflateTrailer);
+
+    if (_clientNoContextTakeover) {
+        deflateReset(&_deflateStream);
+    }
+    return YES;
+}
+
+#pragma mark - Decompression
+
+- (BOOL)_inflateBytes:(const uint8_t *)bytes length:(size_t)length into:(NSMutableData *)output produced:(size_t *)produced
+{
+    assert(length <= UINT_MAX);
+
+    _inflateStream.next_in = (Bytef *)bytes;
+    _inflateStream.avail_in = (uInt)length;
+    do {
+        if (*produced == output.length) {
+            output.length *= 2;
+        }
+        _inflateStream.next_out = (Bytef *)output.mutableBytes + *produced;
+        _inflateStream.avail_out = (uInt)(output.length - *produced);
+        const int status = inflate(&_inflateStream, Z_SYNC_FLUSH);
+        *produced = output.length - _inflateStream.avail_out;
+        if (status == Z_STREAM_END) {
+            // The server ended the message with a final block; whatever follows starts a new deflate stream.
+            inflateReset(&_inflateStream);
+        } else if (status == Z_BUF_ERROR) {
+            if (_inflateStream.avail_in > 0) {
+                return NO;
+            }
+            break; // Everything has been decompressed.
+        } else if (status != Z_OK) {
+            return NO;
+        }
+    } while (_inflateStream.avail_in > 0 || _inflateStream.avail_out == 0);
+    return YES;
+}
+
+- (nullable NSData *)decompressData:(NSData *)data
+{
+    NSMutableData *output = [[NSMutableData alloc] initWithLength:MAX(data.length * 4, 1024)];
+    __block size_t produced = 0;
+    __block BOOL failed = NO;
+    // The data may be made of several regions, such as a slice of the read buffer, which are decompressed without joining them.
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+        if (![self _inflateBytes:bytes length:byteRange.length into:output produced:&produced]) {
+            failed = YES;
+            *stop = YES;
+        }
+    }];
+    if (failed || ![self _inflateBytes:ARTSRPerMessageDeflateTrailer length:sizeof(ARTSRPerMessageDeflateTrailer) into:output produced:&produced]) {
+        return nil;
+    }
+    output.length = produced;
+
+    if (_serverNoContextTakeover) {
+        inflateReset(&_inflateStream);
+    }
+    return output;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import <Foundation/Foundation.h>
+
+@class ARTSRBufferPool;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The bytes read from a socket and not consumed yet, kept contiguous in a slab so that frames can be parsed in place.
+
+ Bytes are read straight into the slab, and can be handed out as slices that reference it rather than copy it. Since a slice can outlive its bytes being consumed, the slab is never overwritten: when it runs out of space, the unread bytes move to a new slab, and the old one goes back to the pool once its last slice is released.
+ */
+// This class is not thread-safe, and is expected to always be run on the same queue.
+@interface ARTSRReadBuffer : NSObject
+
+/// `queue` is the one the buffer is used on, where the slabs are given back to `bufferPool`.
+- (instancetype)initWithBufferPool:(ARTSRBufferPool *)bufferPool queue:(dispatch_queue_t)queue;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The number of unread bytes.
+@property (nonatomic, readonly) size_t length;
+
+/// The unread bytes, which may be modified in place until they're consumed or sliced.
+@property (nonatomic, readonly) uint8_t *bytes;
+
+/**
+ Returns where to write at least `minimumLength` bytes after the unread ones, or NULL if there isn't enough memory.
+
+ @param available Set to the number of bytes that can be written, which is at least `minimumLength`.
+ */
+- (nullable uint8_t *)spaceForWritingWithMinimumLength:(size_t)minimumLength available:(size_t *)available;
+
+/// Makes the first `length` bytes of the space returned by `spaceForWritingWithMinimumLength:available:` unread bytes.
+- (void)didWriteLength:(size_t)length;
+
+/// Makes room for `capacity` unread bytes from the current ones on, so that they'll end up contiguous without being moved again. Returns NO if there isn't enough memory.
+- (BOOL)reserveCapacity:(size_t)capacity;
+
+/// Returns the first `length` unread bytes, without copying them.
+- (dispatch_data_t)sliceWithLength:(size_t)length;
+
+- (void)consumeLength:(size_t)length;
+
+/// Drops the unread bytes and the slab.
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
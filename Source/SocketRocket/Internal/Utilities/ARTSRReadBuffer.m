@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2016-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+
+#import "ARTSRReadBuffer.h"
+
+#import "ARTSRBufferPool.h"
+#import "ARTSRConstants.h"
+
+@implementation ARTSRReadBuffer {
+    ARTSRBufferPool *_bufferPool;
+    dispatch_queue_t _queue;
+
+    // Owns the slab, and is what slices reference.
+    dispatch_data_t _slab;
+    uint8_t *_slabBytes;
+    size_t _slabCapacity;
+
+    size_t _readOffset;
+    size_t _writeOffset;
+}
+
+- (instancetype)initWithBufferPool:(ARTSRBufferPool *)bufferPool queue:(dispatch_queue_t)queue
+{
+    self = [super init];
+    if (self) {
+        _bufferPool = bufferPool;
+        _queue = queue;
+    }
+    return self;
+}
+
+// Enough for a few reads, and a whole TLS record.
+static size_t ARTSRReadBufferMinimumCapacity(void) {
+    return MAX(ARTSRDefaultBufferSize() * 4, (size_t)16 * 1024);
+}
+
+- (size_t)length
+{
+    return _writeOffset - _readOffset;
+}
+
+- (uint8_t *)bytes
+{
+    return _slabBytes + _readOffset;
+}
+
+// Moves the unread bytes to the start of a new slab of at least `capacity` bytes.
+- (BOOL)_moveToSlabWithCapacity:(size_t)capacity
+{
+    const size_t length = self.length;
+    capacity = MAX(MAX(capacity, length), ARTSRReadBufferMinimumCapacity());
+
+    size_t slabCapacity = 0;
+    uint8_t *const slabBytes = [_bufferPool bufferWithCapacity:capacity actualCapacity:&slabCapacity];
+    if (!slabBytes) {
+        return NO;
+    }
+    if (length > 0) {
+        memcpy(slabBytes, _slabBytes + _readOffset, length);
+    }
+
+    ARTSRBufferPool *const bufferPool = _bufferPool;
+    _slab = dispatch_data_create(slabBytes, slabCapacity, _queue, ^{
+        [bufferPool relinquishBuffer:slabBytes capacity:slabCapacity];
+    });
+    _slabBytes = slabBytes;
+    _slabCapacity = slabCapacity;
+    _readOffset = 0;
+    _writeOffset = length;
+    return YES;
+}
+
+- (uint8_t *)spaceForWritingWithMinimumLength:(size_t)minimumLength available:(size_t *)available
+{
+    // Doubling the room for the unread bytes, so that a payload longer than was reserved for it is copied a logarithmic number of times as it arrives.
+    if (_slabCapacity - _writeOffset < minimumLength && ![self _moveToSlabWithCapacity:MAX(self.length * 2, self.length + minimumLength)]) {
+        return NULL;
+    }
+    *available = _slabCapacity - _writeOffset;
+    return _slabBytes + _writeOffset;
+}
+
+- (void)didWriteLength:(size_t)length
+{
+    assert(length <= _slabCapacity - _writeOffset);
+    _writeOffset += length;
+}
+
+- (BOOL)reserveCapacity:(size_t)capacity
+{
+    if (_slabCapacity - _readOffset >= capacity) {
+        return YES;
+    }
+    return [self _moveToSlabWithCapacity:capacity];
+}
+
+- (dispatch_data_t)sliceWithLength:(size_t)length
+{
+    assert(length <= self.length);
+    if (length == 0) {
+        return dispatch_data_empty;
+    }
+    return dispatch_data_create_subrange(_slab, _readOffset, length);
+}
+
+- (void)consumeLength:(size_t)length
+{
+    assert(length <= self.length);
+    _readOffset += length;
+}
+
+- (void)reset
+{
+    _slab = nil;
+    _slabBytes = NULL;
+    _slabCapacity = 0;
+    _readOffset = 0;
+    _writeOffset = 0;
+}
+
+@end
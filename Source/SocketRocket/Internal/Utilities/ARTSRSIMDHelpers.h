@@ -9,6 +9,26 @@
 
 #import <Foundation/Foundation.h>
 
+/**
+ The implementations of masking, by instruction set.
+ */
+typedef NS_ENUM(NSInteger, ARTSRMaskKernel) {
+    ARTSRMaskKernelScalar, // 64-bit words, available everywhere
+    ARTSRMaskKernelSSE2,
+    ARTSRMaskKernelAVX2,
+    ARTSRMaskKernelNEON,
+};
+
+/**
+ Whether a kernel can run on this CPU.
+ */
+BOOL ARTSRMaskKernelIsAvailable(ARTSRMaskKernel kernel);
+
+/**
+ The fastest kernel available on this CPU, which `ARTSRMaskBytesSIMD` uses. Chosen on first use.
+ */
+ARTSRMaskKernel ARTSRMaskKernelDefault(void);
+
 /**
  Unmask bytes using XOR via SIMD.
 
@@ -17,3 +37,71 @@
  @param maskKey The mask to XOR with MUST be of length sizeof(uint32_t).
  */
 void ARTSRMaskBytesSIMD(uint8_t *bytes, size_t length, uint8_t *maskKey);
+
+/**
+ Copy bytes while masking them, in a single pass.
+
+ @param dst     Where to write the masked bytes. MUST NOT overlap `src`.
+ @param src     The bytes to mask.
+ @param length  The number of bytes to mask.
+ @param maskKey The mask to XOR with MUST be of length sizeof(uint32_t).
+ */
+void ARTSRMaskCopyBytesSIMD(uint8_t *dst, const uint8_t *src, size_t length, uint8_t *maskKey);
+
+/**
+ Unmask bytes using XOR with the given kernel, which MUST be available.
+ */
+void ARTSRMaskBytesWithKernel(ARTSRMaskKernel kernel, uint8_t *bytes, size_t length, uint8_t *maskKey);
+
+/**
+ The implementations of UTF-8 validation, by instruction set.
+ */
+typedef NS_ENUM(NSInteger, ARTSRUTF8Kernel) {
+    ARTSRUTF8KernelScalar, // the same algorithm, a byte at a time, available everywhere
+    ARTSRUTF8KernelSSSE3,
+    ARTSRUTF8KernelNEON,
+};
+
+/**
+ Whether a kernel can run on this CPU.
+ */
+BOOL ARTSRUTF8KernelIsAvailable(ARTSRUTF8Kernel kernel);
+
+/**
+ The fastest kernel available on this CPU, which `ARTSRUTF8ValidationUpdate` uses. Chosen on first use.
+ */
+ARTSRUTF8Kernel ARTSRUTF8KernelDefault(void);
+
+/**
+ The state of the validation of UTF-8 text that arrives in chunks, such as the frames of a message, which are validated as they arrive, without scanning them again.
+
+ Blocks of 16 bytes are validated by looking up, for each byte and the ones before it, which errors they could be part of (as described in "Validating UTF-8 In Less Than One Instruction Per Byte", Keiser and Lemire), and blocks of ASCII are skipped.
+ */
+typedef struct {
+    uint8_t previousBlock[16]; // The last block validated, whose last bytes may begin a character that the next block ends.
+    uint8_t pendingBytes[16]; // The bytes received that don't make a whole block yet.
+    uint8_t pendingLength;
+    BOOL failed;
+} ARTSRUTF8Validation;
+
+void ARTSRUTF8ValidationReset(ARTSRUTF8Validation *validation);
+
+/**
+ Validates the next bytes of the text. Returns NO once the text is known to be invalid.
+ */
+BOOL ARTSRUTF8ValidationUpdate(ARTSRUTF8Validation *validation, const uint8_t *bytes, size_t length);
+
+/**
+ Validates the next bytes of the text with the given kernel, which MUST be available.
+ */
+BOOL ARTSRUTF8ValidationUpdateWithKernel(ARTSRUTF8Kernel kernel, ARTSRUTF8Validation *validation, const uint8_t *bytes, size_t length);
+
+/**
+ Validates the end of the text, which mustn't cut a character short. Returns whether the whole text is valid.
+ */
+BOOL ARTSRUTF8ValidationFinish(ARTSRUTF8Validation *validation);
+
+/**
+ Whether bytes are valid UTF-8, as a whole.
+ */
+BOOL ARTSRUTF8IsValid(const uint8_t *bytes, size_t length);
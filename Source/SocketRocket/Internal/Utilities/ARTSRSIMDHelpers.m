@@ -9,65 +9,524 @@
 
 #import "ARTSRSIMDHelpers.h"
 
-typedef uint8_t uint8x32_t __attribute__((vector_size(32)));
+#include <sys/sysctl.h>
 
-static void ARTSRMaskBytesManual(uint8_t *bytes, size_t length, uint8_t *maskKey) {
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ARTSR_MASK_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ARTSR_MASK_NEON 1
+#endif
+
+// The kernels take the mask as a word, so that its bytes are in memory order, and process whole words until the tail.
+// Loads and stores are unaligned, so there's no head to mask separately and the mask never needs rotating.
+// They read from `src` and write to `dst`, which are either the same or don't overlap, so that copying and masking take a single pass.
+typedef void (*ARTSRMaskFunction)(uint8_t *dst, const uint8_t *src, size_t length, uint32_t mask);
+
+static inline void ARTSRMaskTail(uint8_t *dst, const uint8_t *src, size_t length, uint32_t mask) {
+    const uint8_t *const maskBytes = (const uint8_t *)&mask;
     for (size_t i = 0; i < length; i++) {
-        bytes[i] = bytes[i] ^ maskKey[i % sizeof(uint32_t)];
+        dst[i] = src[i] ^ maskBytes[i & 3];
+    }
+}
+
+static inline void ARTSRMaskWord64(uint8_t *dst, const uint8_t *src, uint64_t mask) {
+    uint64_t word;
+    memcpy(&word, src, sizeof(word));
+    word ^= mask;
+    memcpy(dst, &word, sizeof(word));
+}
+
+static void ARTSRMaskScalar(uint8_t *dst, const uint8_t *src, size_t length, uint32_t mask) {
+    const uint64_t mask64 = ((uint64_t)mask << 32) | mask;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        ARTSRMaskWord64(dst + i, src + i, mask64);
+        ARTSRMaskWord64(dst + i + 8, src + i + 8, mask64);
+        ARTSRMaskWord64(dst + i + 16, src + i + 16, mask64);
+        ARTSRMaskWord64(dst + i + 24, src + i + 24, mask64);
+    }
+    for (; i + 8 <= length; i += 8) {
+        ARTSRMaskWord64(dst + i, src + i, mask64);
+    }
+    ARTSRMaskTail(dst + i, src + i, length - i, mask);
+}
+
+#if ARTSR_MASK_X86
+
+static void ARTSRMaskSSE2(uint8_t *dst, const uint8_t *src, size_t length, uint32_t mask) {
+    const __m128i maskVector = _mm_set1_epi32((int)mask);
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        const __m128i *const s = (const __m128i *)(src + i);
+        __m128i *const d = (__m128i *)(dst + i);
+        const __m128i v0 = _mm_loadu_si128(s), v1 = _mm_loadu_si128(s + 1), v2 = _mm_loadu_si128(s + 2), v3 = _mm_loadu_si128(s + 3);
+        _mm_storeu_si128(d, _mm_xor_si128(v0, maskVector));
+        _mm_storeu_si128(d + 1, _mm_xor_si128(v1, maskVector));
+        _mm_storeu_si128(d + 2, _mm_xor_si128(v2, maskVector));
+        _mm_storeu_si128(d + 3, _mm_xor_si128(v3, maskVector));
+    }
+    for (; i + 16 <= length; i += 16) {
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), maskVector));
+    }
+    ARTSRMaskScalar(dst + i, src + i, length - i, mask);
+}
+
+__attribute__((target("avx2")))
+static void ARTSRMaskAVX2(uint8_t *dst, const uint8_t *src, size_t length, uint32_t mask) {
+    const __m256i maskVector = _mm256_set1_epi32((int)mask);
+    size_t i = 0;
+    for (; i + 128 <= length; i += 128) {
+        const __m256i *const s = (const __m256i *)(src + i);
+        __m256i *const d = (__m256i *)(dst + i);
+        const __m256i v0 = _mm256_loadu_si256(s), v1 = _mm256_loadu_si256(s + 1), v2 = _mm256_loadu_si256(s + 2), v3 = _mm256_loadu_si256(s + 3);
+        _mm256_storeu_si256(d, _mm256_xor_si256(v0, maskVector));
+        _mm256_storeu_si256(d + 1, _mm256_xor_si256(v1, maskVector));
+        _mm256_storeu_si256(d + 2, _mm256_xor_si256(v2, maskVector));
+        _mm256_storeu_si256(d + 3, _mm256_xor_si256(v3, maskVector));
+    }
+    for (; i + 32 <= length; i += 32) {
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(src + i)), maskVector));
+    }
+    ARTSRMaskSSE2(dst + i, src + i, length - i, mask);
+}
+
+#endif
+
+#if ARTSR_MASK_NEON
+
+static void ARTSRMaskNEON(uint8_t *dst, const uint8_t *src, size_t length, uint32_t mask) {
+    const uint8x16_t maskVector = vreinterpretq_u8_u32(vdupq_n_u32(mask));
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        const uint8_t *const s = src + i;
+        uint8_t *const d = dst + i;
+        const uint8x16_t v0 = vld1q_u8(s), v1 = vld1q_u8(s + 16), v2 = vld1q_u8(s + 32), v3 = vld1q_u8(s + 48);
+        vst1q_u8(d, veorq_u8(v0, maskVector));
+        vst1q_u8(d + 16, veorq_u8(v1, maskVector));
+        vst1q_u8(d + 32, veorq_u8(v2, maskVector));
+        vst1q_u8(d + 48, veorq_u8(v3, maskVector));
+    }
+    for (; i + 16 <= length; i += 16) {
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(src + i), maskVector));
     }
+    ARTSRMaskScalar(dst + i, src + i, length - i, mask);
 }
 
-/**
- Right-shift the elements of a vector, circularly.
+#endif
 
- @param vector The vector to circular shift.
- @param by     The number of elements to shift by.
+static BOOL ARTSRCPUHasFeature(const char *name) {
+    int value = 0;
+    size_t size = sizeof(value);
+    return sysctlbyname(name, &value, &size, NULL, 0) == 0 && value != 0;
+}
 
- @return A shifted vector.
- */
-static uint8x32_t ARTSRShiftVector(uint8x32_t vector, size_t by) {
-    uint8x32_t vectorCopy = vector;
-    by = by % _Alignof(uint8x32_t);
+BOOL ARTSRMaskKernelIsAvailable(ARTSRMaskKernel kernel) {
+    switch (kernel) {
+        case ARTSRMaskKernelScalar:
+            return YES;
+#if ARTSR_MASK_X86
+        case ARTSRMaskKernelSSE2:
+            return ARTSRCPUHasFeature("hw.optional.sse2");
+        case ARTSRMaskKernelAVX2:
+            return ARTSRCPUHasFeature("hw.optional.avx2_0");
+#endif
+#if ARTSR_MASK_NEON
+        case ARTSRMaskKernelNEON:
+            return YES;
+#endif
+        default:
+            return NO;
+    }
+}
 
-    uint8_t *vectorPointer = (uint8_t *)&vector;
-    uint8_t *vectorCopyPointer = (uint8_t *)&vectorCopy;
+static ARTSRMaskFunction ARTSRMaskFunctionOfKernel(ARTSRMaskKernel kernel) {
+    switch (kernel) {
+#if ARTSR_MASK_X86
+        case ARTSRMaskKernelSSE2:
+            return ARTSRMaskSSE2;
+        case ARTSRMaskKernelAVX2:
+            return ARTSRMaskAVX2;
+#endif
+#if ARTSR_MASK_NEON
+        case ARTSRMaskKernelNEON:
+            return ARTSRMaskNEON;
+#endif
+        default:
+            return ARTSRMaskScalar;
+    }
+}
+
+static ARTSRMaskKernel ARTSRDefaultKernel;
+static ARTSRMaskFunction ARTSRDefaultMaskFunction;
 
-    memmove(vectorPointer + by, vectorPointer, sizeof(vector) - by);
-    memcpy(vectorPointer, vectorCopyPointer + (sizeof(vector) - by), by);
+static void ARTSRChooseDefaultKernel(void) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        const ARTSRMaskKernel fastestFirst[] = { ARTSRMaskKernelAVX2, ARTSRMaskKernelNEON, ARTSRMaskKernelSSE2, ARTSRMaskKernelScalar };
+        for (size_t i = 0; i < sizeof(fastestFirst) / sizeof(fastestFirst[0]); i++) {
+            if (ARTSRMaskKernelIsAvailable(fastestFirst[i])) {
+                ARTSRDefaultKernel = fastestFirst[i];
+                break;
+            }
+        }
+        ARTSRDefaultMaskFunction = ARTSRMaskFunctionOfKernel(ARTSRDefaultKernel);
+    });
+}
 
-    return vector;
+ARTSRMaskKernel ARTSRMaskKernelDefault(void) {
+    ARTSRChooseDefaultKernel();
+    return ARTSRDefaultKernel;
 }
 
 void ARTSRMaskBytesSIMD(uint8_t *bytes, size_t length, uint8_t *maskKey) {
-    size_t alignmentBytes = _Alignof(uint8x32_t) - ((uintptr_t)bytes % _Alignof(uint8x32_t));
-    if (alignmentBytes == _Alignof(uint8x32_t)) {
-        alignmentBytes = 0;
+    ARTSRChooseDefaultKernel();
+    uint32_t mask;
+    memcpy(&mask, maskKey, sizeof(mask));
+    ARTSRDefaultMaskFunction(bytes, bytes, length, mask);
+}
+
+void ARTSRMaskCopyBytesSIMD(uint8_t *dst, const uint8_t *src, size_t length, uint8_t *maskKey) {
+    ARTSRChooseDefaultKernel();
+    uint32_t mask;
+    memcpy(&mask, maskKey, sizeof(mask));
+    ARTSRDefaultMaskFunction(dst, src, length, mask);
+}
+
+void ARTSRMaskBytesWithKernel(ARTSRMaskKernel kernel, uint8_t *bytes, size_t length, uint8_t *maskKey) {
+    uint32_t mask;
+    memcpy(&mask, maskKey, sizeof(mask));
+    ARTSRMaskFunctionOfKernel(kernel)(bytes, bytes, length, mask);
+}
+
+#pragma mark - UTF-8 validation
+
+#if ARTSR_MASK_NEON && defined(__aarch64__)
+#define ARTSR_UTF8_NEON 1
+#endif
+
+// Which errors a byte, the one before it and the high nibble of the one after can be part of.
+// A pair of bytes is invalid if the three lookups share an error; the 3rd and 4th bytes of characters are checked separately.
+enum {
+    ARTSRUTF8TooShort = 1 << 0, // 11______ 0_______ or 11______ 11______
+    ARTSRUTF8TooLong = 1 << 1, // 0_______ 10______
+    ARTSRUTF8Overlong3 = 1 << 2, // 11100000 100_____
+    ARTSRUTF8TooLarge = 1 << 3, // 11110100 1001____, 11110100 101_____ or 11110101+ 1001____
+    ARTSRUTF8Surrogate = 1 << 4, // 11101101 101_____
+    ARTSRUTF8Overlong2 = 1 << 5, // 1100000_ 10______
+    ARTSRUTF8TooLarge1000 = 1 << 6, // 11110101+ 1000____
+    ARTSRUTF8Overlong4 = 1 << 6, // 11110000 1000____
+    ARTSRUTF8TwoContinuations = 1 << 7, // 10______ 10______
+    ARTSRUTF8Carry = ARTSRUTF8TooShort | ARTSRUTF8TooLong | ARTSRUTF8TwoContinuations,
+};
+
+// By the high nibble of the first byte of a pair.
+static const uint8_t ARTSRUTF8FirstHighNibbleErrors[16] = {
+    ARTSRUTF8TooLong, ARTSRUTF8TooLong, ARTSRUTF8TooLong, ARTSRUTF8TooLong,
+    ARTSRUTF8TooLong, ARTSRUTF8TooLong, ARTSRUTF8TooLong, ARTSRUTF8TooLong,
+    ARTSRUTF8TwoContinuations, ARTSRUTF8TwoContinuations, ARTSRUTF8TwoContinuations, ARTSRUTF8TwoContinuations,
+    ARTSRUTF8TooShort | ARTSRUTF8Overlong2,
+    ARTSRUTF8TooShort,
+    ARTSRUTF8TooShort | ARTSRUTF8Overlong3 | ARTSRUTF8Surrogate,
+    ARTSRUTF8TooShort | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000 | ARTSRUTF8Overlong4,
+};
+
+// By the low nibble of the first byte of a pair.
+static const uint8_t ARTSRUTF8FirstLowNibbleErrors[16] = {
+    ARTSRUTF8Carry | ARTSRUTF8Overlong3 | ARTSRUTF8Overlong2 | ARTSRUTF8Overlong4,
+    ARTSRUTF8Carry | ARTSRUTF8Overlong2,
+    ARTSRUTF8Carry,
+    ARTSRUTF8Carry,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000 | ARTSRUTF8Surrogate,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+    ARTSRUTF8Carry | ARTSRUTF8TooLarge | ARTSRUTF8TooLarge1000,
+};
+
+// By the high nibble of the second byte of a pair.
+static const uint8_t ARTSRUTF8SecondHighNibbleErrors[16] = {
+    ARTSRUTF8TooShort, ARTSRUTF8TooShort, ARTSRUTF8TooShort, ARTSRUTF8TooShort,
+    ARTSRUTF8TooShort, ARTSRUTF8TooShort, ARTSRUTF8TooShort, ARTSRUTF8TooShort,
+    ARTSRUTF8TooLong | ARTSRUTF8Overlong2 | ARTSRUTF8TwoContinuations | ARTSRUTF8Overlong3 | ARTSRUTF8TooLarge1000 | ARTSRUTF8Overlong4,
+    ARTSRUTF8TooLong | ARTSRUTF8Overlong2 | ARTSRUTF8TwoContinuations | ARTSRUTF8Overlong3 | ARTSRUTF8TooLarge,
+    ARTSRUTF8TooLong | ARTSRUTF8Overlong2 | ARTSRUTF8TwoContinuations | ARTSRUTF8Surrogate | ARTSRUTF8TooLarge,
+    ARTSRUTF8TooLong | ARTSRUTF8Overlong2 | ARTSRUTF8TwoContinuations | ARTSRUTF8Surrogate | ARTSRUTF8TooLarge,
+    ARTSRUTF8TooShort, ARTSRUTF8TooShort, ARTSRUTF8TooShort, ARTSRUTF8TooShort,
+};
+
+// A block ends in the middle of a character if one of its last 3 bytes begins a character longer than what's left.
+static const uint8_t ARTSRUTF8IncompleteThresholds[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+// The kernels validate whole blocks of 16 bytes, continuing from `previousBlock`, which they replace with the last block.
+typedef BOOL (*ARTSRUTF8Function)(uint8_t *previousBlock, const uint8_t *bytes, size_t blockCount);
+
+static inline uint8_t ARTSRSaturatingSubtract(uint8_t a, uint8_t b) {
+    return a > b ? a - b : 0;
+}
+
+static BOOL ARTSRUTF8BlockIsIncomplete(const uint8_t *block) {
+    return block[13] >= 0xF0 || block[14] >= 0xE0 || block[15] >= 0xC0;
+}
+
+static BOOL ARTSRUTF8Scalar(uint8_t *previousBlock, const uint8_t *bytes, size_t blockCount) {
+    uint8_t error = 0;
+    uint8_t window[32]; // the previous block, then the current one
+    memcpy(window, previousBlock, 16);
+    for (size_t block = 0; block < blockCount; block++) {
+        const uint8_t *const input = bytes + block * 16;
+        memcpy(window + 16, input, 16);
+
+        uint64_t words[2];
+        memcpy(words, input, sizeof(words));
+        if (((words[0] | words[1]) & 0x8080808080808080ULL) == 0) {
+            error |= ARTSRUTF8BlockIsIncomplete(window);
+        } else {
+            for (size_t i = 16; i < 32; i++) {
+                const uint8_t prev1 = window[i - 1], prev2 = window[i - 2], prev3 = window[i - 3];
+                const uint8_t specialCases = ARTSRUTF8FirstHighNibbleErrors[prev1 >> 4] & ARTSRUTF8FirstLowNibbleErrors[prev1 & 0x0F] & ARTSRUTF8SecondHighNibbleErrors[window[i] >> 4];
+                const uint8_t mustBeContinuation = (ARTSRSaturatingSubtract(prev2, 0xE0 - 0x80) | ARTSRSaturatingSubtract(prev3, 0xF0 - 0x80)) & 0x80;
+                error |= mustBeContinuation ^ specialCases;
+            }
+        }
+        memcpy(window, window + 16, 16);
     }
+    memcpy(previousBlock, window, 16);
+    return error == 0;
+}
+
+#if ARTSR_MASK_X86
 
-    // If the number of bytes that can be processed after aligning is
-    // less than the number of bytes we can put into a vector,
-    // then there's no work to do with SIMD, just call the manual version.
-    if (alignmentBytes > length || (length - alignmentBytes) < sizeof(uint8x32_t)) {
-        ARTSRMaskBytesManual(bytes, length, maskKey);
-        return;
+__attribute__((target("ssse3")))
+static BOOL ARTSRUTF8SSSE3(uint8_t *previousBlock, const uint8_t *bytes, size_t blockCount) {
+    const __m128i firstHighNibbleErrors = _mm_loadu_si128((const __m128i *)ARTSRUTF8FirstHighNibbleErrors);
+    const __m128i firstLowNibbleErrors = _mm_loadu_si128((const __m128i *)ARTSRUTF8FirstLowNibbleErrors);
+    const __m128i secondHighNibbleErrors = _mm_loadu_si128((const __m128i *)ARTSRUTF8SecondHighNibbleErrors);
+    const __m128i incompleteThresholds = _mm_loadu_si128((const __m128i *)ARTSRUTF8IncompleteThresholds);
+    const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+
+    __m128i previous = _mm_loadu_si128((const __m128i *)previousBlock);
+    __m128i previousIncomplete = _mm_subs_epu8(previous, incompleteThresholds);
+    __m128i error = _mm_setzero_si128();
+    size_t block = 0;
+    while (block < blockCount) {
+        const __m128i *const p = (const __m128i *)(bytes + block * 16);
+        // Skip 4 blocks of ASCII at once, then 1.
+        if (block + 4 <= blockCount) {
+            const __m128i last = _mm_loadu_si128(p + 3);
+            const __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)), _mm_or_si128(_mm_loadu_si128(p + 2), last));
+            if (_mm_movemask_epi8(any) == 0) {
+                error = _mm_or_si128(error, previousIncomplete);
+                previousIncomplete = _mm_setzero_si128();
+                previous = last;
+                block += 4;
+                continue;
+            }
+        }
+        const __m128i input = _mm_loadu_si128(p);
+        if (_mm_movemask_epi8(input) == 0) {
+            error = _mm_or_si128(error, previousIncomplete);
+            previousIncomplete = _mm_setzero_si128();
+        } else {
+            const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+            const __m128i specialCases = _mm_and_si128(_mm_and_si128(
+                _mm_shuffle_epi8(firstHighNibbleErrors, _mm_and_si128(_mm_srli_epi16(prev1, 4), lowNibbles)),
+                _mm_shuffle_epi8(firstLowNibbleErrors, _mm_and_si128(prev1, lowNibbles))),
+                _mm_shuffle_epi8(secondHighNibbleErrors, _mm_and_si128(_mm_srli_epi16(input, 4), lowNibbles)));
+            const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+            const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+            const __m128i mustBeContinuation = _mm_and_si128(_mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)), _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80))), _mm_set1_epi8((char)0x80));
+            error = _mm_or_si128(error, _mm_xor_si128(mustBeContinuation, specialCases));
+            previousIncomplete = _mm_subs_epu8(input, incompleteThresholds);
+        }
+        previous = input;
+        block++;
     }
+    _mm_storeu_si128((__m128i *)previousBlock, previous);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
 
-    size_t vectorLength = (length - alignmentBytes) / sizeof(uint8x32_t);
-    size_t manualStartOffset = alignmentBytes + (vectorLength * sizeof(uint8x32_t));
-    size_t manualLength = length - manualStartOffset;
+#endif
 
-    uint8x32_t *vector = (uint8x32_t *)(bytes + alignmentBytes);
-    uint8x32_t maskVector = { };
+#if ARTSR_UTF8_NEON
 
-    memset_pattern4(&maskVector, maskKey, sizeof(uint8x32_t));
-    maskVector = ARTSRShiftVector(maskVector, alignmentBytes);
+static BOOL ARTSRUTF8NEON(uint8_t *previousBlock, const uint8_t *bytes, size_t blockCount) {
+    const uint8x16_t firstHighNibbleErrors = vld1q_u8(ARTSRUTF8FirstHighNibbleErrors);
+    const uint8x16_t firstLowNibbleErrors = vld1q_u8(ARTSRUTF8FirstLowNibbleErrors);
+    const uint8x16_t secondHighNibbleErrors = vld1q_u8(ARTSRUTF8SecondHighNibbleErrors);
+    const uint8x16_t incompleteThresholds = vld1q_u8(ARTSRUTF8IncompleteThresholds);
+    const uint8x16_t lowNibbles = vdupq_n_u8(0x0F);
 
-    ARTSRMaskBytesManual(bytes, alignmentBytes, maskKey);
+    uint8x16_t previous = vld1q_u8(previousBlock);
+    uint8x16_t previousIncomplete = vqsubq_u8(previous, incompleteThresholds);
+    uint8x16_t error = vdupq_n_u8(0);
+    size_t block = 0;
+    while (block < blockCount) {
+        const uint8_t *const p = bytes + block * 16;
+        // Skip 4 blocks of ASCII at once, then 1.
+        if (block + 4 <= blockCount) {
+            const uint8x16_t last = vld1q_u8(p + 48);
+            const uint8x16_t any = vorrq_u8(vorrq_u8(vld1q_u8(p), vld1q_u8(p + 16)), vorrq_u8(vld1q_u8(p + 32), last));
+            if (vmaxvq_u8(any) < 0x80) {
+                error = vorrq_u8(error, previousIncomplete);
+                previousIncomplete = vdupq_n_u8(0);
+                previous = last;
+                block += 4;
+                continue;
+            }
+        }
+        const uint8x16_t input = vld1q_u8(p);
+        if (vmaxvq_u8(input) < 0x80) {
+            error = vorrq_u8(error, previousIncomplete);
+            previousIncomplete = vdupq_n_u8(0);
+        } else {
+            const uint8x16_t prev1 = vextq_u8(previous, input, 15);
+            const uint8x16_t specialCases = vandq_u8(vandq_u8(
+                vqtbl1q_u8(firstHighNibbleErrors, vshrq_n_u8(prev1, 4)),
+                vqtbl1q_u8(firstLowNibbleErrors, vandq_u8(prev1, lowNibbles))),
+                vqtbl1q_u8(secondHighNibbleErrors, vshrq_n_u8(input, 4)));
+            const uint8x16_t prev2 = vextq_u8(previous, input, 14);
+            const uint8x16_t prev3 = vextq_u8(previous, input, 13);
+            const uint8x16_t mustBeContinuation = vandq_u8(vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80)), vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80))), vdupq_n_u8(0x80));
+            error = vorrq_u8(error, veorq_u8(mustBeContinuation, specialCases));
+            previousIncomplete = vqsubq_u8(input, incompleteThresholds);
+        }
+        previous = input;
+        block++;
+    }
+    vst1q_u8(previousBlock, previous);
+    return vmaxvq_u8(error) == 0;
+}
+
+#endif
+
+BOOL ARTSRUTF8KernelIsAvailable(ARTSRUTF8Kernel kernel) {
+    switch (kernel) {
+        case ARTSRUTF8KernelScalar:
+            return YES;
+#if ARTSR_MASK_X86
+        case ARTSRUTF8KernelSSSE3:
+            return ARTSRCPUHasFeature("hw.optional.supplementalsse3");
+#endif
+#if ARTSR_UTF8_NEON
+        case ARTSRUTF8KernelNEON:
+            return YES;
+#endif
+        default:
+            return NO;
+    }
+}
 
-    for (size_t vectorIndex = 0; vectorIndex < vectorLength; vectorIndex++) {
-        vector[vectorIndex] = vector[vectorIndex] ^ maskVector;
+static ARTSRUTF8Function ARTSRUTF8FunctionOfKernel(ARTSRUTF8Kernel kernel) {
+    switch (kernel) {
+#if ARTSR_MASK_X86
+        case ARTSRUTF8KernelSSSE3:
+            return ARTSRUTF8SSSE3;
+#endif
+#if ARTSR_UTF8_NEON
+        case ARTSRUTF8KernelNEON:
+            return ARTSRUTF8NEON;
+#endif
+        default:
+            return ARTSRUTF8Scalar;
     }
+}
+
+static ARTSRUTF8Kernel ARTSRDefaultUTF8Kernel;
+static ARTSRUTF8Function ARTSRDefaultUTF8Function;
+
+static void ARTSRChooseDefaultUTF8Kernel(void) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        const ARTSRUTF8Kernel fastestFirst[] = { ARTSRUTF8KernelNEON, ARTSRUTF8KernelSSSE3, ARTSRUTF8KernelScalar };
+        for (size_t i = 0; i < sizeof(fastestFirst) / sizeof(fastestFirst[0]); i++) {
+            if (ARTSRUTF8KernelIsAvailable(fastestFirst[i])) {
+                ARTSRDefaultUTF8Kernel = fastestFirst[i];
+                break;
+            }
+        }
+        ARTSRDefaultUTF8Function = ARTSRUTF8FunctionOfKernel(ARTSRDefaultUTF8Kernel);
+    });
+}
+
+ARTSRUTF8Kernel ARTSRUTF8KernelDefault(void) {
+    ARTSRChooseDefaultUTF8Kernel();
+    return ARTSRDefaultUTF8Kernel;
+}
+
+void ARTSRUTF8ValidationReset(ARTSRUTF8Validation *validation) {
+    memset(validation, 0, sizeof(*validation));
+}
+
+static BOOL ARTSRUTF8ValidationUpdateWithFunction(ARTSRUTF8Function function, ARTSRUTF8Validation *validation, const uint8_t *bytes, size_t length) {
+    if (validation->failed) {
+        return NO;
+    }
+
+    // Complete the pending block first.
+    if (validation->pendingLength > 0) {
+        const size_t count = MIN(length, sizeof(validation->pendingBytes) - validation->pendingLength);
+        memcpy(validation->pendingBytes + validation->pendingLength, bytes, count);
+        validation->pendingLength += count;
+        bytes += count;
+        length -= count;
+        if (validation->pendingLength < sizeof(validation->pendingBytes)) {
+            return YES;
+        }
+        validation->pendingLength = 0;
+        if (!function(validation->previousBlock, validation->pendingBytes, 1)) {
+            validation->failed = YES;
+            return NO;
+        }
+    }
+
+    const size_t blockCount = length / 16;
+    if (blockCount > 0 && !function(validation->previousBlock, bytes, blockCount)) {
+        validation->failed = YES;
+        return NO;
+    }
+
+    validation->pendingLength = length - blockCount * 16;
+    memcpy(validation->pendingBytes, bytes + blockCount * 16, validation->pendingLength);
+    return YES;
+}
+
+BOOL ARTSRUTF8ValidationUpdate(ARTSRUTF8Validation *validation, const uint8_t *bytes, size_t length) {
+    ARTSRChooseDefaultUTF8Kernel();
+    return ARTSRUTF8ValidationUpdateWithFunction(ARTSRDefaultUTF8Function, validation, bytes, length);
+}
+
+BOOL ARTSRUTF8ValidationUpdateWithKernel(ARTSRUTF8Kernel kernel, ARTSRUTF8Validation *validation, const uint8_t *bytes, size_t length) {
+    return ARTSRUTF8ValidationUpdateWithFunction(ARTSRUTF8FunctionOfKernel(kernel), validation, bytes, length);
+}
+
+BOOL ARTSRUTF8ValidationFinish(ARTSRUTF8Validation *validation) {
+    if (validation->failed) {
+        return NO;
+    }
+    // Padding the pending bytes with ASCII makes a character they cut short an error. Without pending bytes, the last block mustn't cut one short.
+    if (validation->pendingLength > 0) {
+        memset(validation->pendingBytes + validation->pendingLength, 0, sizeof(validation->pendingBytes) - validation->pendingLength);
+        validation->pendingLength = 0;
+        validation->failed = !ARTSRUTF8Scalar(validation->previousBlock, validation->pendingBytes, 1);
+    } else {
+        validation->failed = ARTSRUTF8BlockIsIncomplete(validation->previousBlock);
+    }
+    return !validation->failed;
+}
 
-    // Use the shifted mask for the final manual part.
-    ARTSRMaskBytesManual(bytes + manualStartOffset, manualLength, (uint8_t *) &maskVector);
+BOOL ARTSRUTF8IsValid(const uint8_t *bytes, size_t length) {
+    ARTSRUTF8Validation validation;
+    ARTSRUTF8ValidationReset(&validation);
+    return ARTSRUTF8ValidationUpdate(&validation, bytes, length) && ARTSRUTF8ValidationFinish(&validation);
 }
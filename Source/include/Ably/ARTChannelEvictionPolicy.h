@@ -0,0 +1,80 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Describes why a channel was evicted.
+ */
+typedef NS_ENUM(NSUInteger, ARTChannelEvictionReason) {
+    /**
+     * The channel wasn't used for longer than `ARTChannelEvictionPolicy.idleTimeout`.
+     */
+    ARTChannelEvictionReasonIdle,
+    /**
+     * There were more than `ARTChannelEvictionPolicy.maxChannels` channels.
+     */
+    ARTChannelEvictionReasonCount,
+    /**
+     * The channels were estimated to use more than `ARTChannelEvictionPolicy.maxBytes` of memory.
+     */
+    ARTChannelEvictionReasonSize
+};
+
+/**
+ * Makes the client library release channels that the app no longer uses, instead of keeping them until `-[ARTRealtimeChannelsProtocol release:]` is called.
+ *
+ * A channel is used whenever it is retrieved with `-[ARTRealtimeChannels get:]`, published to, subscribed to or attached. A channel the app still holds an `ARTRealtimeChannel` object for is never evicted, and neither is one with listeners, pending publishes or presence members entered by the client. The others are evicted in least recently used order: first those beyond `maxChannels` or `maxBytes`, then those not used for `idleTimeout`. An evicted channel is detached, then released. If it is used while it is being detached, it is kept, and attached again if it was attached.
+ */
+@interface ARTChannelEvictionPolicy : NSObject <NSCopying>
+
+/**
+ * The time after which an unused channel is evicted. The default is 0, for no limit.
+ */
+@property (readwrite, nonatomic) NSTimeInterval idleTimeout;
+
+/**
+ * The number of channels beyond which the least recently used are evicted. The default is 0, for no limit.
+ */
+@property (readwrite, nonatomic) NSUInteger maxChannels;
+
+/**
+ * The estimated memory use of the channels, in bytes, beyond which the least recently used are evicted. The estimate accounts for the channel objects and their presence members. The default is 0, for no limit.
+ */
+@property (readwrite, nonatomic) NSUInteger maxBytes;
+
+@end
+
+/**
+ * Counts the channels evicted under an `ARTChannelEvictionPolicy`, by reason.
+ */
+@interface ARTChannelEvictionStats : NSObject
+
+/**
+ * The number of channels evicted for not being used for `ARTChannelEvictionPolicy.idleTimeout`.
+ */
+@property (readonly, nonatomic) NSUInteger idleEvictions;
+
+/**
+ * The number of channels evicted for being beyond `ARTChannelEvictionPolicy.maxChannels`.
+ */
+@property (readonly, nonatomic) NSUInteger countEvictions;
+
+/**
+ * The number of channels evicted for being beyond `ARTChannelEvictionPolicy.maxBytes`.
+ */
+@property (readonly, nonatomic) NSUInteger sizeEvictions;
+
+/**
+ * The number of channels evicted for any reason.
+ */
+@property (readonly, nonatomic) NSUInteger totalEvictions;
+
+/// :nodoc:
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/// :nodoc:
+typedef void (^ARTChannelEvictionCallback)(NSString *channelName, ARTChannelEvictionReason reason);
+
+NS_ASSUME_NONNULL_END
@@ -4,6 +4,7 @@
 #import <Ably/ARTLog.h>
 
 @class ARTPlugin;
+@class ARTChannelEvictionPolicy;
 @class ARTStringifiable;
 @protocol ARTPushRegistererDelegate;
 
@@ -107,6 +108,31 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (readwrite, nonatomic) NSTimeInterval channelRetryTimeout;
 
+/**
+ * The maximum number of channels that may be attaching at the same time on a realtime connection. The attaches of further channels, for instance when thousands of channels reattach after the connection is resumed, wait for a free slot before their `ATTACH` messages are sent, and their attach timeouts only start then. The default is 0, for no limit.
+ */
+@property (readwrite, nonatomic) NSUInteger maxConcurrentAttaches;
+
+/**
+ * When `true`, the realtime connection offers to compress the messages it sends and receives with the WebSocket permessage-deflate extension, which reduces the bandwidth used at the cost of some CPU time on both ends. Messages are sent and received uncompressed if Ably doesn't accept the extension. The default is `false`.
+ */
+@property (readwrite, nonatomic) BOOL useWebSocketCompression;
+
+/**
+ * When greater than 0, the realtime connection's WebSocket is driven by dispatch queues instead of the single network thread that all the clients of the process share: its socket events are delivered and handled on one of a pool of this many serial queues, which the clients using the same count share. Processes holding many clients can so spread their connections across cores. The default is 0, for the shared network thread.
+ */
+@property (readwrite, nonatomic) NSUInteger webSocketQueueCount;
+
+/**
+ * When greater than 0, the realtime connection sends the messages longer than this many bytes in several WebSocket frames, so that the replies to the pings that the server sends meanwhile go out in between rather than after the whole message. The default is 0, to send every message in a single frame.
+ */
+@property (readwrite, nonatomic) NSUInteger webSocketMaximumFragmentLength;
+
+/**
+ * When set, realtime channels that are no longer used are detached and released automatically, as described by the policy. The default is `nil`, for channels to be kept until they are released with `-[ARTRealtimeChannelsProtocol release:]`.
+ */
+@property (nullable, readwrite, nonatomic, copy) ARTChannelEvictionPolicy *channelEvictionPolicy;
+
 /**
  * Timeout for opening a connection to Ably to initiate an HTTP request. The default is 4 seconds.
  */
@@ -0,0 +1,67 @@
+#import <Foundation/Foundation.h>
+
+@class ARTPresenceMessage;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * An immutable view of the members present on a channel at a given version of its presence set. Taking a snapshot doesn't copy the presence set: the snapshot shares storage with it until the set next changes.
+ */
+@interface ARTPresenceSnapshot : NSObject
+
+/**
+ * The version of the presence set this snapshot was taken at. Pass it to `-[ARTRealtimePresenceProtocol changesSinceVersion:callback:]` to retrieve what changed afterwards.
+ */
+@property (readonly, nonatomic) NSUInteger version;
+
+/**
+ * The members present on the channel when the snapshot was taken.
+ */
+@property (readonly, nonatomic) NSArray<ARTPresenceMessage *> *members;
+
+/**
+ * Returns the member with the given `clientId` and `connectionId`, or `nil` if it wasn't present when the snapshot was taken.
+ */
+- (nullable ARTPresenceMessage *)memberWithClientId:(NSString *)clientId connectionId:(NSString *)connectionId;
+
+/// :nodoc:
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ * The net changes to the presence set of a channel between two of its versions. A member that entered and left in between appears in neither list.
+ */
+@interface ARTPresenceChanges : NSObject
+
+/**
+ * The version the changes were requested since.
+ */
+@property (readonly, nonatomic) NSUInteger fromVersion;
+
+/**
+ * The current version of the presence set. Pass it as the version of the next request to only receive later changes.
+ */
+@property (readonly, nonatomic) NSUInteger toVersion;
+
+/**
+ * The members that weren't present at `fromVersion` and are at `toVersion`.
+ */
+@property (readonly, nonatomic) NSArray<ARTPresenceMessage *> *entered;
+
+/**
+ * The members that were present at both versions, but whose presence was updated in between.
+ */
+@property (readonly, nonatomic) NSArray<ARTPresenceMessage *> *updated;
+
+/**
+ * The members that were present at `fromVersion` and aren't at `toVersion`, as they were last seen.
+ */
+@property (readonly, nonatomic) NSArray<ARTPresenceMessage *> *left;
+
+/// :nodoc:
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
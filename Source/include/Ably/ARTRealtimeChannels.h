@@ -1,6 +1,7 @@
 #import <Ably/ARTChannels.h>
 #import <Ably/ARTRealtimeChannel.h>
 #import <Ably/ARTRealtime.h>
+#import <Ably/ARTChannelEvictionPolicy.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -22,6 +23,49 @@ NS_ASSUME_NONNULL_BEGIN
 - (ARTRealtimeChannel *)get:(NSString *)name;
 - (ARTRealtimeChannel *)get:(NSString *)name options:(ARTRealtimeChannelOptions *)options;
 
+/**
+ * Creates new `ARTRealtimeChannel` objects, or returns the existing ones, for each of the given channel names, setting or updating their `ARTRealtimeChannelOptions` when given, all at once.
+ *
+ * @param names The names of the channels.
+ * @param options An `ARTRealtimeChannelOptions` object, applied to every channel.
+ *
+ * @return The channels, in the order of `names`.
+ */
+- (NSArray<ARTRealtimeChannel *> *)getAll:(NSArray<NSString *> *)names options:(nullable ARTRealtimeChannelOptions *)options;
+
+/**
+ * Gets the given channels as `getAll:options:` does and subscribes to the messages of each of them as `-[ARTRealtimeChannel subscribeWithAttachCallback:callback:]` does, all at once. As there, only a channel in the `INITIALIZED` state is attached, and a channel in the `FAILED` state is not subscribed to.
+ *
+ * @param names The names of the channels.
+ * @param options An `ARTRealtimeChannelOptions` object, applied to every channel.
+ * @param onAttach An attach callback called once, when every channel to be attached has either attached or failed to; its argument maps the name of each channel that failed to attach, or was `FAILED`, to an `ARTErrorInfo` object, and is `nil` if there are none.
+ * @param callback An event listener function, called with the name of the channel a message was received on and the message.
+ *
+ * @return The event listeners, keyed by channel name, for use with `-[ARTRealtimeChannel unsubscribe:]`. A channel in the `FAILED` state has none.
+ */
+- (NSDictionary<NSString *, ARTEventListener *> *)subscribeAll:(NSArray<NSString *> *)names options:(nullable ARTRealtimeChannelOptions *)options onAttach:(nullable ARTChannelsAttachCallback)onAttach callback:(ARTChannelMessageCallback)callback;
+
+/**
+ * The numbers of channels evicted so far under `ARTClientOptions.channelEvictionPolicy`.
+ */
+@property (readonly, nonatomic) ARTChannelEvictionStats *evictionStats;
+
+/**
+ * Registers a listener that is called each time a channel is evicted under `ARTClientOptions.channelEvictionPolicy`.
+ *
+ * @param callback Called with the name of the evicted channel and the reason it was evicted.
+ *
+ * @return An event listener object, to pass to `offEviction:`.
+ */
+- (ARTEventListener *)onEviction:(ARTChannelEvictionCallback)callback;
+
+/**
+ * Deregisters a listener registered with `onEviction:`.
+ *
+ * @param listener An event listener object.
+ */
+- (void)offEviction:(ARTEventListener *)listener;
+
 /**
  * Iterates through the existing channels.
  *
@@ -40,6 +40,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)get:(ARTRealtimePresenceQuery *)query callback:(ARTPresenceMessagesCallback)callback;
 
+/**
+ * Retrieves an immutable snapshot of the members currently present on the channel, along with the version of the presence set it was taken at. Unlike `get:`, this neither attaches the channel nor waits for a sync to complete, and doesn't copy the presence set.
+ *
+ * @param callback A callback for retrieving an `ARTPresenceSnapshot` object.
+ */
+- (void)snapshot:(ARTPresenceSnapshotCallback)callback;
+
+/**
+ * Retrieves the members that entered, were updated or left since a given version of the presence set, such as the `version` of an `ARTPresenceSnapshot`. If those changes are no longer known, the callback receives an error with code `ARTErrorPresenceStateIsOutOfSync`; take a new snapshot instead.
+ *
+ * @param version A version of the presence set.
+ * @param callback A callback for retrieving an `ARTPresenceChanges` object.
+ */
+- (void)changesSinceVersion:(NSUInteger)version callback:(ARTPresenceChangesCallback)callback;
+
 /**
  * Enters the presence set for the channel, optionally passing a `data` payload. A `clientId` is required to be present on a channel.
  *
@@ -136,6 +151,30 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)leaveClient:(NSString *)clientId data:(id _Nullable)data callback:(nullable ARTCallback)callback;
 
+/**
+ * Enters the presence set on behalf of several clients at once. Each member provides the `clientId` to enter with and, optionally, its `data` payload. The members are packed into as few protocol messages as the maximum message size allows, so that a batch is usually sent and acknowledged as a single message. Every member must have a `clientId`.
+ *
+ * @param members The `ARTPresenceMessage` objects giving the `clientId` and `data` of each member.
+ * @param callback Called once the presence of every member has been acknowledged or has failed, with the error for each `clientId` that failed, or `nil` if none did.
+ */
+- (void)enterClients:(NSArray<ARTPresenceMessage *> *)members callback:(nullable ARTPresenceClientsCallback)callback;
+
+/**
+ * Updates the `data` payload of several presence members at once. See `enterClients:callback:`.
+ *
+ * @param members The `ARTPresenceMessage` objects giving the `clientId` and `data` of each member.
+ * @param callback Called once the presence of every member has been acknowledged or has failed, with the error for each `clientId` that failed, or `nil` if none did.
+ */
+- (void)updateClients:(NSArray<ARTPresenceMessage *> *)members callback:(nullable ARTPresenceClientsCallback)callback;
+
+/**
+ * Leaves the presence set on behalf of several clients at once. See `enterClients:callback:`.
+ *
+ * @param members The `ARTPresenceMessage` objects giving the `clientId` and `data` of each member.
+ * @param callback Called once the presence of every member has been acknowledged or has failed, with the error for each `clientId` that failed, or `nil` if none did.
+ */
+- (void)leaveClients:(NSArray<ARTPresenceMessage *> *)members callback:(nullable ARTPresenceClientsCallback)callback;
+
 /**
  * Registers a listener that is called each time a `ARTPresenceMessage` is received on the channel, such as a new member entering the presence set.
  *
@@ -176,6 +215,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (ARTEventListener *_Nullable)subscribe:(ARTPresenceAction)action onAttach:(nullable ARTCallback)onAttach callback:(ARTPresenceMessageCallback)callback;
 
+/**
+ * Registers a listener that is called once per presence frame received on the channel, or once per page of a presence sync, with all of its `ARTPresenceMessage`s instead of once per message. A frame with thousands of messages may be delivered over several batches.
+ *
+ * Events for the same member within a batch are folded into their net effect: a member that enters and then leaves is left out of the batch, a member that enters and then updates is delivered as a single `ARTPresenceAction.ARTPresenceEnter` carrying the latest data, and a member that leaves and re-enters is delivered as a single `ARTPresenceAction.ARTPresenceUpdate`. Members appear in the order in which their first event was received. A batch that folds down to nothing isn't delivered.
+ *
+ * Listeners registered with `subscribe:` keep receiving every message individually.
+ *
+ * @param callback An event listener function.
+ *
+ * @return An event listener object, to be passed to `unsubscribe:`.
+ */
+- (ARTEventListener *_Nullable)subscribeToBatches:(ARTPresenceMessagesBatchCallback)callback;
+
 /**
  * Deregisters all listeners currently receiving `ARTPresenceMessage` for the channel.
  */
@@ -8,6 +8,8 @@
 @class ARTErrorInfo;
 @class ARTMessage;
 @class ARTPresenceMessage;
+@class ARTPresenceSnapshot;
+@class ARTPresenceChanges;
 @class ARTTokenParams;
 @class ARTTokenRequest;
 @class ARTTokenDetails;
@@ -485,6 +487,24 @@ typedef void (^ARTPresenceMessageCallback)(ARTPresenceMessage *message);
 /// :nodoc:
 typedef void (^ARTPresenceMessagesCallback)(NSArray<ARTPresenceMessage *> *_Nullable result, ARTErrorInfo *_Nullable error);
 
+/// :nodoc:
+typedef void (^ARTPresenceMessagesBatchCallback)(NSArray<ARTPresenceMessage *> *messages);
+
+/// :nodoc:
+typedef void (^ARTChannelMessageCallback)(NSString *channelName, ARTMessage *message);
+
+/// :nodoc:
+typedef void (^ARTChannelsAttachCallback)(NSDictionary<NSString *, ARTErrorInfo *> *_Nullable errorsByChannelName);
+
+/// :nodoc:
+typedef void (^ARTPresenceClientsCallback)(NSDictionary<NSString *, ARTErrorInfo *> *_Nullable errors);
+
+/// :nodoc:
+typedef void (^ARTPresenceSnapshotCallback)(ARTPresenceSnapshot *_Nullable snapshot, ARTErrorInfo *_Nullable error);
+
+/// :nodoc:
+typedef void (^ARTPresenceChangesCallback)(ARTPresenceChanges *_Nullable changes, ARTErrorInfo *_Nullable error);
+
 /// :nodoc:
 typedef void (^ARTChannelDetailsCallback)(ARTChannelDetails *_Nullable details, ARTErrorInfo *_Nullable error);
 
@@ -22,6 +22,7 @@ FOUNDATION_EXPORT const unsigned char ablyVersionString[];
 #import <Ably/ARTBaseMessage.h>
 #import <Ably/ARTRestChannels.h>
 #import <Ably/ARTChannelOptions.h>
+#import <Ably/ARTChannelEvictionPolicy.h>
 #import <Ably/ARTTokenDetails.h>
 #import <Ably/ARTTokenRequest.h>
 #import <Ably/ARTTokenParams.h>
@@ -34,6 +35,7 @@ FOUNDATION_EXPORT const unsigned char ablyVersionString[];
 #import <Ably/ARTMessage.h>
 #import <Ably/ARTPresence.h>
 #import <Ably/ARTPresenceMessage.h>
+#import <Ably/ARTPresenceSnapshot.h>
 #import <Ably/ARTProtocolMessage.h>
 #import <Ably/ARTQueuedMessage.h>
 #import <Ably/ARTRest.h>
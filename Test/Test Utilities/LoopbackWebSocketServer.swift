@@ -0,0 +1,321 @@
+import Foundation
+import CommonCrypto
+import XCTest
+import Ably.Private
+
+/// A WebSocket server on the loopback interface, for testing the client's framing and extensions without a network. It accepts a single connection, and echoes every data frame it receives, RSV bits included, until it closes the connection itself, if asked to.
+final class LoopbackWebSocketServer {
+    struct Frame {
+        let opcode: UInt8
+        let fin: Bool
+        let rsv1: Bool
+        let payload: [UInt8]
+    }
+
+    /// The value of the `Sec-WebSocket-Extensions` response header, given the one of the request, or `nil` to not accept any extension.
+    private let extensionsResponse: (String?) -> String?
+    /// How many data frames, fragments included, the server receives before it sends a close frame, or `nil` for it to only reply to the client's.
+    private let closeAfterDataFrames: Int?
+
+    private let queue = DispatchQueue(label: "io.ably.tests.LoopbackWebSocketServer")
+    private let lock = NSLock()
+    private let listeningSocket: Int32
+    private var _requestHeaders: [String: String] = [:]
+    private var _receivedFrames: [Frame] = []
+
+    private(set) var port: UInt16 = 0
+
+    var url: URL {
+        return URL(string: "ws://127.0.0.1:\(port)")!
+    }
+
+    /// The headers of the handshake request, with lowercase names.
+    var requestHeaders: [String: String] {
+        lock.lock()
+        defer { lock.unlock() }
+        return _requestHeaders
+    }
+
+    /// The frames received from the client, unmasked.
+    var receivedFrames: [Frame] {
+        lock.lock()
+        defer { lock.unlock() }
+        return _receivedFrames
+    }
+
+    init(extensionsResponse: @escaping (String?) -> String? = { _ in nil }, closeAfterDataFrames: Int? = nil) {
+        self.extensionsResponse = extensionsResponse
+        self.closeAfterDataFrames = closeAfterDataFrames
+
+        let listeningSocket = socket(AF_INET, SOCK_STREAM, 0)
+        precondition(listeningSocket >= 0, "socket() failed")
+        self.listeningSocket = listeningSocket
+
+        var address = sockaddr_in()
+        address.sin_len = UInt8(MemoryLayout<sockaddr_in>.size)
+        address.sin_family = sa_family_t(AF_INET)
+        address.sin_port = 0 // Any free port
+        address.sin_addr.s_addr = inet_addr("127.0.0.1")
+        var addressLength = socklen_t(MemoryLayout<sockaddr_in>.size)
+        withUnsafeMutablePointer(to: &address) { pointer in
+            pointer.withMemoryRebound(to: sockaddr.self, capacity: 1) { address in
+                precondition(bind(listeningSocket, address, addressLength) == 0, "bind() failed")
+                precondition(getsockname(listeningSocket, address, &addressLength) == 0, "getsockname() failed")
+            }
+        }
+        precondition(listen(listeningSocket, 1) == 0, "listen() failed")
+        port = UInt16(bigEndian: address.sin_port)
+
+        queue.async {
+            let connection = accept(listeningSocket, nil, nil)
+            guard connection >= 0 else {
+                return
+            }
+            self.serve(connection)
+            close(connection)
+        }
+    }
+
+    func stop() {
+        shutdown(listeningSocket, SHUT_RDWR)
+        close(listeningSocket)
+    }
+
+    // MARK: Connection
+
+    private func serve(_ connection: Int32) {
+        guard let request = readHandshake(connection) else {
+            return
+        }
+
+        var headers: [String: String] = [:]
+        for line in request.components(separatedBy: "\r\n").dropFirst() {
+            guard let colon = line.firstIndex(of: ":") else {
+                continue
+            }
+            headers[line[..<colon].lowercased()] = line[line.index(after: colon)...].trimmingCharacters(in: .whitespaces)
+        }
+        lock.lock()
+        _requestHeaders = headers
+        lock.unlock()
+
+        var response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        response += "Sec-WebSocket-Accept: \(Self.acceptValue(forKey: headers["sec-websocket-key"] ?? ""))\r\n"
+        if let extensions = extensionsResponse(headers["sec-websocket-extensions"]) {
+            response += "Sec-WebSocket-Extensions: \(extensions)\r\n"
+        }
+        response += "\r\n"
+        guard write(connection, Array(response.utf8)) else {
+            return
+        }
+
+        var dataFrameCount = 0
+        var sentClose = false
+        while let frame = readFrame(connection) {
+            lock.lock()
+            _receivedFrames.append(frame)
+            lock.unlock()
+
+            switch frame.opcode {
+            case 0x8: // Close, which is either the client's or its reply to the server's
+                if !sentClose {
+                    _ = write(connection, Self.frameBytes(frame))
+                }
+                return
+            case 0x9: // Ping
+                _ = write(connection, Self.frameBytes(Frame(opcode: 0xA, fin: true, rsv1: false, payload: frame.payload)))
+            case 0xA: // Pong
+                break
+            default:
+                // Once the server has sent its close frame, it reads the client's frames until the reply to it, but no longer echoes them.
+                if sentClose {
+                    continue
+                }
+                guard write(connection, Self.frameBytes(frame)) else {
+                    return
+                }
+                dataFrameCount += 1
+                if dataFrameCount == closeAfterDataFrames {
+                    sentClose = true
+                    guard write(connection, Self.frameBytes(Frame(opcode: 0x8, fin: true, rsv1: false, payload: [0x03, 0xE8]))) else { // 1000, normal closure
+                        return
+                    }
+                }
+            }
+        }
+    }
+
+    private func readHandshake(_ connection: Int32) -> String? {
+        var bytes: [UInt8] = []
+        while !bytes.suffix(4).elementsEqual([0x0D, 0x0A, 0x0D, 0x0A]) {
+            guard let byte = read(connection, count: 1) else {
+                return nil
+            }
+            bytes += byte
+        }
+        return String(decoding: bytes, as: UTF8.self)
+    }
+
+    private func readFrame(_ connection: Int32) -> Frame? {
+        guard let header = read(connection, count: 2) else {
+            return nil
+        }
+        var length = UInt64(header[1] & 0x7F)
+        if length >= 126 {
+            guard let extendedLength = read(connection, count: length == 126 ? 2 : 8) else {
+                return nil
+            }
+            length = extendedLength.reduce(0) { $0 << 8 | UInt64($1) }
+        }
+        let isMasked = header[1] & 0x80 != 0
+        guard let mask = isMasked ? read(connection, count: 4) : [0, 0, 0, 0], var payload = read(connection, count: Int(length)) else {
+            return nil
+        }
+        for i in payload.indices {
+            payload[i] ^= mask[i % 4]
+        }
+        return Frame(opcode: header[0] & 0x0F, fin: header[0] & 0x80 != 0, rsv1: header[0] & 0x40 != 0, payload: payload)
+    }
+
+    private func read(_ connection: Int32, count: Int) -> [UInt8]? {
+        var bytes = [UInt8](repeating: 0, count: count)
+        var offset = 0
+        while offset < count {
+            let result = bytes.withUnsafeMutableBytes { Darwin.read(connection, $0.baseAddress! + offset, count - offset) }
+            guard result > 0 else {
+                return nil
+            }
+            offset += result
+        }
+        return bytes
+    }
+
+    private func write(_ connection: Int32, _ bytes: [UInt8]) -> Bool {
+        var offset = 0
+        while offset < bytes.count {
+            let result = bytes.withUnsafeBytes { Darwin.write(connection, $0.baseAddress! + offset, bytes.count - offset) }
+            guard result > 0 else {
+                return false
+            }
+            offset += result
+        }
+        return true
+    }
+
+    // MARK: Encoding
+
+    /// Server frames aren't masked.
+    private static func frameBytes(_ frame: Frame) -> [UInt8] {
+        var bytes: [UInt8] = [(frame.fin ? 0x80 : 0) | (frame.rsv1 ? 0x40 : 0) | frame.opcode]
+        let length = frame.payload.count
+        if length < 126 {
+            bytes.append(UInt8(length))
+        } else if length <= Int(UInt16.max) {
+            bytes += [126, UInt8(length >> 8), UInt8(length & 0xFF)]
+        } else {
+            bytes.append(127)
+            bytes += (0 ..< 8).reversed().map { UInt8(truncatingIfNeeded: UInt64(length) >> ($0 * 8)) }
+        }
+        return bytes + frame.payload
+    }
+
+    private static func acceptValue(forKey key: String) -> String {
+        let input = Array((key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11").utf8)
+        var digest = [UInt8](repeating: 0, count: Int(CC_SHA1_DIGEST_LENGTH))
+        CC_SHA1(input, CC_LONG(input.count), &digest)
+        return Data(digest).base64EncodedString()
+    }
+}
+
+/// Forwards the events of a web socket to closures, and asks for text messages as data.
+class WebSocketTestDelegate: NSObject, ARTWebSocketDelegate {
+    var onOpen: (() -> Void)?
+    var onMessage: ((Data) -> Void)?
+    var onFailure: ((Error) -> Void)?
+    var onClose: (() -> Void)?
+
+    func webSocketDidOpen(_ webSocket: ARTWebSocket) {
+        onOpen?()
+    }
+
+    func webSocketShouldConvertTextFrameToString(_ webSocket: ARTWebSocket) -> Bool {
+        return false
+    }
+
+    func webSocket(_ webSocket: ARTWebSocket, didReceiveMessageWith data: Data) {
+        onMessage?(data)
+    }
+
+    func webSocket(_ webSocket: ARTWebSocket, didFailWithError error: Error) {
+        onFailure?(error)
+    }
+
+    func webSocket(_ webSocket: ARTWebSocket, didCloseWithCode code: Int, reason: String?, wasClean: Bool) {
+        onClose?()
+    }
+}
+
+/// Sends messages through a web socket to a `LoopbackWebSocketServer` once it has opened, and collects what the server echoes.
+final class LoopbackEcho {
+    let webSocket: ARTSRWebSocket
+    /// Fulfilled once every message has been echoed, or the socket has failed.
+    let echoed: XCTestExpectation
+    /// Fulfilled once the socket has closed, or failed, after which the server has received every frame the socket sent.
+    let closed: XCTestExpectation
+
+    private let delegate = WebSocketTestDelegate()
+    private(set) var echoes: [Data] = []
+    private(set) var error: Error?
+
+    /// Strings in `messages` are sent as text, and data as binary. `afterSending` is called right after they have been.
+    init(_ messages: [Any], through webSocket: ARTSRWebSocket, testCase: XCTestCase, afterSending: @escaping (ARTSRWebSocket) -> Void = { _ in }) {
+        self.webSocket = webSocket
+        echoed = testCase.expectation(description: "echoes")
+        echoed.assertForOverFulfill = false
+        closed = testCase.expectation(description: "closed")
+        closed.assertForOverFulfill = false
+
+        webSocket.delegate = delegate
+        webSocket.delegateDispatchQueue = DispatchQueue(label: "io.ably.tests.LoopbackEcho")
+        delegate.onOpen = {
+            messages.forEach { webSocket.send($0) }
+            afterSending(webSocket)
+        }
+        delegate.onMessage = { [weak self] data in
+            guard let self = self else { return }
+            self.echoes.append(data)
+            if self.echoes.count == messages.count {
+                self.echoed.fulfill()
+            }
+        }
+        delegate.onFailure = { [weak self] error in
+            guard let self = self else { return }
+            self.error = error
+            self.echoed.fulfill()
+            self.closed.fulfill()
+        }
+        delegate.onClose = { [weak self] in
+            guard let self = self else { return }
+            self.echoed.fulfill()
+            self.closed.fulfill()
+        }
+    }
+
+    /// The echoes, as UTF-8 text.
+    var textEchoes: [String] {
+        return echoes.map { String(decoding: $0, as: UTF8.self) }
+    }
+}
+
+extension XCTestCase {
+    /// Opens `webSocket`, sends `messages` once it has opened, waits for their echoes, then closes it and waits for it to have closed.
+    @discardableResult
+    func echo(_ messages: [Any], through webSocket: ARTSRWebSocket, afterSending: @escaping (ARTSRWebSocket) -> Void = { _ in }) -> LoopbackEcho {
+        let echo = LoopbackEcho(messages, through: webSocket, testCase: self, afterSending: afterSending)
+        webSocket.open()
+        wait(for: [echo.echoed], timeout: 10)
+        webSocket.close()
+        wait(for: [echo.closed], timeout: 10)
+        return echo
+    }
+}
@@ -0,0 +1,70 @@
+import XCTest
+import Ably.Private
+
+class AttachSchedulerTests: XCTestCase {
+    private func makeScheduler(maxConcurrentAttaches: UInt) -> AttachScheduler {
+        return AttachScheduler(maxConcurrentAttaches: maxConcurrentAttaches, logger: .init(core: MockInternalLogCore()))
+    }
+
+    func test_withoutALimit_sendsEveryAttachStraightAway() {
+        let scheduler = makeScheduler(maxConcurrentAttaches: 0)
+        var sent: [String] = []
+        for name in ["a", "b", "c"] {
+            scheduler.scheduleAttach(ofChannel: name) { sent.append(name) }
+        }
+
+        XCTAssertEqual(sent, ["a", "b", "c"])
+        XCTAssertEqual(scheduler.progress.inFlight, 3)
+    }
+
+    func test_refillsFreeSlotsTogetherOnceHalfOfThemAreFree() {
+        // Given: a scheduler limited to 4 concurrent attaches, and 7 channels attaching...
+        let scheduler = makeScheduler(maxConcurrentAttaches: 4)
+        var sent: [String] = []
+        let names = ["a", "b", "c", "d", "e", "f", "g"]
+        for name in names {
+            scheduler.scheduleAttach(ofChannel: name) { sent.append(name) }
+        }
+
+        // Then: only 4 ATTACH messages are sent...
+        XCTAssertEqual(sent, ["a", "b", "c", "d"])
+        XCTAssertEqual(scheduler.progress.waiting, 3)
+
+        // ...and the next ones only once 2 of them have ended, in one go.
+        scheduler.attachOfChannelDidEnd("a", attached: true)
+        XCTAssertEqual(sent.count, 4)
+        scheduler.attachOfChannelDidEnd("b", attached: false)
+        XCTAssertEqual(sent, ["a", "b", "c", "d", "e", "f"])
+
+        // A waiting channel that stops attaching gives up its turn.
+        scheduler.attachOfChannelDidEnd("g", attached: false)
+        XCTAssertEqual(scheduler.progress.waiting, 0)
+
+        for name in ["c", "d", "e", "f"] {
+            scheduler.attachOfChannelDidEnd(name, attached: true)
+        }
+
+        let progress = scheduler.progress
+        XCTAssertEqual(sent, ["a", "b", "c", "d", "e", "f"])
+        XCTAssertEqual(progress.requested, 7)
+        XCTAssertEqual(progress.succeeded, 5)
+        XCTAssertEqual(progress.failed, 2)
+        XCTAssertEqual(progress.inFlight, 0)
+        XCTAssertGreaterThanOrEqual(progress.duration, progress.maxAttachLatency)
+        XCTAssertGreaterThanOrEqual(progress.maxAttachLatency, progress.averageAttachLatency)
+    }
+
+    func test_channelAttachingAgainKeepsItsSlot() {
+        let scheduler = makeScheduler(maxConcurrentAttaches: 1)
+        var sent: [String] = []
+        scheduler.scheduleAttach(ofChannel: "a") { sent.append("a") }
+        scheduler.scheduleAttach(ofChannel: "b") { sent.append("b") }
+        scheduler.scheduleAttach(ofChannel: "a") { sent.append("a again") }
+
+        XCTAssertEqual(sent, ["a", "a again"])
+        XCTAssertEqual(scheduler.progress.requested, 2)
+
+        scheduler.attachOfChannelDidEnd("a", attached: true)
+        XCTAssertEqual(sent, ["a", "a again", "b"])
+    }
+}
@@ -1,4 +1,5 @@
 import Ably
+import Ably.Private
 import AblyDeltaCodec
 import Nimble
 import XCTest
@@ -190,4 +191,54 @@ class DeltaCodecTests: XCTestCase {
 
         expect(receivedMessages).toEventually(haveCount(testData.count))
     }
+
+    // RTL19c
+
+    // "abcdefghij" -> "abcdefghij-XYZ": COPY 10 from the source, ADD "-XYZ".
+    private let firstDelta = Data([0xD6, 0xC3, 0xC4, 0x00, 0x00, 0x01, 0x0A, 0x00, 0x0C, 0x0E, 0x00, 0x04, 0x02, 0x01, 0x2D, 0x58, 0x59, 0x5A, 0x1A, 0x05, 0x00])
+    // "abcdefghij-XYZ" -> "abcdefghij-XYZ!!!!": COPY 14 from the source, RUN 4 "!".
+    private let secondDelta = Data([0xD6, 0xC3, 0xC4, 0x00, 0x00, 0x01, 0x0E, 0x00, 0x0A, 0x12, 0x00, 0x01, 0x03, 0x01, 0x21, 0x1E, 0x00, 0x04, 0x00])
+
+    func test__004__DeltaCodec__arena__should_apply_consecutive_deltas_against_the_previous_result() throws {
+        let arena = DeltaArena()
+        arena.setBaseString("abcdefghij", withId: "foo:0:0")
+
+        let first = try arena.applyDelta(firstDelta, deltaId: "foo:1:0", baseId: "foo:0:0")
+        XCTAssertEqual(String(data: first, encoding: .utf8), "abcdefghij-XYZ")
+        XCTAssertEqual(arena.baseId, "foo:1:0")
+
+        let second = try arena.applyDelta(secondDelta, deltaId: "foo:2:0", baseId: "foo:1:0")
+        XCTAssertEqual(String(data: second, encoding: .utf8), "abcdefghij-XYZ!!!!")
+        XCTAssertEqual(arena.base, second)
+        XCTAssertEqual(arena.baseId, "foo:2:0")
+    }
+
+    func test__005__DeltaCodec__arena__should_keep_the_base_when_a_delta_cannot_be_applied() throws {
+        let arena = DeltaArena()
+        arena.setBase(Data("abcdefghij".utf8), withId: "foo:0:0")
+
+        XCTAssertThrowsError(try arena.applyDelta(firstDelta, deltaId: "foo:1:0", baseId: "foo:9:0")) { error in
+            XCTAssertEqual((error as NSError).code, ARTErrorCode.unableToDecodeMessage.intValue)
+        }
+        XCTAssertThrowsError(try arena.applyDelta(Data(), deltaId: "foo:1:0", baseId: "foo:0:0"))
+        XCTAssertThrowsError(try arena.applyDelta(firstDelta.prefix(12), deltaId: "foo:1:0", baseId: "foo:0:0"))
+
+        XCTAssertEqual(arena.base, Data("abcdefghij".utf8))
+        XCTAssertEqual(arena.baseId, "foo:0:0")
+    }
+
+    func test__006__DeltaCodec__encoder__should_decode_delta_encoded_strings_and_binary_payloads() throws {
+        let encoder = ARTDataEncoder(cipherParams: nil, logger: .init(core: MockInternalLogCore()), error: nil)
+
+        XCTAssertNil(encoder.decode("abcdefghij", encoding: nil).errorInfo)
+
+        let string = encoder.decode(firstDelta, encoding: "utf-8/vcdiff")
+        XCTAssertNil(string.errorInfo)
+        XCTAssertNil(string.encoding)
+        XCTAssertEqual(string.data as? String, "abcdefghij-XYZ")
+
+        let binary = encoder.decode(secondDelta.base64EncodedString(), encoding: "vcdiff/base64")
+        XCTAssertNil(binary.errorInfo)
+        XCTAssertEqual(binary.data as? Data, Data("abcdefghij-XYZ!!!!".utf8))
+    }
 }
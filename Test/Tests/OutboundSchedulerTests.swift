@@ -0,0 +1,105 @@
+import XCTest
+import Ably.Private
+
+class OutboundSchedulerTests: XCTestCase {
+    private func queuedMessage(_ action: ARTProtocolMessageAction, channel: String?, id: String) -> ARTQueuedMessage {
+        let protocolMessage = ARTProtocolMessage()
+        protocolMessage.action = action
+        protocolMessage.channel = channel
+        protocolMessage.id = id
+        return ARTQueuedMessage(protocolMessage: protocolMessage, sentCallback: nil, ackCallback: nil)
+    }
+
+    private func dequeueAll(_ scheduler: OutboundScheduler) -> [String] {
+        var ids: [String] = []
+        while let message = scheduler.dequeue() {
+            ids.append(message.msg.id!)
+        }
+        return ids
+    }
+
+    func test_dequeuesByPriorityAndInOrderWithinAPriority() {
+        let scheduler = OutboundScheduler(fairnessInterval: 100)
+        scheduler.enqueue(queuedMessage(.message, channel: "a", id: "publish a 1"))
+        scheduler.enqueue(queuedMessage(.message, channel: "b", id: "publish b 1"))
+        scheduler.enqueue(queuedMessage(.presence, channel: "a", id: "presence a"))
+        scheduler.enqueue(queuedMessage(.message, channel: "a", id: "publish a 2"))
+        scheduler.enqueue(queuedMessage(.attach, channel: "c", id: "attach c"))
+        scheduler.enqueue(queuedMessage(.attach, channel: "d", id: "attach d"))
+
+        XCTAssertEqual(scheduler.count, 6)
+        // "presence a" waits for "publish a 1", which was enqueued before it for the same channel.
+        XCTAssertEqual(dequeueAll(scheduler), ["attach c", "attach d", "publish a 1", "presence a", "publish b 1", "publish a 2"])
+        XCTAssertEqual(scheduler.count, 0)
+    }
+
+    func test_lowerPrioritiesWaitForAtMostTheFairnessInterval() {
+        // Given: a backlog of publishes queued before many ATTACH messages for other channels...
+        let scheduler = OutboundScheduler(fairnessInterval: 2)
+        scheduler.enqueue(queuedMessage(.message, channel: "x", id: "publish 1"))
+        scheduler.enqueue(queuedMessage(.message, channel: "x", id: "publish 2"))
+        for i in 1...5 {
+            scheduler.enqueue(queuedMessage(.attach, channel: "channel \(i)", id: "attach \(i)"))
+        }
+
+        // Then: a publish is sent after every 2 ATTACH messages, and the publishes stay in order.
+        XCTAssertEqual(dequeueAll(scheduler), ["attach 1", "attach 2", "publish 1", "attach 3", "attach 4", "publish 2", "attach 5"])
+    }
+
+    func test_lowerPriorityIsNotPromotedAheadOfAnEarlierMessageForTheSameChannel() {
+        let scheduler = OutboundScheduler(fairnessInterval: 1)
+        scheduler.enqueue(queuedMessage(.attach, channel: "a", id: "attach a"))
+        scheduler.enqueue(queuedMessage(.attach, channel: "b", id: "attach b"))
+        scheduler.enqueue(queuedMessage(.message, channel: "b", id: "publish b"))
+        scheduler.enqueue(queuedMessage(.attach, channel: "c", id: "attach c"))
+
+        // "publish b" has waited long enough after "attach a", but "attach b" was enqueued before it.
+        XCTAssertEqual(dequeueAll(scheduler), ["attach a", "attach b", "publish b", "attach c"])
+    }
+
+    func test_higherPrioritiesDoNotOvertakeEarlierMessagesForTheSameChannel() {
+        let scheduler = OutboundScheduler(fairnessInterval: 100)
+        scheduler.enqueue(queuedMessage(.message, channel: "a", id: "publish a 1"))
+        scheduler.enqueue(queuedMessage(.message, channel: "a", id: "publish a 2"))
+        scheduler.enqueue(queuedMessage(.presence, channel: "a", id: "presence a"))
+        scheduler.enqueue(queuedMessage(.detach, channel: "a", id: "detach a"))
+        scheduler.enqueue(queuedMessage(.message, channel: "b", id: "publish b"))
+        scheduler.enqueue(queuedMessage(.attach, channel: "b", id: "attach b"))
+        scheduler.enqueue(queuedMessage(.attach, channel: "c", id: "attach c"))
+        scheduler.enqueue(queuedMessage(.heartbeat, channel: nil, id: "heartbeat"))
+
+        // "detach a" and "attach b" wait for the earlier messages of their channels, and the control messages after them wait in turn.
+        XCTAssertEqual(dequeueAll(scheduler), ["publish a 1", "publish a 2", "presence a", "detach a", "publish b", "attach b", "attach c", "heartbeat"])
+    }
+
+    func test_drainsALargeMixedBacklogInChannelOrder() {
+        // Given: a reconnection backlog of publishes for a few channels, followed by ATTACH and PRESENCE messages for them and for others.
+        let scheduler = OutboundScheduler(fairnessInterval: 10)
+        let publishCount = 3000
+        let controlCount = 1000
+        var enqueued: [(channel: String, id: String)] = []
+        func enqueue(_ action: ARTProtocolMessageAction, channel: String, id: String) {
+            scheduler.enqueue(queuedMessage(action, channel: channel, id: id))
+            enqueued.append((channel, id))
+        }
+        for i in 0 ..< publishCount {
+            enqueue(.message, channel: "publish \(i % 8)", id: "publish \(i)")
+        }
+        for i in 0 ..< controlCount {
+            enqueue(i % 2 == 0 ? .attach : .presence, channel: i % 4 == 0 ? "publish \(i % 8)" : "control \(i)", id: "control \(i)")
+        }
+
+        let dequeued = dequeueAll(scheduler)
+
+        // Then: every message is sent once, and the messages of each channel in the order they were enqueued in.
+        XCTAssertEqual(dequeued.count, publishCount + controlCount)
+        XCTAssertEqual(Set(dequeued).count, dequeued.count)
+        let position = Dictionary(uniqueKeysWithValues: dequeued.enumerated().map { ($1, $0) })
+        for ids in Dictionary(grouping: enqueued, by: { $0.channel }).values {
+            let positions = ids.map { position[$0.id]! }
+            XCTAssertEqual(positions, positions.sorted())
+        }
+        // The PRESENCE messages for channels without publishes go ahead of them, while the first ATTACH waits for the publishes of its channel.
+        XCTAssertEqual(Array(dequeued.prefix(3)), ["control 1", "control 3", "control 5"])
+    }
+}
@@ -0,0 +1,293 @@
+import Ably.Private
+import XCTest
+
+class MockPresenceMapDelegate: NSObject, ARTPresenceMapDelegate {
+    var connectionId: String
+    private(set) var membersNoLongerPresent: [ARTPresenceMessage] = []
+    private(set) var localMembersToReenter: [ARTPresenceMessage] = []
+
+    init(connectionId: String) {
+        self.connectionId = connectionId
+    }
+
+    func map(_ map: ARTPresenceMap, didRemovedMemberNoLongerPresent presence: ARTPresenceMessage) {
+        membersNoLongerPresent.append(presence)
+    }
+
+    func map(_ map: ARTPresenceMap, shouldReenterLocalMember presence: ARTPresenceMessage) {
+        localMembersToReenter.append(presence)
+    }
+}
+
+class PresenceMapTests: XCTestCase {
+    private func makePresenceMap(delegate: ARTPresenceMapDelegate) -> ARTPresenceMap {
+        let map = ARTPresenceMap(queue: AblyTests.queue, logger: .init(core: MockInternalLogCore()))
+        map.delegate = delegate
+        return map
+    }
+
+    // RTP2b2
+    func test_isNewerThan_comparesMsgSerialThenIndexParsedFromId() {
+        let now = Date()
+        let base = ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:2:2", timestamp: now)
+
+        XCTAssertTrue(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:3:0", timestamp: now - 1).isNewer(than: base))
+        XCTAssertTrue(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:2:3", timestamp: now - 1).isNewer(than: base))
+        XCTAssertFalse(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:2:1", timestamp: now + 1).isNewer(than: base))
+        XCTAssertFalse(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:1:9", timestamp: now + 1).isNewer(than: base))
+        XCTAssertFalse(base.isNewer(than: base))
+    }
+
+    // RTP2b1
+    func test_isNewerThan_comparesSynthesizedMessagesByTimestamp() {
+        let now = Date()
+        let base = ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:5:0", timestamp: now)
+        let synthesizedLater = ARTPresenceMessage(clientId: "a", action: .leave, connectionId: "one", id: "fabricated:0:0", timestamp: now + 1)
+        let synthesizedEarlier = ARTPresenceMessage(clientId: "a", action: .leave, connectionId: "one", id: "fabricated:9:9", timestamp: now - 1)
+        // A connectionId that the id merely starts with doesn't make the message authentic.
+        let prefixOfConnectionId = ARTPresenceMessage(clientId: "a", action: .leave, connectionId: "on", id: "one:9:9", timestamp: now - 1)
+
+        XCTAssertTrue(synthesizedLater.isSynthesized())
+        XCTAssertTrue(prefixOfConnectionId.isSynthesized())
+        XCTAssertFalse(base.isSynthesized())
+
+        XCTAssertTrue(synthesizedLater.isNewer(than: base))
+        XCTAssertFalse(synthesizedEarlier.isNewer(than: base))
+        XCTAssertFalse(prefixOfConnectionId.isNewer(than: base))
+    }
+
+    func test_idPartsAreUpdatedWhenIdChangesAndKeptWhenCopied() {
+        let message = ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:1:2")
+        message.id = "one:7:8"
+
+        let copy = message.copy() as! ARTPresenceMessage
+        XCTAssertEqual(copy.msgSerialFromId(), 7)
+        XCTAssertEqual(copy.indexFromId(), 8)
+        XCTAssertFalse(copy.isSynthesized())
+    }
+
+    func test_memberStore_rebuildsCanonicalIdsAndKeepsOtherIds() {
+        let store = ARTPresenceMemberStore()
+        let canonical = ARTPresenceMessage(clientId: "a", action: .present, connectionId: "one", id: "one:12:3", timestamp: Date(timeIntervalSince1970: 1_600_000_000.123))
+        canonical.data = "payload"
+        canonical.encoding = "utf-8"
+        let padded = ARTPresenceMessage(clientId: "b", action: .present, connectionId: "one", id: "one:012:3")
+        let synthesized = ARTPresenceMessage(clientId: "c", action: .absent, connectionId: "one", id: "fabricated:0:0")
+        XCTAssertTrue(canonical.hasCanonicalId())
+        XCTAssertFalse(padded.hasCanonicalId())
+        XCTAssertFalse(synthesized.hasCanonicalId())
+
+        let messages = [canonical, padded, synthesized]
+        let slots = messages.map { store.setMember($0) }
+        for (slot, message) in zip(slots, messages) {
+            let member = store.member(atSlot: slot)
+            XCTAssertEqual(member.id, message.id)
+            XCTAssertEqual(member.clientId, message.clientId)
+            XCTAssertEqual(member.connectionId, message.connectionId)
+            XCTAssertEqual(member.timestamp, message.timestamp)
+            XCTAssertEqual(member.action, message.action)
+            XCTAssertEqual(member.data as? String, message.data as? String)
+            XCTAssertEqual(member.encoding, message.encoding)
+        }
+        XCTAssertEqual(store.member(atSlot: slots[0]).msgSerialFromId(), 12)
+        XCTAssertEqual(store.member(atSlot: slots[0]).indexFromId(), 3)
+
+        store.removeMember(atSlot: slots[1])
+        XCTAssertEqual(store.count, 2)
+        XCTAssertEqual(store.slotOfMember(withClientId: "b", connectionId: "one"), NSNotFound)
+        XCTAssertEqual(store.slotsOfMembers(withClientId: "b").count, 0)
+        // Freed slots are reused.
+        XCTAssertEqual(store.setMember(padded), slots[1])
+        XCTAssertEqual(store.slotsOfMembers(withConnectionId: "one").count, 3)
+        XCTAssertEqual(Set(store.membersByKey().keys), ["one:a", "one:b", "one:c"])
+    }
+
+    func test_memberStore_comparesNewnessFromTheStoredParts() {
+        let store = ARTPresenceMemberStore()
+        let stored = [
+            ARTPresenceMessage(clientId: "a", action: .present, connectionId: "one", id: "one:12:3", timestamp: Date(timeIntervalSince1970: 100)),
+            ARTPresenceMessage(clientId: "b", action: .present, connectionId: "one", id: "one:012:3", timestamp: Date(timeIntervalSince1970: 100)),
+            ARTPresenceMessage(clientId: "c", action: .absent, connectionId: "one", id: "fabricated:0:0", timestamp: Date(timeIntervalSince1970: 100)),
+        ]
+        let slots = stored.map { store.setMember($0) }
+        for (slot, latest) in zip(slots, stored) {
+            for (msgSerial, index, timestamp) in [(12, 2, 99.0), (12, 3, 100.0), (12, 4, 101.0), (11, 9, 200.0), (13, 0, 50.0)] {
+                let message = ARTPresenceMessage(clientId: latest.clientId!, action: .update, connectionId: "one", id: "one:\(msgSerial):\(index)", timestamp: Date(timeIntervalSince1970: timestamp))
+                XCTAssertEqual(store.isMessage(message, newerThanMemberAtSlot: slot), message.isNewer(than: latest), "\(message.id!) against \(latest.id!)")
+            }
+        }
+    }
+
+    func test_members_areMaterializedOncePerChange() {
+        let map = makePresenceMap(delegate: MockPresenceMapDelegate(connectionId: "local"))
+        map.add(ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:0:0"))
+
+        let members = map.members
+        XCTAssertTrue(map.members["one:a"] === members["one:a"])
+
+        // A message that isn't newer leaves the members as they are.
+        map.add(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:0:0"))
+        XCTAssertTrue(map.members["one:a"] === members["one:a"])
+
+        map.add(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:1:0"))
+        XCTAssertFalse(map.members["one:a"] === members["one:a"])
+        XCTAssertEqual(map.members["one:a"]?.id, "one:1:0")
+    }
+
+    func test_membersWithClientIdAndConnectionId_areLookedUpThroughIndexes() {
+        let map = makePresenceMap(delegate: MockPresenceMapDelegate(connectionId: "local"))
+        map.add(ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:0:0"))
+        map.add(ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "two", id: "two:0:0"))
+        map.add(ARTPresenceMessage(clientId: "b", action: .enter, connectionId: "two", id: "two:0:1"))
+
+        XCTAssertEqual(map.members(withClientId: nil, connectionId: nil).count, 3)
+        XCTAssertEqual(Set(map.members(withClientId: "a", connectionId: nil).map { $0.connectionId }), ["one", "two"])
+        XCTAssertEqual(Set(map.members(withClientId: nil, connectionId: "two").compactMap { $0.clientId }), ["a", "b"])
+        XCTAssertEqual(map.members(withClientId: "b", connectionId: "two").count, 1)
+        XCTAssertEqual(map.members(withClientId: "b", connectionId: "one").count, 0)
+        XCTAssertEqual(map.members(withClientId: "c", connectionId: nil).count, 0)
+
+        map.add(ARTPresenceMessage(clientId: "a", action: .leave, connectionId: "two", id: "two:1:0"))
+
+        XCTAssertEqual(map.members(withClientId: "a", connectionId: nil).map { $0.connectionId }, ["one"])
+        XCTAssertEqual(map.members(withClientId: nil, connectionId: "two").compactMap { $0.clientId }, ["b"])
+    }
+
+    // RTP19, RTP2h2a, RTP17i
+    func test_endSync_removesAbsentAndStaleMembersAndReentersMissingLocalMembers() {
+        let delegate = MockPresenceMapDelegate(connectionId: "local")
+        let map = makePresenceMap(delegate: delegate)
+        map.add(ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:0:0"))
+        map.add(ARTPresenceMessage(clientId: "b", action: .enter, connectionId: "one", id: "one:0:1"))
+        map.add(ARTPresenceMessage(clientId: "c", action: .enter, connectionId: "one", id: "one:0:2"))
+        map.add(ARTPresenceMessage(clientId: "l", action: .enter, connectionId: "local", id: "local:0:0"))
+        XCTAssertEqual(map.localMembers.count, 1)
+
+        map.startSync()
+        map.add(ARTPresenceMessage(clientId: "a", action: .present, connectionId: "one", id: "one:1:0"))
+        map.add(ARTPresenceMessage(clientId: "b", action: .leave, connectionId: "one", id: "one:1:1"))
+        XCTAssertEqual(map.members["one:b"]?.action, .absent)
+        // An older message for "c" is ignored, but still counts as "c" being part of the sync.
+        map.add(ARTPresenceMessage(clientId: "c", action: .present, connectionId: "one", id: "one:0:0"))
+        // The connection changed, so "l" needs to be re-entered.
+        delegate.connectionId = "new"
+        map.endSync()
+
+        XCTAssertEqual(Set(map.members.keys), ["one:a", "one:c"])
+        XCTAssertEqual(delegate.membersNoLongerPresent.map { $0.clientId }, ["l"])
+        XCTAssertEqual(delegate.localMembersToReenter.map { $0.clientId }, ["l"])
+
+        // A subsequent sync that doesn't mention "c" makes it leave.
+        map.startSync()
+        map.add(ARTPresenceMessage(clientId: "a", action: .present, connectionId: "one", id: "one:2:0"))
+        map.endSync()
+
+        XCTAssertEqual(Set(map.members.keys), ["one:a"])
+        XCTAssertEqual(delegate.membersNoLongerPresent.map { $0.clientId }, ["l", "c"])
+    }
+
+    func test_changesSinceVersion_foldsChangesOfEachMemberIntoItsNetChange() throws {
+        let map = makePresenceMap(delegate: MockPresenceMapDelegate(connectionId: "local"))
+        map.add(ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:0:0"))
+        map.add(ARTPresenceMessage(clientId: "b", action: .enter, connectionId: "one", id: "one:0:1"))
+        let version = map.version
+
+        map.add(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:1:0"))
+        map.add(ARTPresenceMessage(clientId: "b", action: .leave, connectionId: "one", id: "one:1:1"))
+        map.add(ARTPresenceMessage(clientId: "c", action: .enter, connectionId: "one", id: "one:1:2"))
+        // Entering and leaving in between is no change at all.
+        map.add(ARTPresenceMessage(clientId: "d", action: .enter, connectionId: "one", id: "one:1:3"))
+        map.add(ARTPresenceMessage(clientId: "d", action: .leave, connectionId: "one", id: "one:2:0"))
+        // Ignored messages don't change the version.
+        map.add(ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:0:5"))
+        XCTAssertEqual(map.version, version + 5)
+
+        let changes = try XCTUnwrap(map.changesSinceVersion(version))
+        XCTAssertEqual(changes.fromVersion, version)
+        XCTAssertEqual(changes.toVersion, map.version)
+        XCTAssertEqual(changes.entered.map { $0.clientId }, ["c"])
+        XCTAssertEqual(changes.updated.map { $0.id }, ["one:1:0"])
+        XCTAssertEqual(changes.left.map { $0.clientId }, ["b"])
+
+        let noChanges = try XCTUnwrap(map.changesSinceVersion(map.version))
+        XCTAssertTrue(noChanges.entered.isEmpty && noChanges.updated.isEmpty && noChanges.left.isEmpty)
+        XCTAssertNil(map.changesSinceVersion(map.version + 1))
+
+        // After a reset, the changes since earlier versions are no longer known.
+        map.reset()
+        XCTAssertNil(map.changesSinceVersion(version))
+        XCTAssertNotNil(map.changesSinceVersion(map.version))
+    }
+
+    func test_snapshot_isNotAffectedByLaterChanges() throws {
+        let map = makePresenceMap(delegate: MockPresenceMapDelegate(connectionId: "local"))
+        map.add(ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:0:0"))
+        map.add(ARTPresenceMessage(clientId: "b", action: .enter, connectionId: "one", id: "one:0:1"))
+        map.startSync()
+        // Kept as ABSENT until the sync ends, but no longer present.
+        map.add(ARTPresenceMessage(clientId: "b", action: .leave, connectionId: "one", id: "one:1:0"))
+
+        let snapshot = map.snapshot()
+        map.add(ARTPresenceMessage(clientId: "a", action: .leave, connectionId: "one", id: "one:1:1"))
+        map.add(ARTPresenceMessage(clientId: "c", action: .enter, connectionId: "one", id: "one:1:2"))
+        map.endSync()
+
+        XCTAssertEqual(snapshot.version, 3)
+        XCTAssertEqual(snapshot.members.map { $0.clientId }, ["a"])
+        XCTAssertEqual(snapshot.member(withClientId: "a", connectionId: "one")?.action, .present)
+        XCTAssertNil(snapshot.member(withClientId: "b", connectionId: "one"))
+        XCTAssertEqual(Set(map.members.keys), ["one:c"])
+
+        let changes = try XCTUnwrap(map.changesSinceVersion(snapshot.version))
+        XCTAssertEqual(changes.entered.map { $0.clientId }, ["c"])
+        XCTAssertEqual(changes.left.map { $0.clientId }, ["a"])
+    }
+
+    func test_netPresenceOfMessages_foldsEventsOfEachMemberIntoTheirNetEffect() {
+        let messages = [
+            ARTPresenceMessage(clientId: "a", action: .enter, connectionId: "one", id: "one:0:0"),
+            ARTPresenceMessage(clientId: "b", action: .enter, connectionId: "one", id: "one:0:1"),
+            ARTPresenceMessage(clientId: "c", action: .leave, connectionId: "one", id: "one:0:2"),
+            ARTPresenceMessage(clientId: "d", action: .update, connectionId: "one", id: "one:0:3"),
+            ARTPresenceMessage(clientId: "a", action: .update, connectionId: "one", id: "one:1:0"),
+            ARTPresenceMessage(clientId: "b", action: .update, connectionId: "one", id: "one:1:1"),
+            ARTPresenceMessage(clientId: "c", action: .enter, connectionId: "one", id: "one:1:2"),
+            ARTPresenceMessage(clientId: "b", action: .leave, connectionId: "one", id: "one:2:0"),
+        ]
+
+        let net = ARTPresenceMessage.netPresence(ofMessages: messages)
+
+        XCTAssertEqual(net.map { $0.clientId }, ["a", "c", "d"])
+        XCTAssertEqual(net.map { $0.action }, [.enter, .update, .update])
+        XCTAssertEqual(net.map { $0.id }, ["one:1:0", "one:1:2", "one:0:3"])
+        // Messages are only copied when their action changes.
+        XCTAssertTrue(net[2] === messages[3])
+        XCTAssertEqual(messages[4].action, .update)
+    }
+
+    func test_syncOf50kMembers_performance() {
+        let memberCount = 50_000
+        let now = Date()
+        let initialMembers = (0 ..< memberCount).map { i in
+            ARTPresenceMessage(clientId: "client\(i)", action: .present, connectionId: "connection\(i % 100)", id: "connection\(i % 100):\(i):0", timestamp: now)
+        }
+        let updatedMembers = (0 ..< memberCount).map { i in
+            ARTPresenceMessage(clientId: "client\(i)", action: .update, connectionId: "connection\(i % 100)", id: "connection\(i % 100):\(memberCount + i):0", timestamp: now)
+        }
+        let delegate = MockPresenceMapDelegate(connectionId: "local")
+
+        measure {
+            let map = makePresenceMap(delegate: delegate)
+            map.startSync()
+            for member in initialMembers {
+                map.add(member)
+            }
+            // Every member is now compared for newness against the one already in the map.
+            for member in updatedMembers {
+                map.add(member)
+            }
+            map.endSync()
+            XCTAssertEqual(map.memberCount, memberCount)
+        }
+    }
+}
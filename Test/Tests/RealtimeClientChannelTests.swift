@@ -4688,4 +4688,139 @@ class RealtimeClientChannelTests: XCTestCase {
             }
         }
     }
+
+    func test__140__channel_messages_with_more_entries_than_a_slice_are_processed_in_order_across_several_turns_of_the_queue() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        options.testOptions.channelMessageSliceSize = 2
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+        let channel = client.channels.get(test.uniqueChannelName())
+
+        func messageFrame(id: String, count: Int) -> ARTProtocolMessage {
+            let protocolMessage = ARTProtocolMessage()
+            protocolMessage.action = .message
+            protocolMessage.channel = channel.name
+            protocolMessage.id = id
+            protocolMessage.messages = (0..<count).map { ARTMessage(name: nil, data: "\(id)\($0)") }
+            return protocolMessage
+        }
+
+        var received: [String] = []
+        waitUntil(timeout: testTimeout) { done in
+            channel.subscribe { message in
+                received.append(message.id!)
+                if received.count == 7 {
+                    done()
+                }
+            }
+            AblyTests.queue.async {
+                // Enqueued before the rest of the first frame, so it runs in between its slices.
+                AblyTests.queue.async {
+                    DispatchQueue.main.async {
+                        received.append("interleaved")
+                    }
+                }
+                channel.internal.onChannelMessage(messageFrame(id: "a", count: 5))
+                channel.internal.onChannelMessage(messageFrame(id: "b", count: 1))
+            }
+        }
+
+        XCTAssertEqual(received, ["a:0", "a:1", "interleaved", "a:2", "a:3", "a:4", "b:0"])
+    }
+
+    func test__141__presence_and_sync_frames_with_more_entries_than_a_slice_are_processed_in_order_across_several_turns_of_the_queue() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        options.testOptions.channelMessageSliceSize = 2
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+        let channel = client.channels.get(test.uniqueChannelName())
+
+        waitUntil(timeout: testTimeout) { done in
+            channel.attach { error in
+                XCTAssertNil(error)
+                done()
+            }
+        }
+
+        func presenceFrame(action: ARTProtocolMessageAction, prefix: String, count: Int) -> ARTProtocolMessage {
+            let protocolMessage = ARTProtocolMessage()
+            protocolMessage.action = action
+            protocolMessage.channel = channel.name
+            protocolMessage.id = "remote:\(action.rawValue)"
+            // Not the last SYNC frame, so that the sync doesn't end and make the entered members leave.
+            protocolMessage.channelSerial = action == .sync ? "sequence:cursor" : nil
+            protocolMessage.presence = (0..<count).map {
+                ARTPresenceMessage(clientId: "\(prefix)\($0)", action: action == .sync ? .present : .enter, connectionId: "remote", id: "remote:\(action.rawValue):\($0)", timestamp: Date())
+            }
+            return protocolMessage
+        }
+
+        var received: [String] = []
+        waitUntil(timeout: testTimeout) { done in
+            channel.presence.subscribe { message in
+                received.append(message.clientId!)
+                if received.count == 9 {
+                    done()
+                }
+            }
+            AblyTests.queue.async {
+                // Enqueued before the rest of the PRESENCE frame, so it runs in between its slices.
+                AblyTests.queue.async {
+                    DispatchQueue.main.async {
+                        received.append("interleaved")
+                    }
+                }
+                channel.internal.onChannelMessage(presenceFrame(action: .presence, prefix: "p", count: 5))
+                channel.internal.onChannelMessage(presenceFrame(action: .sync, prefix: "s", count: 3))
+            }
+        }
+
+        XCTAssertEqual(received, ["p0", "p1", "interleaved", "p2", "p3", "p4", "s0", "s1", "s2"])
+    }
+
+    func test__142__the_rest_of_a_channel_message_processed_a_slice_at_a_time_is_dropped_once_the_channel_is_no_longer_attached() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        options.testOptions.channelMessageSliceSize = 2
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+        let channel = client.channels.get(test.uniqueChannelName())
+
+        waitUntil(timeout: testTimeout) { done in
+            channel.attach { error in
+                XCTAssertNil(error)
+                done()
+            }
+        }
+
+        let protocolMessage = ARTProtocolMessage()
+        protocolMessage.action = .message
+        protocolMessage.channel = channel.name
+        protocolMessage.id = "a"
+        protocolMessage.messages = (0..<5).map { ARTMessage(name: nil, data: "a\($0)") }
+
+        var received: [String] = []
+        channel.subscribe { message in
+            received.append(message.id!)
+        }
+        waitUntil(timeout: testTimeout) { done in
+            AblyTests.queue.async {
+                // Runs in between the slices of the frame.
+                AblyTests.queue.async {
+                    channel.internal.setSuspended(.init(state: .ok))
+                    AblyTests.queue.async {
+                        DispatchQueue.main.async {
+                            done()
+                        }
+                    }
+                }
+                channel.internal.onChannelMessage(protocolMessage)
+            }
+        }
+
+        XCTAssertEqual(channel.state, .suspended)
+        XCTAssertEqual(received, ["a:0", "a:1"])
+    }
 }
@@ -108,4 +108,235 @@ class RealtimeClientChannelsTests: XCTestCase {
             sameChannel.publish("foo", data: nil)
         }
     }
+
+    func test__006__Channels__getAll__should_create_or_return_every_channel_with_the_given_options() throws {
+        let test = Test()
+        let client = ARTRealtime(options: try AblyTests.commonAppSetup(for: test))
+        defer { client.dispose(); client.close() }
+
+        let existingChannel = client.channels.get(test.uniqueChannelName(prefix: "1"))
+        let options = ARTRealtimeChannelOptions()
+        let channels = client.channels.getAll([test.uniqueChannelName(prefix: "1"), test.uniqueChannelName(prefix: "2")], options: options)
+
+        XCTAssertEqual(channels.count, 2)
+        XCTAssertTrue(channels[0].internal === existingChannel.internal)
+        XCTAssertTrue(channels.allSatisfy { $0.options === options })
+        XCTAssertEqual(client.channels.internal.collection.count, 2)
+    }
+
+    func test__007__Channels__subscribeAll__should_attach_every_channel_with_a_single_callback_and_deliver_their_messages() throws {
+        let test = Test()
+        let client = ARTRealtime(options: try AblyTests.commonAppSetup(for: test))
+        defer { client.dispose(); client.close() }
+
+        let channelNames = (1...3).map { test.uniqueChannelName(prefix: "\($0)") }
+        var received: [(String, String?)] = []
+        var listeners: [String: ARTEventListener] = [:]
+        waitUntil(timeout: testTimeout) { done in
+            listeners = client.channels.subscribeAll(channelNames, options: nil, onAttach: { errors in
+                XCTAssertNil(errors)
+                done()
+            }) { channelName, message in
+                received.append((channelName, message.name))
+            }
+        }
+        XCTAssertEqual(Set(listeners.keys), Set(channelNames))
+        XCTAssertTrue(channelNames.allSatisfy { client.channels.get($0).state == .attached })
+
+        waitUntil(timeout: testTimeout) { done in
+            client.channels.get(channelNames[1]).publish("foo", data: nil) { error in
+                XCTAssertNil(error)
+                done()
+            }
+        }
+        expect(received.map { $0.0 }).toEventually(equal([channelNames[1]]), timeout: testTimeout)
+        XCTAssertEqual(received.first?.1, "foo")
+    }
+
+    func test__008__Channels__get__measures_the_memory_held_by_channels_that_are_not_used_yet() {
+        let options = ARTClientOptions(key: "xxxx:xxxx")
+        options.autoConnect = false
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+
+        // Presence, push, the data encoder, the attach retry state and the emitters' notification centers are only created on first use.
+        let channelCount = 5000
+        var iteration = 0
+        measure(metrics: [XCTMemoryMetric(), XCTClockMetric()]) {
+            iteration += 1
+            let channels = client.channels.getAll((0 ..< channelCount).map { "channel\(iteration)-\($0)" }, options: nil)
+            XCTAssertEqual(channels.count, channelCount)
+        }
+
+        // Before and after: as many channels again, once as they are now and once with that state created as it was up front.
+        let names = { (prefix: String) in (0 ..< channelCount).map { "\(prefix)-\($0)" } }
+        var lazyChannels: [ARTRealtimeChannel] = []
+        let lazyBytes = physicalFootprintGrowth {
+            lazyChannels = client.channels.getAll(names("lazy"), options: nil)
+        }
+        var eagerChannels: [ARTRealtimeChannel] = []
+        let eagerBytes = physicalFootprintGrowth {
+            eagerChannels = client.channels.getAll(names("eager"), options: nil)
+            client.internal.queue.sync {
+                for channel in eagerChannels {
+                    _ = channel.internal.presenceMap
+                    _ = channel.internal.dataEncoder
+                    channel.internal.messagesEventEmitter.off(channel.internal.messagesEventEmitter.on { _ in })
+                }
+            }
+        }
+        XCTAssertEqual(lazyChannels.count + eagerChannels.count, 2 * channelCount)
+        add(XCTAttachment(string: "Bytes per channel: \(lazyBytes / UInt64(channelCount)) created on first use, \(eagerBytes / UInt64(channelCount)) created up front"))
+        XCTAssertLessThan(lazyBytes, eagerBytes)
+    }
+
+    private func physicalFootprintGrowth(_ block: () -> Void) -> UInt64 {
+        let before = physicalFootprint()
+        block()
+        let after = physicalFootprint()
+        return after > before ? after - before : 0
+    }
+
+    private func physicalFootprint() -> UInt64 {
+        var info = task_vm_info_data_t()
+        var count = mach_msg_type_number_t(MemoryLayout<task_vm_info_data_t>.size / MemoryLayout<natural_t>.size)
+        let result = withUnsafeMutablePointer(to: &info) {
+            $0.withMemoryRebound(to: integer_t.self, capacity: Int(count)) {
+                task_info(mach_task_self_, task_flavor_t(TASK_VM_INFO), $0, &count)
+            }
+        }
+        return result == KERN_SUCCESS ? info.phys_footprint : 0
+    }
+
+    func test__009__Channels__eviction__should_evict_the_least_recently_used_unused_channels_beyond_the_maximum_count() {
+        let options = ARTClientOptions(key: "xxxx:xxxx")
+        options.autoConnect = false
+        let policy = ARTChannelEvictionPolicy()
+        policy.maxChannels = 3
+        options.channelEvictionPolicy = policy
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+
+        var evicted: [String] = []
+        let listener = client.channels.onEviction { channelName, reason in
+            XCTAssertEqual(reason, .count)
+            evicted.append(channelName)
+        }
+        defer { client.channels.offEviction(listener) }
+
+        // "a" has a listener, so is never evicted, and "b" is used again after "c". No `ARTRealtimeChannel` is kept, as one would keep its channel too.
+        autoreleasepool {
+            client.channels.get("a").on { _ in }
+            _ = client.channels.get("b")
+            _ = client.channels.get("c")
+            _ = client.channels.get("b")
+            _ = client.channels.get("d")
+        }
+
+        expect(evicted).toEventually(equal(["c"]), timeout: testTimeout)
+        XCTAssertTrue(client.channels.exists("a"))
+        XCTAssertTrue(client.channels.exists("b"))
+        XCTAssertFalse(client.channels.exists("c"))
+        XCTAssertTrue(client.channels.exists("d"))
+        XCTAssertEqual(client.channels.evictionStats.countEvictions, 1)
+        XCTAssertEqual(client.channels.evictionStats.totalEvictions, 1)
+    }
+
+    func test__010__Channels__eviction__should_evict_channels_that_are_not_used_for_the_idle_timeout() {
+        let options = ARTClientOptions(key: "xxxx:xxxx")
+        options.autoConnect = false
+        let policy = ARTChannelEvictionPolicy()
+        policy.idleTimeout = 0.2
+        options.channelEvictionPolicy = policy
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+
+        autoreleasepool {
+            _ = client.channels.get("idle")
+        }
+        XCTAssertTrue(client.channels.exists("idle"))
+
+        expect(client.channels.exists("idle")).toEventually(beFalse(), timeout: testTimeout)
+        XCTAssertEqual(client.channels.evictionStats.idleEvictions, 1)
+    }
+
+    // RTL7c
+    func test__011__Channels__subscribeAll__should_not_reattach_a_channel_that_was_detached() throws {
+        let test = Test()
+        let client = ARTRealtime(options: try AblyTests.commonAppSetup(for: test))
+        defer { client.dispose(); client.close() }
+
+        let detachedName = test.uniqueChannelName(prefix: "detached")
+        let newName = test.uniqueChannelName(prefix: "new")
+        let detached = client.channels.get(detachedName)
+        waitUntil(timeout: testTimeout) { done in
+            detached.attach { _ in
+                detached.detach { error in
+                    XCTAssertNil(error)
+                    done()
+                }
+            }
+        }
+
+        waitUntil(timeout: testTimeout) { done in
+            let listeners = client.channels.subscribeAll([detachedName, newName], options: nil, onAttach: { errors in
+                XCTAssertNil(errors)
+                done()
+            }) { _, _ in }
+            XCTAssertEqual(Set(listeners.keys), [detachedName, newName])
+        }
+        XCTAssertEqual(detached.state, .detached)
+        XCTAssertEqual(client.channels.get(newName).state, .attached)
+    }
+
+    func test__012__Channels__eviction__should_not_evict_channels_the_app_holds_onto() {
+        let options = ARTClientOptions(key: "xxxx:xxxx")
+        options.autoConnect = false
+        let policy = ARTChannelEvictionPolicy()
+        policy.maxChannels = 1
+        options.channelEvictionPolicy = policy
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+
+        let held = client.channels.get("held")
+        autoreleasepool {
+            _ = client.channels.get("other")
+        }
+        XCTAssertTrue(client.channels.exists("held"))
+        XCTAssertTrue(client.channels.exists("other"))
+        XCTAssertEqual(client.channels.evictionStats.totalEvictions, 0)
+        XCTAssertEqual(held.state, .initialized)
+    }
+
+    func test__013__Channels__eviction__should_keep_a_channel_used_while_it_is_being_evicted_attached() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        let policy = ARTChannelEvictionPolicy()
+        policy.maxChannels = 1
+        options.channelEvictionPolicy = policy
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+
+        let name = test.uniqueChannelName(prefix: "used")
+        autoreleasepool {
+            let channel = client.channels.get(name)
+            waitUntil(timeout: testTimeout) { done in
+                channel.attach { error in
+                    XCTAssertNil(error)
+                    done()
+                }
+            }
+        }
+
+        // Getting another channel starts detaching the first one, which is then used again before it has detached.
+        autoreleasepool {
+            _ = client.channels.get(test.uniqueChannelName(prefix: "other"))
+        }
+        XCTAssertTrue((client.channels.internal.collection.allValues as! [ARTRealtimeChannelInternal]).contains { $0.state_nosync == .detaching })
+        let channel = client.channels.get(name)
+
+        expect(channel.state).toEventually(equal(.attached), timeout: testTimeout)
+        XCTAssertTrue(client.channels.exists(name))
+        expect(client.channels.evictionStats.countEvictions).toEventually(equal(1), timeout: testTimeout) // the other channel
+    }
 }
@@ -4905,4 +4905,53 @@ class RealtimeClientConnectionTests: XCTestCase {
             }
         }
     }
+
+    func test__111__Connection__should_handle_heartbeats_ahead_of_the_channel_messages_received_before_them() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        options.testOptions.transportFactory = TestProxyTransportFactory()
+        let client = ARTRealtime(options: options)
+        defer { client.dispose(); client.close() }
+        let channel = client.channels.get(test.uniqueChannelName())
+
+        waitUntil(timeout: testTimeout) { done in
+            client.connection.once(.connected) { _ in
+                done()
+            }
+        }
+
+        guard let transport = client.internal.transport as? TestProxyTransport else {
+            fail("TestProxyTransport is not set"); return
+        }
+
+        var handled: [String] = []
+        let heartbeatHook = client.internal.testSuite_injectIntoMethod(after: #selector(client.internal.onHeartbeat)) {
+            handled.append("heartbeat")
+        }
+        defer { heartbeatHook.remove() }
+
+        var channelMessageHook: AspectToken?
+        waitUntil(timeout: testTimeout) { done in
+            channelMessageHook = client.internal.testSuite_injectIntoMethod(after: #selector(client.internal.onChannelMessage(_:))) {
+                handled.append("channel message")
+                done()
+            }
+
+            let channelMessage = ARTProtocolMessage()
+            channelMessage.action = .message
+            channelMessage.channel = channel.name
+            channelMessage.messages = [ARTMessage(name: nil, data: "data")]
+            let heartbeatMessage = ARTProtocolMessage()
+            heartbeatMessage.action = .heartbeat
+
+            AblyTests.queue.async {
+                transport.receive(channelMessage)
+                transport.receive(heartbeatMessage)
+            }
+        }
+
+        channelMessageHook?.remove()
+
+        XCTAssertEqual(handled, ["heartbeat", "channel message"])
+    }
 }
@@ -2800,7 +2800,7 @@ class RealtimeClientPresenceTests: XCTestCase {
             }
 
             // Await Sync
-            channel.internal.presenceMap.onceSyncEnds { _ in
+            channel.internal.presenceMap.onceSyncEnds {
                 // Should remove the "two" member that was added manually because the connectionId
                 // doesn't match and it's not synthesized, it will be re-entered.
                 XCTAssertEqual(channel.internal.presenceMap.localMembers.count, 1)
@@ -2864,7 +2864,7 @@ class RealtimeClientPresenceTests: XCTestCase {
         }
 
         waitUntil(timeout: .seconds(20)) { done in
-            channel.internal.presenceMap.onceSyncEnds { _ in
+            channel.internal.presenceMap.onceSyncEnds {
                 // Synthesized leave
                 expect(channel.internal.presenceMap.localMembers).to(beEmpty())
                 done()
@@ -3999,4 +3999,79 @@ class RealtimeClientPresenceTests: XCTestCase {
             client.connect()
         }
     }
+
+    private func presenceMembers(_ clientIds: [String], data: String) -> [ARTPresenceMessage] {
+        return clientIds.map { clientId in
+            let member = ARTPresenceMessage()
+            member.clientId = clientId
+            member.data = data
+            return member
+        }
+    }
+
+    func test__119__Presence__enterClients__should_send_all_the_members_in_a_single_PRESENCE_message() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        let client = AblyTests.newRealtime(options).client
+        defer { client.dispose(); client.close() }
+        let channel = client.channels.get(test.uniqueChannelName())
+        attachAndWaitForInitialPresenceSyncToComplete(client: client, channel: channel)
+
+        let clientIds = (1...5).map { "client\($0)" }
+        waitUntil(timeout: testTimeout) { done in
+            channel.presence.enterClients(self.presenceMembers(clientIds, data: "online")) { errors in
+                XCTAssertNil(errors)
+                done()
+            }
+        }
+
+        let transport = client.internal.transport as! TestProxyTransport
+        let sent = transport.protocolMessagesSent.filter { $0.action == .presence }
+        XCTAssertEqual(sent.count, 1)
+        XCTAssertEqual(sent.first?.presence?.compactMap { $0.clientId }, clientIds)
+        XCTAssertEqual(sent.first?.presence?.filter { $0.action == .enter }.count, clientIds.count)
+
+        waitUntil(timeout: testTimeout) { done in
+            channel.presence.get { members, error in
+                XCTAssertNil(error)
+                XCTAssertEqual(Set(members?.compactMap { $0.clientId } ?? []), Set(clientIds))
+                done()
+            }
+        }
+
+        waitUntil(timeout: testTimeout) { done in
+            channel.presence.leaveClients(self.presenceMembers(clientIds, data: "offline")) { errors in
+                XCTAssertNil(errors)
+                done()
+            }
+        }
+        XCTAssertEqual(transport.protocolMessagesSent.filter { $0.action == .presence }.count, 2)
+    }
+
+    func test__120__Presence__enterClients__should_split_the_members_according_to_maxMessageSize_and_report_each_failure() throws {
+        let test = Test()
+        let options = try AblyTests.commonAppSetup(for: test)
+        let client = AblyTests.newRealtime(options).client
+        defer { client.dispose(); client.close() }
+        let channel = client.channels.get(test.uniqueChannelName())
+        attachAndWaitForInitialPresenceSyncToComplete(client: client, channel: channel)
+
+        // Each member is 7 bytes of clientId and 20 bytes of data, so two of them fit in a message.
+        let clientIds = (1...5).map { "client\($0)" }
+        var members = presenceMembers(clientIds, data: String(repeating: "a", count: 20))
+        members += presenceMembers(["tooLong"], data: String(repeating: "a", count: 100))
+        client.internal.connection.setMaxMessageSize(60)
+
+        waitUntil(timeout: testTimeout) { done in
+            channel.presence.enterClients(members) { errors in
+                XCTAssertEqual(errors?.count, 1)
+                XCTAssertEqual(errors?["tooLong"]?.code, ARTErrorCode.maxMessageLengthExceeded.intValue)
+                done()
+            }
+        }
+
+        let transport = client.internal.transport as! TestProxyTransport
+        let sent = transport.protocolMessagesSent.filter { $0.action == .presence }
+        XCTAssertEqual(sent.map { $0.presence?.count ?? 0 }, [2, 2, 1])
+    }
 }
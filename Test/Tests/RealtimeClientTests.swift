@@ -1648,4 +1648,29 @@ class RealtimeClientTests: XCTestCase {
             }
         })
     }
+
+    func test__047__RealtimeClient__transport_should_decode_text_frames_from_their_bytes() throws {
+        let test = Test()
+        let realtime = ARTRealtime(options: try AblyTests.commonAppSetup(for: test))
+        defer { realtime.dispose(); realtime.close() }
+        waitUntil(timeout: testTimeout) { done in
+            realtime.connection.once(.connected) { _ in
+                done()
+            }
+        }
+        guard let webSocketTransport = realtime.internal.transport as? ARTWebSocketTransport, let webSocket = webSocketTransport.websocket else {
+            fail("should be using a WebSocket transport"); return
+        }
+
+        // Text frames are delivered as their UTF-8 bytes, without becoming a string.
+        XCTAssertFalse(webSocketTransport.webSocketShouldConvertTextFrameToString(webSocket))
+
+        waitUntil(timeout: testTimeout) { done in
+            realtime.internal.testSuite_getArgument(from: NSSelectorFromString("ack:"), at: 0) { object in
+                XCTAssertEqual((object as? ARTProtocolMessage)?.msgSerial, 5)
+                done()
+            }
+            webSocketTransport.webSocket(webSocket, didReceiveMessage: Data("{\"action\":1,\"msgSerial\":5,\"count\":1}".utf8))
+        }
+    }
 }
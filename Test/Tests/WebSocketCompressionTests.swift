@@ -0,0 +1,177 @@
+import XCTest
+import Ably.Private
+
+class WebSocketCompressionTests: XCTestCase {
+    private var server: LoopbackWebSocketServer!
+
+    override func tearDown() {
+        server?.stop()
+        server = nil
+        super.tearDown()
+    }
+
+    private func protocolMessage(_ i: Int) -> String {
+        return #"{"action":15,"channel":"room:\#(i % 10)","msgSerial":\#(i),"messages":[{"id":"client-\#(i / 3):\#(i % 3)","name":"chat","clientId":"user-\#(i % 7)","data":"{\"text\":\"message number \#(i)\",\"ts\":\#(1_700_000_000_000 + i)}","encoding":"json"}]}"#
+    }
+
+    /// Echoes `messages` as text through a socket to the loopback server, offering `options`.
+    private func echo(_ messages: [String], options: ARTSRPerMessageDeflateOptions?) -> LoopbackEcho {
+        let webSocket = ARTSRWebSocket(urlRequest: URLRequest(url: server.url), logger: nil)
+        webSocket.perMessageDeflateOptions = options
+        return echo(messages, through: webSocket)
+    }
+
+    func test_compressesMessagesWithContextTakeover() {
+        server = LoopbackWebSocketServer { offer in
+            offer?.hasPrefix("permessage-deflate") == true ? "permessage-deflate" : nil
+        }
+        let messages = ["short"] + (0 ..< 20).map(protocolMessage)
+
+        let result = echo(messages, options: ARTSRPerMessageDeflateOptions())
+
+        XCTAssertNil(result.error)
+        XCTAssertEqual(result.textEchoes, messages)
+        XCTAssertEqual(server.requestHeaders["sec-websocket-extensions"], "permessage-deflate; client_max_window_bits")
+
+        // Messages below the minimum length are sent as they are; the others shrink more as the context learns the messages' structure.
+        let frames = server.receivedFrames.filter { $0.opcode == 0x1 }
+        XCTAssertEqual(frames.count, messages.count)
+        XCTAssertFalse(frames[0].rsv1)
+        XCTAssertEqual(frames[0].payload, Array("short".utf8))
+        for (frame, message) in zip(frames.dropFirst(), messages.dropFirst()) {
+            XCTAssertTrue(frame.rsv1)
+            XCTAssertLessThan(frame.payload.count, message.utf8.count)
+        }
+        XCTAssertLessThan(frames.last!.payload.count, frames[1].payload.count / 2)
+    }
+
+    func test_compressesEachMessageOnItsOwnWithoutContextTakeover() {
+        server = LoopbackWebSocketServer { _ in
+            "permessage-deflate; client_max_window_bits=10; server_max_window_bits=10; client_no_context_takeover; server_no_context_takeover"
+        }
+        let options = ARTSRPerMessageDeflateOptions()
+        options.clientMaxWindowBits = 10
+        options.serverMaxWindowBits = 10
+        options.clientNoContextTakeover = true
+        options.serverNoContextTakeover = true
+        let messages = Array(repeating: protocolMessage(1), count: 5)
+
+        let result = echo(messages, options: options)
+
+        XCTAssertNil(result.error)
+        XCTAssertEqual(result.textEchoes, messages)
+        XCTAssertEqual(server.requestHeaders["sec-websocket-extensions"], "permessage-deflate; client_max_window_bits=10; server_max_window_bits=10; client_no_context_takeover; server_no_context_takeover")
+        let frames = server.receivedFrames.filter { $0.opcode == 0x1 }
+        XCTAssertEqual(Set(frames.map { $0.payload }).count, 1, "the same message compresses the same way every time")
+        XCTAssertTrue(frames.allSatisfy { $0.rsv1 })
+    }
+
+    func test_sendsMessagesUncompressedWhenTheServerDeclinesTheExtension() {
+        server = LoopbackWebSocketServer()
+        let messages = (0 ..< 3).map(protocolMessage)
+
+        let result = echo(messages, options: ARTSRPerMessageDeflateOptions())
+
+        XCTAssertNil(result.error)
+        XCTAssertEqual(result.textEchoes, messages)
+        XCTAssertEqual(server.receivedFrames.filter { $0.opcode == 0x1 }.map { $0.payload }, messages.map { Array($0.utf8) })
+        XCTAssertFalse(server.receivedFrames.contains { $0.rsv1 })
+    }
+
+    func test_failsWhenTheServerAcceptsAnExtensionThatWasNotOffered() {
+        server = LoopbackWebSocketServer { _ in "permessage-deflate" }
+
+        let result = echo(["hello"], options: nil)
+
+        XCTAssertEqual((result.error as NSError?)?.code, 2133)
+    }
+
+    func test_clientOptionsToggleReachesTheSocketsThroughTheFactory() {
+        let clientOptions = ARTClientOptions()
+        XCTAssertFalse(clientOptions.useWebSocketCompression)
+        clientOptions.useWebSocketCompression = true
+        XCTAssertTrue((clientOptions.copy() as! ARTClientOptions).useWebSocketCompression)
+
+        let request = URLRequest(url: URL(string: "wss://realtime.ably.io")!)
+        let options = ARTSRPerMessageDeflateOptions()
+        options.compressionLevel = 1
+        let webSocket = DefaultWebSocketFactory(perMessageDeflateOptions: options).createWebSocket(with: request, logger: nil) as! ARTSRWebSocket
+        XCTAssertEqual(webSocket.perMessageDeflateOptions?.compressionLevel, 1)
+        XCTAssertNil((DefaultWebSocketFactory().createWebSocket(with: request, logger: nil) as! ARTSRWebSocket).perMessageDeflateOptions)
+    }
+
+    func test_negotiation() {
+        let options = ARTSRPerMessageDeflateOptions()
+        options.clientMaxWindowBits = 12
+        options.serverMaxWindowBits = 11
+
+        let accepted = try! ARTSRPerMessageDeflate(options: options, negotiatedExtensions: #"permessage-deflate;client_max_window_bits="9"; server_max_window_bits=10 ;server_no_context_takeover"#)
+        XCTAssertEqual(accepted.clientMaxWindowBits, 9)
+        XCTAssertEqual(accepted.serverMaxWindowBits, 10)
+        XCTAssertFalse(accepted.clientNoContextTakeover)
+        XCTAssertTrue(accepted.serverNoContextTakeover)
+
+        let defaults = try! ARTSRPerMessageDeflate(options: options, negotiatedExtensions: "permessage-deflate")
+        XCTAssertEqual(defaults.clientMaxWindowBits, 12)
+        XCTAssertEqual(defaults.serverMaxWindowBits, 15)
+
+        let rejected = [
+            "x-webkit-deflate-frame",
+            "permessage-deflate, permessage-deflate",
+            "permessage-deflate; client_max_window_bits=13", // larger than offered
+            "permessage-deflate; server_max_window_bits=12", // larger than offered
+            "permessage-deflate; client_max_window_bits",
+            "permessage-deflate; server_max_window_bits=7",
+            "permessage-deflate; server_max_window_bits=010",
+            "permessage-deflate; server_no_context_takeover; server_no_context_takeover",
+            "permessage-deflate; client_no_context_takeover=1",
+            "permessage-deflate; unknown_parameter",
+        ]
+        for response in rejected {
+            XCTAssertThrowsError(try ARTSRPerMessageDeflate(options: options, negotiatedExtensions: response), response)
+        }
+    }
+
+    // Benchmarks of the CPU time that compression costs, against the bandwidth it saves, each compressing and decompressing 2000 JSON protocol messages.
+
+    private func measureCompression(level: Int32, contextTakeover: Bool) {
+        let options = ARTSRPerMessageDeflateOptions()
+        options.compressionLevel = level
+        options.clientNoContextTakeover = !contextTakeover
+        options.serverNoContextTakeover = !contextTakeover
+        let extensions = contextTakeover ? "permessage-deflate" : "permessage-deflate; client_no_context_takeover; server_no_context_takeover"
+        let messages = (0 ..< 2000).map { Array(protocolMessage($0).utf8) }
+        let uncompressedLength = messages.reduce(0) { $0 + $1.count }
+
+        var compressedLength = 0
+        measure {
+            // The client's decompression context mirrors its compression one, as if the server echoed every message.
+            let deflate = try! ARTSRPerMessageDeflate(options: options, negotiatedExtensions: extensions)
+            compressedLength = 0
+            for message in messages {
+                XCTAssertTrue(deflate.compressBytes(message, length: message.count))
+                compressedLength += deflate.compressedLength
+                let compressed = Data(bytes: deflate.compressedBytes, count: deflate.compressedLength)
+                XCTAssertEqual(deflate.decompressData(compressed)?.count, message.count)
+            }
+        }
+        // With zlib 1.2.13, the messages compress to 13%, 11% and 11% of their length at levels 1, 6 and 9 with context takeover, and to 74% without.
+        XCTAssertLessThan(compressedLength * 100 / uncompressedLength, contextTakeover ? 15 : 80)
+    }
+
+    func test_benchmark_fastestWithContextTakeover() {
+        measureCompression(level: 1, contextTakeover: true)
+    }
+
+    func test_benchmark_defaultWithContextTakeover() {
+        measureCompression(level: -1, contextTakeover: true)
+    }
+
+    func test_benchmark_smallestWithContextTakeover() {
+        measureCompression(level: 9, contextTakeover: true)
+    }
+
+    func test_benchmark_defaultWithoutContextTakeover() {
+        measureCompression(level: -1, contextTakeover: false)
+    }
+}
@@ -0,0 +1,99 @@
+import XCTest
+import Ably.Private
+
+class WebSocketFragmentationTests: XCTestCase {
+    private var server: LoopbackWebSocketServer!
+
+    override func tearDown() {
+        server?.stop()
+        server = nil
+        super.tearDown()
+    }
+
+    /// Echoes `messages`, followed by a ping, through a socket to the loopback server that sends them in fragments of `maximumFragmentLength`.
+    private func echo(_ messages: [Data], maximumFragmentLength: UInt, options: ARTSRPerMessageDeflateOptions? = nil) -> [Data] {
+        let webSocket = ARTSRWebSocket(urlRequest: URLRequest(url: server.url), logger: nil)
+        webSocket.maximumFragmentLength = maximumFragmentLength
+        webSocket.perMessageDeflateOptions = options
+
+        let result = echo(messages, through: webSocket) { webSocket in
+            try! webSocket.sendPing(nil)
+        }
+
+        XCTAssertNil(result.error)
+        return result.echoes
+    }
+
+    private func message(length: Int) -> Data {
+        return Data((0 ..< length).map { UInt8(truncatingIfNeeded: $0 * 31 + $0 / 251) })
+    }
+
+    func test_sendsLongMessagesInFragmentsWithPingsInBetween() {
+        server = LoopbackWebSocketServer()
+        let long = message(length: 10_000)
+        let short = message(length: 100)
+
+        let echoes = echo([long, short], maximumFragmentLength: 1000)
+
+        XCTAssertEqual(echoes, [long, short])
+
+        // The socket has closed, so the frames include its close frame, as well as the ping.
+        let frames = server.receivedFrames
+        let fragments = frames.filter { $0.opcode <= 0x2 }
+        XCTAssertEqual(fragments.count, 11)
+        XCTAssertEqual(fragments.first?.opcode, 0x2)
+        XCTAssertTrue(fragments[1 ..< 10].allSatisfy { $0.opcode == 0x0 })
+        XCTAssertEqual(fragments.prefix(10).map { $0.fin }, Array(repeating: false, count: 9) + [true])
+        XCTAssertTrue(fragments.allSatisfy { $0.payload.count <= 1000 })
+        XCTAssertEqual(Data(fragments.prefix(10).flatMap { $0.payload }), long)
+
+        // The short message follows the long one whole, but the ping, sent after both, overtakes them.
+        XCTAssertEqual(fragments.last?.opcode, 0x2)
+        XCTAssertEqual(fragments.last?.payload, Array(short))
+        let pingIndex = frames.firstIndex { $0.opcode == 0x9 }!
+        XCTAssertLessThan(pingIndex, 9)
+    }
+
+    func test_compressesFragmentedMessagesAsAWhole() {
+        server = LoopbackWebSocketServer { _ in "permessage-deflate" }
+        let long = Data(String(repeating: #"{"action":15,"channel":"room","messages":[{"name":"chat","data":"hello"}]}"#, count: 200).utf8)
+
+        let echoes = echo([long], maximumFragmentLength: 64, options: ARTSRPerMessageDeflateOptions())
+
+        XCTAssertEqual(echoes, [long])
+        let fragments = server.receivedFrames.filter { $0.opcode <= 0x2 }
+        XCTAssertGreaterThan(fragments.count, 1)
+        XCTAssertEqual(fragments.map { $0.rsv1 }, [true] + Array(repeating: false, count: fragments.count - 1))
+    }
+
+    func test_sendsMessagesInASingleFrameByDefault() {
+        server = LoopbackWebSocketServer()
+        let long = message(length: 100_000)
+
+        XCTAssertEqual(echo([long], maximumFragmentLength: 0), [long])
+        XCTAssertEqual(server.receivedFrames.filter { $0.opcode == 0x2 }.map { $0.fin }, [true])
+
+        let options = ARTClientOptions()
+        XCTAssertEqual(options.webSocketMaximumFragmentLength, 0)
+        options.webSocketMaximumFragmentLength = 16 * 1024
+        XCTAssertEqual((options.copy() as! ARTClientOptions).webSocketMaximumFragmentLength, 16 * 1024)
+    }
+
+    func test_repliesToTheServersCloseFrameWhileSendingAFragmentedMessage() {
+        // The server closes after the first fragment, while the client has most of the message left to send.
+        server = LoopbackWebSocketServer(closeAfterDataFrames: 1)
+        let long = message(length: 4 * 1024 * 1024)
+        let webSocket = ARTSRWebSocket(urlRequest: URLRequest(url: server.url), logger: nil)
+        webSocket.maximumFragmentLength = 1024
+
+        let result = LoopbackEcho([long], through: webSocket, testCase: self)
+        // The client closes as soon as it has written its reply, so the server may read it after that.
+        let replied = expectation(for: NSPredicate { _, _ in self.server.receivedFrames.last?.opcode == 0x8 }, evaluatedWith: nil)
+        webSocket.open()
+        wait(for: [result.echoed, result.closed, replied], timeout: 10)
+
+        // The reply to the close frame is sent rather than lost behind what is left of the message.
+        XCTAssertNil(result.error)
+        XCTAssertEqual(server.receivedFrames.last?.payload, [0x03, 0xE8])
+    }
+}
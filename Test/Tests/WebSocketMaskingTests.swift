@@ -0,0 +1,78 @@
+import XCTest
+import Ably.Private
+
+class WebSocketMaskingTests: XCTestCase {
+    private var maskKey: [UInt8] = [0x12, 0x34, 0x56, 0x78]
+
+    private var availableKernels: [ARTSRMaskKernel] {
+        return [.scalar, .SSE2, .AVX2, .NEON].filter { ARTSRMaskKernelIsAvailable($0) }
+    }
+
+    func test_everyAvailableKernelMasksLikeTheDefinition() {
+        XCTAssertTrue(availableKernels.contains(ARTSRMaskKernelDefault()))
+
+        for kernel in availableKernels {
+            // Lengths around the vector and unrolled loop sizes, at every offset from the mask's start.
+            for length in 0 ..< 300 {
+                for offset in 0 ..< 4 {
+                    let original = (0 ..< length + 8).map { UInt8(truncatingIfNeeded: $0 &* 31 &+ 7) }
+                    var expected = original
+                    for i in 0 ..< length {
+                        expected[offset + i] ^= maskKey[i % 4]
+                    }
+                    var masked = original
+                    masked.withUnsafeMutableBufferPointer { buffer in
+                        ARTSRMaskBytesWithKernel(kernel, buffer.baseAddress! + offset, length, &maskKey)
+                    }
+                    XCTAssertEqual(masked, expected, "kernel \(kernel.rawValue), length \(length), offset \(offset)")
+                }
+            }
+        }
+    }
+
+    func test_maskingWhileCopyingLeavesTheSourceUntouched() {
+        for length in 0 ..< 300 {
+            let source = (0 ..< length).map { UInt8(truncatingIfNeeded: $0 &* 13 &+ 1) }
+            var expected = source
+            ARTSRMaskBytesSIMD(&expected, length, &maskKey)
+            var destination = [UInt8](repeating: 0, count: length)
+            ARTSRMaskCopyBytesSIMD(&destination, source, length, &maskKey)
+            XCTAssertEqual(destination, expected, "length \(length)")
+            XCTAssertEqual(source, (0 ..< length).map { UInt8(truncatingIfNeeded: $0 &* 13 &+ 1) })
+        }
+    }
+
+    // Benchmarks of the masking of outbound frames, each masking 64 MB in payloads of the given size.
+
+    private func measureMasking(payloadLength: Int) {
+        var payload = [UInt8](repeating: 0xAB, count: payloadLength)
+        let iterations = max(1, (64 * 1024 * 1024) / payloadLength)
+        measure {
+            payload.withUnsafeMutableBufferPointer { buffer in
+                for _ in 0 ..< iterations {
+                    ARTSRMaskBytesSIMD(buffer.baseAddress!, payloadLength, &maskKey)
+                }
+            }
+        }
+    }
+
+    func test_benchmark_16B() {
+        measureMasking(payloadLength: 16)
+    }
+
+    func test_benchmark_256B() {
+        measureMasking(payloadLength: 256)
+    }
+
+    func test_benchmark_4KB() {
+        measureMasking(payloadLength: 4 * 1024)
+    }
+
+    func test_benchmark_64KB() {
+        measureMasking(payloadLength: 64 * 1024)
+    }
+
+    func test_benchmark_1MB() {
+        measureMasking(payloadLength: 1024 * 1024)
+    }
+}
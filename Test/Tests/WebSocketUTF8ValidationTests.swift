@@ -0,0 +1,80 @@
+import XCTest
+import Ably.Private
+
+class WebSocketUTF8ValidationTests: XCTestCase {
+    private var availableKernels: [ARTSRUTF8Kernel] {
+        return [.scalar, .SSSE3, .NEON].filter { ARTSRUTF8KernelIsAvailable($0) }
+    }
+
+    private let validSamples: [[UInt8]] = [
+        [],
+        Array("{\"action\":15,\"channel\":\"chat\"}".utf8),
+        Array("caf\u{E9} \u{20AC} \u{1F600} \u{10FFFF} \u{FFFF} \u{D7FF} \u{E000}".utf8),
+    ]
+
+    private let invalidSamples: [[UInt8]] = [
+        [0x80], // a continuation alone
+        [0xC3], // cut short
+        [0xE2, 0x82], // cut short
+        [0xF0, 0x9F, 0x98], // cut short
+        [0xC0, 0xAF], // overlong
+        [0xE0, 0x80, 0xAF], // overlong
+        [0xF0, 0x80, 0x80, 0xAF], // overlong
+        [0xED, 0xA0, 0x80], // surrogate
+        [0xF4, 0x90, 0x80, 0x80], // above U+10FFFF
+        [0xF8, 0x88, 0x80, 0x80, 0x80], // 5 bytes
+        [0xC3, 0xA9, 0xA9], // too many continuations
+        [0xFF],
+    ]
+
+    // Puts a sample where it crosses the boundary between two blocks, in ASCII that spans several blocks.
+    private func embedded(_ sample: [UInt8], at offset: Int) -> [UInt8] {
+        let ascii = Array(repeating: UInt8(ascii: "a"), count: 100)
+        return Array(ascii[0 ..< offset]) + sample + Array(ascii[offset...])
+    }
+
+    private func validate(_ bytes: [UInt8], kernel: ARTSRUTF8Kernel, splitAt split: Int) -> Bool {
+        var validation = ARTSRUTF8Validation()
+        ARTSRUTF8ValidationReset(&validation)
+        bytes.withUnsafeBufferPointer { buffer in
+            _ = ARTSRUTF8ValidationUpdateWithKernel(kernel, &validation, buffer.baseAddress!, split)
+            _ = ARTSRUTF8ValidationUpdateWithKernel(kernel, &validation, buffer.baseAddress! + split, bytes.count - split)
+        }
+        return ARTSRUTF8ValidationFinish(&validation)
+    }
+
+    func test_everyAvailableKernelValidatesTextSplitAnywhere() {
+        XCTAssertTrue(availableKernels.contains(ARTSRUTF8KernelDefault()))
+
+        for kernel in availableKernels {
+            for (samples, expected) in [(validSamples, true), (invalidSamples, false)] {
+                for sample in samples {
+                    for offset in [0, 14, 15, 16, 31, 47, 63, 64, 100] {
+                        let bytes = embedded(sample, at: offset)
+                        for split in Array(stride(from: 0, through: bytes.count, by: 7)) + [offset + 1] {
+                            XCTAssertEqual(validate(bytes, kernel: kernel, splitAt: split), expected, "kernel \(kernel.rawValue), sample \(sample), offset \(offset), split \(split)")
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    func test_textCutShortAtTheEndIsInvalid() {
+        let bytes = Array(repeating: UInt8(ascii: "a"), count: 31) + [0xE2]
+        XCTAssertFalse(ARTSRUTF8IsValid(bytes, bytes.count))
+        XCTAssertTrue(ARTSRUTF8IsValid(bytes, bytes.count - 1))
+    }
+
+    // Benchmark of the validation of 64 MB of JSON text, mostly ASCII.
+
+    func test_benchmark_JSONText() {
+        let message = Array("{\"action\":15,\"channel\":\"chat\",\"messages\":[{\"name\":\"greeting\",\"data\":\"h\u{E9}llo \u{1F600}\"}]},".utf8)
+        let text = Array([[UInt8]](repeating: message, count: (1024 * 1024) / message.count).joined())
+        measure {
+            for _ in 0 ..< 64 {
+                XCTAssertTrue(ARTSRUTF8IsValid(text, text.count))
+            }
+        }
+    }
+}
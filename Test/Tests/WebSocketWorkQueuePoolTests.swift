@@ -0,0 +1,64 @@
+import XCTest
+import Ably.Private
+
+class WebSocketWorkQueuePoolTests: XCTestCase {
+    private var servers: [LoopbackWebSocketServer] = []
+
+    override func tearDown() {
+        servers.forEach { $0.stop() }
+        servers = []
+        super.tearDown()
+    }
+
+    func test_poolHandsOutItsQueuesInTurn() {
+        let pool = ARTSRWorkQueuePool(queueCount: 3)
+        XCTAssertEqual(pool.queueCount, 3)
+
+        let queues = (0 ..< 6).map { _ in pool.nextQueue() }
+        XCTAssertEqual(Set(queues.map { ObjectIdentifier($0) }).count, 3)
+        for i in 0 ..< 3 {
+            XCTAssertTrue(queues[i] === queues[i + 3])
+        }
+
+        XCTAssertEqual(ARTSRWorkQueuePool(queueCount: 0).queueCount, UInt(ProcessInfo.processInfo.activeProcessorCount))
+        XCTAssertTrue(ARTSRWorkQueuePool.sharedPool(withQueueCount: 2) === ARTSRWorkQueuePool.sharedPool(withQueueCount: 2))
+        XCTAssertFalse(ARTSRWorkQueuePool.sharedPool(withQueueCount: 2) === ARTSRWorkQueuePool.sharedPool(withQueueCount: 3))
+    }
+
+    func test_socketsScheduledOnAPoolEchoMessages() {
+        let pool = ARTSRWorkQueuePool(queueCount: 2)
+        let factory = DefaultWebSocketFactory(perMessageDeflateOptions: nil, workQueuePool: pool)
+        let messagesPerSocket = 50
+
+        var echoes: [LoopbackEcho] = []
+        var sentMessages: [[String]] = []
+        for i in 0 ..< 4 {
+            let server = LoopbackWebSocketServer()
+            servers.append(server)
+            let webSocket = factory.createWebSocket(with: URLRequest(url: server.url), logger: nil) as! ARTSRWebSocket
+            let messages = (0 ..< messagesPerSocket).map { "socket \(i) message \($0)" }
+            echoes.append(LoopbackEcho(messages, through: webSocket, testCase: self))
+            sentMessages.append(messages)
+        }
+
+        echoes.forEach { $0.webSocket.open() }
+        wait(for: echoes.map { $0.echoed }, timeout: 10)
+        echoes.forEach { $0.webSocket.close() }
+        wait(for: echoes.map { $0.closed }, timeout: 10)
+        for (echo, messages) in zip(echoes, sentMessages) {
+            XCTAssertNil(echo.error)
+            XCTAssertEqual(echo.textEchoes, messages)
+        }
+        for server in servers {
+            XCTAssertEqual(server.receivedFrames.filter { $0.opcode == 0x1 }.count, messagesPerSocket)
+        }
+    }
+
+    func test_clientOptionsQueueCountDefaultsToTheSharedNetworkThread() {
+        let options = ARTClientOptions()
+        XCTAssertEqual(options.webSocketQueueCount, 0)
+        options.webSocketQueueCount = 4
+        XCTAssertEqual((options.copy() as! ARTClientOptions).webSocketQueueCount, 4)
+        XCTAssertNil(DefaultWebSocketFactory().workQueuePool)
+    }
+}
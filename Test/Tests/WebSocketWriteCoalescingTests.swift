@@ -0,0 +1,46 @@
+import XCTest
+import Ably.Private
+
+class WebSocketWriteCoalescingTests: XCTestCase {
+    private var server: LoopbackWebSocketServer!
+
+    override func tearDown() {
+        server?.stop()
+        server = nil
+        super.tearDown()
+    }
+
+    /// Sends `messages` in a burst once the socket opens, and waits for the server to echo all of them and for the socket to close.
+    private func sendBurst(_ messages: [String]) -> ARTSRWebSocket {
+        server = LoopbackWebSocketServer()
+        let webSocket = ARTSRWebSocket(urlRequest: URLRequest(url: server.url), logger: nil)
+
+        let result = echo(messages, through: webSocket)
+
+        XCTAssertNil(result.error)
+        XCTAssertEqual(result.textEchoes, messages, "batched frames are sent in order")
+        return webSocket
+    }
+
+    func test_framesSentInABurstShareWrites() {
+        let messages = (0 ..< 500).map { #"{"action":15,"channel":"burst","msgSerial":\#($0)}"# }
+
+        let webSocket = sendBurst(messages)
+
+        // The socket has closed, so the server has received every frame, the close one included.
+        XCTAssertEqual(server.receivedFrames.filter { $0.opcode == 0x1 }.count, messages.count)
+        XCTAssertEqual(webSocket.sentFrameCount, UInt(server.receivedFrames.count))
+        // How many frames share a write depends on how far the sends get ahead of the work queue, so this only checks that some do.
+        XCTAssertLessThan(webSocket.socketWriteCount, webSocket.sentFrameCount)
+    }
+
+    func test_framesLargerThanTheCorkedBufferAreSentWhole() {
+        let largeMessage = String(repeating: "x", count: 40 * 1024)
+        let messages = ["small", largeMessage, "small again", largeMessage]
+
+        let webSocket = sendBurst(messages)
+
+        XCTAssertEqual(webSocket.sentFrameCount, UInt(server.receivedFrames.count))
+        XCTAssertEqual(server.receivedFrames.filter { $0.opcode == 0x1 }.map { $0.payload.count }, messages.map { $0.utf8.count })
+    }
+}